@@ -0,0 +1,291 @@
+////////////////////////////////////////////////////////////
+//
+// File:  baked.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the meshes baked in at compile time.  The
+//               shape recipes in shapes.h are run by the compiler with a
+//               builder that writes into fixed size arrays, once to size
+//               each table and once to fill it, so selecting one of these
+//               meshes costs nothing at run time and allocates nothing.
+//
+//               Cube, cylinder and cone are baked for primary and
+//               secondary tessellation 1 to BAKE_MAX_TESSELLATION.  The
+//               sphere quadruples with every level, so only depths up to
+//               BAKE_SPHERE_MAX_DEPTH are small enough to keep in the binary.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include "resources.h"
+#include "baked.h"
+#include "shapes.h"
+
+// Builder that only counts what a recipe would produce
+struct countBuilder
+{
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+
+    template <class Surface>
+    constexpr void surface(const Surface& s, int rows, int cols, unsigned int options)
+    {
+        gridLayout grid(rows, cols, options);
+        vertexCount += grid.vertexCount;
+        indexCount += 3 * grid.triangleCount;
+    }
+
+    constexpr void triangle(Point3 p1, Point3 p2, Point3 p3, Vector3 n1, Vector3 n2, Vector3 n3)
+    {
+        vertexCount += 3;
+        indexCount += 3;
+    }
+};
+
+// Fixed size storage for one baked mesh
+template <unsigned int V, unsigned int I>
+struct bakedArrays
+{
+    std::array<Point3, V> positions;
+    std::array<Vector3, V> normals;
+    std::array<unsigned int, I> indices;
+};
+
+// Builder writing a recipe into bakedArrays, the way tessellateSurface and
+// addTriangle write into a Mesh
+template <unsigned int V, unsigned int I>
+struct arrayBuilder
+{
+    bakedArrays<V, I>& out;
+    unsigned int vertexCount;
+    unsigned int indexCount;
+
+    constexpr arrayBuilder(bakedArrays<V, I>& out_) : out(out_), vertexCount(0), indexCount(0) {}
+
+    template <class Surface>
+    constexpr void surface(const Surface& s, int rows, int cols, unsigned int options)
+    {
+        gridLayout grid(rows, cols, options);
+        typename Surface::Column columns[BAKE_MAX_TESSELLATION + 1] = {};
+        for (int c = 0 ; c < grid.rowVertices ; ++c)
+            columns[c] = gridColumn(s, grid, c);
+
+        fillGridRows(s, grid, columns, &out.positions[vertexCount], &out.normals[vertexCount],
+                     &out.indices[indexCount], vertexCount, 0, rows + 1);
+        vertexCount += grid.vertexCount;
+        indexCount += 3 * grid.triangleCount;
+    }
+
+    constexpr void triangle(Point3 p1, Point3 p2, Point3 p3, Vector3 n1, Vector3 n2, Vector3 n3)
+    {
+        out.indices[indexCount++] = vertexCount;
+        out.normals[vertexCount] = n1;
+        out.positions[vertexCount++] = p1;
+        out.indices[indexCount++] = vertexCount;
+        out.normals[vertexCount] = n2;
+        out.positions[vertexCount++] = p2;
+        out.indices[indexCount++] = vertexCount;
+        out.normals[vertexCount] = n3;
+        out.positions[vertexCount++] = p3;
+    }
+};
+
+constexpr countBuilder bakedSize(short rendering, int n, int m)
+{
+    countBuilder size;
+    buildShape(rendering, n, m, size);
+    return size;
+}
+
+template <short Rendering, int N, int M>
+struct bakedMesh
+{
+    static constexpr countBuilder size = bakedSize(Rendering, N, M);
+    typedef bakedArrays<size.vertexCount, size.indexCount> arrays;
+
+    static constexpr arrays bake()
+    {
+        arrays data = {};
+        arrayBuilder<size.vertexCount, size.indexCount> out(data);
+        buildShape(Rendering, N, M, out);
+        return data;
+    }
+
+    static constexpr arrays data = bake();
+
+    static constexpr MeshView view()
+    {
+        return MeshView(data.positions.data(), size.vertexCount, data.indices.data(), size.indexCount,
+                        size.vertexCount > 0 ? data.normals.data() : NULL);
+    }
+};
+
+// Tables of views, [primary - 1] for the cube and sphere and
+// [(primary - 1) * BAKE_MAX_TESSELLATION + secondary - 1] for the others
+template <short Rendering, int... Level>
+constexpr std::array<MeshView, sizeof...(Level)> primaryViews(std::integer_sequence<int, Level...>)
+{
+    return {{ bakedMesh<Rendering, Level + 1, 1>::view()... }};
+}
+
+template <short Rendering, int... Level>
+constexpr std::array<MeshView, sizeof...(Level)> pairViews(std::integer_sequence<int, Level...>)
+{
+    return {{ bakedMesh<Rendering, Level / BAKE_MAX_TESSELLATION + 1, Level % BAKE_MAX_TESSELLATION + 1>::view()... }};
+}
+
+static constexpr std::array<MeshView, BAKE_MAX_TESSELLATION> bakedCubes =
+    primaryViews<RENDERING_CUBE>(std::make_integer_sequence<int, BAKE_MAX_TESSELLATION>());
+static constexpr std::array<MeshView, BAKE_MAX_TESSELLATION * BAKE_MAX_TESSELLATION> bakedCylinders =
+    pairViews<RENDERING_CYL>(std::make_integer_sequence<int, BAKE_MAX_TESSELLATION * BAKE_MAX_TESSELLATION>());
+static constexpr std::array<MeshView, BAKE_MAX_TESSELLATION * BAKE_MAX_TESSELLATION> bakedCones =
+    pairViews<RENDERING_CONE>(std::make_integer_sequence<int, BAKE_MAX_TESSELLATION * BAKE_MAX_TESSELLATION>());
+static constexpr std::array<MeshView, BAKE_SPHERE_MAX_DEPTH> bakedSpheres =
+    primaryViews<RENDERING_SPH>(std::make_integer_sequence<int, BAKE_SPHERE_MAX_DEPTH>());
+
+///////////////////////////////////////////////////////////
+//Look up a baked mesh
+///////////////////////////////////////////////////////////
+bool findBakedMesh(short rendering, int primary, int secondary, MeshView& view)
+{
+    if (primary < 1 || secondary < 1)
+        return false;
+
+    switch (rendering)
+    {
+    case RENDERING_CUBE:
+        if (primary > BAKE_MAX_TESSELLATION)
+            return false;
+        view = bakedCubes[primary - 1];
+        return true;
+    case RENDERING_CYL:
+    case RENDERING_CONE:
+        if (primary > BAKE_MAX_TESSELLATION || secondary > BAKE_MAX_TESSELLATION)
+            return false;
+        view = (rendering == RENDERING_CYL ? bakedCylinders : bakedCones)
+            [(primary - 1) * BAKE_MAX_TESSELLATION + secondary - 1];
+        return true;
+    case RENDERING_SPH:
+        if (primary > BAKE_SPHERE_MAX_DEPTH)
+            return false;
+        view = bakedSpheres[primary - 1];
+        return true;
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////
+//Check one baked mesh against the generator
+///////////////////////////////////////////////////////////
+static bool bakedMatches(short rendering, int primary, int secondary)
+{
+    MeshView baked;
+    Mesh generated;
+    findBakedMesh(rendering, primary, secondary, baked);
+    generateMesh(rendering, primary, secondary, generated);
+
+    //Both counts, and every bit of every coordinate, normal and index, must
+    //agree
+    bool same = baked.vertexCount == generated.positions.size() &&
+                baked.indexCount == generated.indices.size() &&
+                (baked.vertexCount == 0 ||
+                 (memcmp(baked.positions, &generated.positions[0], baked.vertexCount * sizeof(Point3)) == 0 &&
+                  memcmp(baked.normals, &generated.normals[0], baked.vertexCount * sizeof(Vector3)) == 0)) &&
+                (baked.indexCount == 0 ||
+                 memcmp(baked.indices, &generated.indices[0], baked.indexCount * sizeof(unsigned int)) == 0);
+
+    if (!same)
+        printf("baked mesh %d (%d x %d) differs from the generator\n", rendering, primary, secondary);
+    return same;
+}
+
+///////////////////////////////////////////////////////////
+//Distance between two doubles in units in the last place
+///////////////////////////////////////////////////////////
+static unsigned long long ulpsApart(double a, double b)
+{
+    //Map the bits to integers that order the same way the doubles do
+    long long x, y;
+    memcpy(&x, &a, sizeof(x));
+    memcpy(&y, &b, sizeof(y));
+    if (x < 0)
+        x = LLONG_MIN - x;
+    if (y < 0)
+        y = LLONG_MIN - y;
+    return x > y ? (unsigned long long)x - y : (unsigned long long)y - x;
+}
+
+///////////////////////////////////////////////////////////
+//Check the shared math against the C library at every angle a ring of up
+//to BAKE_LIBM_COLUMNS columns is built from, cell edges and middles both
+//ways around, and the square root bit for bit; returns the worst sine or
+//cosine error in ULPs, or ~0 if the square roots differ
+///////////////////////////////////////////////////////////
+static unsigned long long libmUlps()
+{
+    unsigned long long worst = 0;
+    for (int cols = 1 ; cols <= BAKE_LIBM_COLUMNS ; ++cols)
+        for (int half = 0 ; half <= 2 * cols ; ++half)
+            for (int way = -1 ; way <= 1 ; way += 2)
+            {
+                double angle = way * 2.0 * M_PI * (half * 0.5 / cols);
+                worst = std::max(worst, std::max(ulpsApart(ctSin(angle), std::sin(angle)),
+                                                 ulpsApart(ctCos(angle), std::cos(angle))));
+            }
+
+    //The compiler's square root against the hardware's, over every binade
+    //the normals are normalized from
+    for (int i = 0 ; i < 100000 ; ++i)
+    {
+        double x = std::ldexp(1.0 + i / 100000.0, i % 64 - 32);
+        if (ctExactSqrt(x) != std::sqrt(x))
+            return ~0ull;
+    }
+    return worst;
+}
+
+///////////////////////////////////////////////////////////
+//Compare all baked meshes with the generators, and the math both share
+//with the C library's
+///////////////////////////////////////////////////////////
+int verifyBakedMeshes()
+{
+    int mismatches = 0;
+    int checked = 0;
+
+    for (int n = 1 ; n <= BAKE_MAX_TESSELLATION ; ++n)
+    {
+        mismatches += !bakedMatches(RENDERING_CUBE, n, 1);
+        checked++;
+        for (int m = 1 ; m <= BAKE_MAX_TESSELLATION ; ++m)
+        {
+            mismatches += !bakedMatches(RENDERING_CYL, n, m);
+            mismatches += !bakedMatches(RENDERING_CONE, n, m);
+            checked += 2;
+        }
+    }
+    for (int depth = 1 ; depth <= BAKE_SPHERE_MAX_DEPTH ; ++depth)
+    {
+        mismatches += !bakedMatches(RENDERING_SPH, depth, 1);
+        checked++;
+    }
+
+    printf("%d of %d baked meshes match the generators\n", checked - mismatches, checked);
+
+    //Both sides run the same series, so agreeing with each other says
+    //nothing about agreeing with the true sine and cosine
+    unsigned long long ulps = libmUlps();
+    if (ulps == ~0ull)
+        printf("the compile time square root differs from std::sqrt\n");
+    else
+        printf("sine and cosine are within %llu ULPs of the C library's (tolerance %d)\n", ulps, BAKE_LIBM_MAX_ULPS);
+    return mismatches + (ulps > BAKE_LIBM_MAX_ULPS);
+}
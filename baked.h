@@ -0,0 +1,27 @@
+////////////////////////////////////////////////////////////
+//
+// File:  baked.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the meshes baked into
+//               read-only tables at compile time, covering the startup
+//               state and the tessellations most used interactively.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __BAKED_H__
+#define __BAKED_H__
+
+#include "mesh.h"
+
+// Point view at the baked mesh of the given rendering and tessellation,
+// returning false (leaving view alone) if it was not baked
+bool findBakedMesh(short rendering, int primary, int secondary, MeshView& view);
+
+// Compare every baked mesh bit for bit with what the generators produce at
+// run time, printing each mismatch; returns the number of mismatches
+int verifyBakedMeshes();
+
+#endif
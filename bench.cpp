@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////
+//
+// File:  bench.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the offscreen
+//               throughput benchmark.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "resources.h"
+#include "bench.h"
+#include "softraster.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+// The tessellation window's frame and its choice of mesh, defined in the
+// tessellation.o object
+extern unsigned int drawTessFrame(tessFrameTimes* times);
+extern MeshView chooseTessMesh();
+
+///////////////////////////////////////////////////////////
+//Make an OpenGL context current on a pbuffer the size of the
+//tessellation window, on Mesa's surfaceless platform if it has one
+///////////////////////////////////////////////////////////
+static bool makeOffscreenContext(int width, int height)
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != NULL)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+        return false;
+
+    const EGLint configAttributes[] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configs = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configs) || configs == 0)
+        return false;
+
+    const EGLint surfaceAttributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    if (surface == EGL_NO_SURFACE)
+        return false;
+
+    //The frame code is immediate mode, so this wants a compatibility context
+    if (!eglBindAPI(EGL_OPENGL_API))
+        return false;
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+    if (context == EGL_NO_CONTEXT)
+        return false;
+
+    return eglMakeCurrent(display, surface, surface, context);
+}
+
+///////////////////////////////////////////////////////////
+//Write the current framebuffer out as a binary PPM
+///////////////////////////////////////////////////////////
+static bool writePPM(const char* path, int width, int height)
+{
+    std::vector<unsigned char> pixels(3 * width * height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    FILE* out = fopen(path, "wb");
+    if (out == NULL)
+        return false;
+
+    //OpenGL's rows run bottom up, PPM's top down
+    fprintf(out, "P6\n%d %d\n255\n", width, height);
+    for (int row = height - 1 ; row >= 0 ; --row)
+        fwrite(&pixels[3 * width * row], 1, 3 * width, out);
+    fclose(out);
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//Draw the rotation sweep with the software renderer
+///////////////////////////////////////////////////////////
+static int softwareBenchmark(int frames, const char* ppmPath)
+{
+    printf("Software wireframe, %u threads, %dx%d\n", std::max(1u, std::thread::hardware_concurrency()),
+           windowSizex, int(windowSizey * THREE_QUARTER_WINDOW));
+
+    //The software renderer reads the doubles
+    quantizedVertices = false;
+
+    softFramebuffer frame;
+    double totals[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double triangles = 0.0, firstTessellation = 0.0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0 ; i < frames ; ++i)
+    {
+        renderings[activeRendering].xRotation = BENCH_X_ROTATION;
+        renderings[activeRendering].yRotation = 360.0 * i / frames;
+
+        std::chrono::steady_clock::time_point choosing = std::chrono::steady_clock::now();
+        MeshView mesh = chooseTessMesh();
+        double tessellation = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - choosing).count();
+
+        softRenderStats stats;
+        softRenderMesh(mesh, renderings[activeRendering], windowSizex, windowSizey, frame, &stats);
+
+        if (i == 0)
+            firstTessellation = tessellation;
+        totals[0] += tessellation;
+        totals[1] += stats.transform;
+        totals[2] += stats.binning;
+        totals[3] += stats.rasterization;
+        triangles += mesh.triangleCount();
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%d frames in %.1f ms: %.1f frames/s, %.3g triangles/s\n",
+           frames, elapsed, 1000.0 * frames / elapsed, 1000.0 * triangles / elapsed);
+    printf("%-14s %10s %10s %8s\n", "Phase", "Total ms", "Frame ms", "Share");
+    const char* phases[4] = { "tessellation", "transform", "cull/bin", "rasterize" };
+    for (int phase = 0 ; phase < 4 ; ++phase)
+        printf("%-14s %10.2f %10.4f %7.1f%%\n", phases[phase], totals[phase], totals[phase] / frames, 100.0 * totals[phase] / elapsed);
+    printf("(the first frame's tessellation, which builds the mesh, took %.2f ms)\n", firstTessellation);
+
+    if (ppmPath != NULL && !writeFramebufferPPM(ppmPath, frame))
+    {
+        fprintf(stderr, "Could not write %s\n", ppmPath);
+        return 1;
+    }
+    return 0;
+}
+
+///////////////////////////////////////////////////////////
+//Draw the rotation sweep and report where the time went
+///////////////////////////////////////////////////////////
+int offscreenBenchmark(int frames, const char* ppmPath, bool software)
+{
+    if (software)
+        return softwareBenchmark(frames, ppmPath);
+
+    int width = windowSizex;
+    int height = int(windowSizey * THREE_QUARTER_WINDOW);
+    if (!makeOffscreenContext(width, height))
+    {
+        fprintf(stderr, "Could not make an offscreen OpenGL context (EGL error 0x%x)\n", eglGetError());
+        return 1;
+    }
+    printf("%s, %dx%d pbuffer\n", (const char*)glGetString(GL_RENDERER), width, height);
+
+    double tessellation = 0.0, submission = 0.0, swap = 0.0, firstTessellation = 0.0;
+    double triangles = 0.0, culled = 0.0, instances = 0.0, culledInstances = 0.0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0 ; frame < frames ; ++frame)
+    {
+        renderings[activeRendering].xRotation = BENCH_X_ROTATION;
+        renderings[activeRendering].yRotation = 360.0 * frame / frames;
+
+        tessFrameTimes times;
+        drawTessFrame(&times);
+
+        //The pbuffer's swap does nothing, so wait for the frame to finish
+        std::chrono::steady_clock::time_point submitted = std::chrono::steady_clock::now();
+        eglSwapBuffers(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW));
+        glFinish();
+        swap += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitted).count();
+
+        if (frame == 0)
+            firstTessellation = times.tessellation;
+        tessellation += times.tessellation;
+        submission += times.submission;
+        triangles += times.triangles;
+        culled += times.culled;
+        instances += times.instances;
+        culledInstances += times.culledInstances;
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%d frames in %.1f ms: %.1f frames/s, %.3g triangles/s\n",
+           frames, elapsed, 1000.0 * frames / elapsed, 1000.0 * triangles / elapsed);
+    printf("%-14s %10s %10s %8s\n", "Phase", "Total ms", "Frame ms", "Share");
+    const char* phases[3] = { "tessellation", "submission", "swap/finish" };
+    double totals[3] = { tessellation, submission, swap };
+    for (int phase = 0 ; phase < 3 ; ++phase)
+        printf("%-14s %10.2f %10.4f %7.1f%%\n", phases[phase], totals[phase], totals[phase] / frames, 100.0 * totals[phase] / elapsed);
+    printf("(the first frame's tessellation, which builds the mesh, took %.2f ms)\n", firstTessellation);
+    if (coneCulling)
+        printf("%.1f%% of triangles culled by cluster before submission\n", 100.0 * culled / triangles);
+    if (sceneMode)
+        printf("Scene of %d instances: %.3g instances/s drawn, %.1f%% frustum culled\n",
+               sceneInstances, 1000.0 * instances / elapsed, 100.0 * culledInstances / (instances + culledInstances));
+
+    if (ppmPath != NULL && !writePPM(ppmPath, width, height))
+    {
+        fprintf(stderr, "Could not write %s\n", ppmPath);
+        return 1;
+    }
+    return 0;
+}
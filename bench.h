@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////
+//
+// File:  bench.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the offscreen
+//               throughput benchmark, which draws the active shape through
+//               the tessellation window's own frame code into an EGL
+//               pbuffer, or through the software wireframe renderer into
+//               memory, with no windows, for a fixed rotation sweep.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+// Frames drawn when none are asked for, and the tilt the sweep turns at
+#define BENCH_FRAMES 360
+#define BENCH_X_ROTATION 20
+
+// Where a frame's time went before its swap, and what it drew
+struct tessFrameTimes
+{
+    double tessellation;    // Choosing or building the mesh, ms
+    double submission;      // Handing it to OpenGL, ms
+    unsigned int triangles;
+    unsigned int culled;    // Of those, in clusters culled before submission
+    unsigned int instances; // Shapes drawn, more than one in the scene
+    unsigned int culledInstances;
+};
+
+// Draw frames frames of the active shape turning once about the y axis,
+// with OpenGL or the software renderer, printing frames and triangles per
+// second and where the time went, and writing the last frame to ppmPath if
+// it is not NULL; returns nonzero if no offscreen context could be made
+int offscreenBenchmark(int frames, const char* ppmPath, bool software);
+
+#endif
@@ -0,0 +1,722 @@
+////////////////////////////////////////////////////////////
+//
+// File:  bvh.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for picking.
+//
+//               Each split bins the centroids of its range into BVH_BINS
+//               slabs along every axis and takes the boundary minimizing
+//               BVH_NODE_COST + (area(left) * n(left) + area(right) *
+//               n(right)) / area(node), the expected cost of a ray that
+//               reaches the node, or a leaf if that is cheaper.  Queries
+//               visit the nearer child first and skip any box beyond the
+//               closest hit so far.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include "bvh.h"
+#include "meshlet.h"
+#include "parametric.h"
+#include "trace.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+// Deepest hierarchy a query walks with its stack on the thread's stack;
+// deeper ones take the room from the heap
+#define BVH_STACK_SIZE 64
+
+// Arrays the cached hierarchy was built from
+static MeshView cachedSource;
+static Bvh cached;
+static bool cacheValid = false;
+
+// A hierarchy prepareBvh() is building, the arrays it is of, and whether
+// it is to be given up
+static std::thread builder;
+static MeshView buildingSource;
+static Bvh prepared;
+static std::atomic<bool> buildCancelled(false);
+
+// Where frames are picked under, and what the last one picked
+static int cursorX = -1, cursorY = -1;
+static bool reportPick = false;
+static PickHit picked = { PICK_NONE, PICK_NONE, 0.0, Point3() };
+
+// Box of a triangle, rounded outwards to floats, moved about with the
+// triangle while building so every pass reads its range in order
+struct triangleBox
+{
+    float low[3];
+    float high[3];
+    unsigned int triangle;
+    unsigned char bin[3];       // Bin along each axis at the last split
+};
+
+///////////////////////////////////////////////////////////
+//Floats at or below and at or above a double
+///////////////////////////////////////////////////////////
+static float floatBelow(double value)
+{
+    float f = (float)value;
+    return f > value ? nextafterf(f, -HUGE_VALF) : f;
+}
+
+static float floatAbove(double value)
+{
+    float f = (float)value;
+    return f < value ? nextafterf(f, HUGE_VALF) : f;
+}
+
+///////////////////////////////////////////////////////////
+//Boxes
+///////////////////////////////////////////////////////////
+static void emptyBox(float low[3], float high[3])
+{
+    for (int a = 0 ; a < 3 ; ++a)
+    {
+        low[a] = HUGE_VALF;
+        high[a] = -HUGE_VALF;
+    }
+}
+
+static void growBox(float low[3], float high[3], const triangleBox& box)
+{
+    for (int a = 0 ; a < 3 ; ++a)
+    {
+        low[a] = std::min(low[a], box.low[a]);
+        high[a] = std::max(high[a], box.high[a]);
+    }
+}
+
+static double boxArea(const float low[3], const float high[3])
+{
+    double x = high[0] - low[0], y = high[1] - low[1], z = high[2] - low[2];
+    return x < 0.0 ? 0.0 : 2.0 * (x * y + y * z + z * x);
+}
+
+///////////////////////////////////////////////////////////
+//Build the subtree of boxes [first, first + count) into nodes, which it
+//is the first node of, returning its depth; spawnDepth counts the levels
+//of splits below it that may still be handed to another thread
+///////////////////////////////////////////////////////////
+static unsigned int buildNode(std::vector<triangleBox>& boxes, unsigned int first, unsigned int count,
+                              int spawnDepth, std::vector<BvhNode>& nodes)
+{
+    triangleBox* range = &boxes[first];
+
+    //Bounds of the triangles, and of their centroids
+    BvhNode node;
+    float centerLow[3], centerHigh[3];
+    emptyBox(node.low, node.high);
+    emptyBox(centerLow, centerHigh);
+    for (unsigned int i = 0 ; i < count ; ++i)
+    {
+        const triangleBox& box = range[i];
+        growBox(node.low, node.high, box);
+        for (int a = 0 ; a < 3 ; ++a)
+        {
+            float center = (box.low[a] + box.high[a]) / 2;
+            centerLow[a] = std::min(centerLow[a], center);
+            centerHigh[a] = std::max(centerHigh[a], center);
+        }
+    }
+    node.first = first;
+    node.count = count;
+
+    //Find the cheapest boundary between bins on any axis
+    int bestAxis = -1, bestBin = 0;
+    double bestCost = count;
+    if (count > BVH_LEAF_TRIANGLES)
+    {
+        //Bin along all three axes in one pass over the triangles
+        float binLow[3][BVH_BINS][3], binHigh[3][BVH_BINS][3];
+        unsigned int binCount[3][BVH_BINS] = { { 0 } };
+        double scale[3];
+        for (int a = 0 ; a < 3 ; ++a)
+        {
+            scale[a] = centerHigh[a] > centerLow[a] ? BVH_BINS / (double(centerHigh[a]) - centerLow[a]) : 0.0;
+            for (int b = 0 ; b < BVH_BINS ; ++b)
+                emptyBox(binLow[a][b], binHigh[a][b]);
+        }
+        for (unsigned int i = 0 ; i < count ; ++i)
+        {
+            triangleBox& box = range[i];
+            for (int a = 0 ; a < 3 ; ++a)
+            {
+                int b = std::min(BVH_BINS - 1, int(((box.low[a] + box.high[a]) / 2 - centerLow[a]) * scale[a]));
+                growBox(binLow[a][b], binHigh[a][b], box);
+                ++binCount[a][b];
+                box.bin[a] = b;
+            }
+        }
+
+        const double area = std::max(boxArea(node.low, node.high), 1e-30);
+        for (int a = 0 ; a < 3 ; ++a)
+        {
+            if (scale[a] == 0.0)
+                continue;
+
+            //Sweep from the right, then from the left, so each boundary
+            //knows the areas and counts on both sides
+            double rightArea[BVH_BINS];
+            unsigned int rightCount[BVH_BINS];
+            float low[3], high[3];
+            emptyBox(low, high);
+            unsigned int n = 0;
+            for (int b = BVH_BINS - 1 ; b > 0 ; --b)
+            {
+                for (int k = 0 ; k < 3 ; ++k)
+                {
+                    low[k] = std::min(low[k], binLow[a][b][k]);
+                    high[k] = std::max(high[k], binHigh[a][b][k]);
+                }
+                n += binCount[a][b];
+                rightArea[b] = boxArea(low, high);
+                rightCount[b] = n;
+            }
+            emptyBox(low, high);
+            n = 0;
+            for (int b = 1 ; b < BVH_BINS ; ++b)
+            {
+                for (int k = 0 ; k < 3 ; ++k)
+                {
+                    low[k] = std::min(low[k], binLow[a][b - 1][k]);
+                    high[k] = std::max(high[k], binHigh[a][b - 1][k]);
+                }
+                n += binCount[a][b - 1];
+                if (n == 0 || rightCount[b] == 0)
+                    continue;
+                double cost = BVH_NODE_COST + (boxArea(low, high) * n + rightArea[b] * rightCount[b]) / area;
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestBin = b;
+                }
+            }
+        }
+    }
+
+    //A leaf if no split pays, unless it would be too big
+    unsigned int leftCount = 0;
+    if (bestAxis >= 0)
+    {
+        //Each triangle goes to the side its bin was counted on
+        leftCount = std::partition(range, range + count, [&](const triangleBox& box)
+        {
+            return box.bin[bestAxis] < bestBin;
+        }) - range;
+    }
+    else if (count > BVH_MAX_LEAF_TRIANGLES)
+    {
+        //Every centroid is the same point, so any halves will do
+        leftCount = count / 2;
+    }
+    //A build being given up ends its subtrees here
+    if (leftCount == 0 || buildCancelled.load(std::memory_order_relaxed))
+    {
+        nodes.push_back(node);
+        return 0;
+    }
+
+    //The first child follows this node and the second goes after the
+    //first's subtree
+    unsigned int self = nodes.size();
+    node.count = 0;
+    nodes.push_back(node);
+    if (spawnDepth == 0 || std::min(leftCount, count - leftCount) < BVH_PARALLEL_MIN_TRIANGLES)
+    {
+        unsigned int leftDepth = buildNode(boxes, first, leftCount, spawnDepth - 1, nodes);
+        nodes[self].first = nodes.size();
+        return 1 + std::max(leftDepth, buildNode(boxes, first + leftCount, count - leftCount, spawnDepth - 1, nodes));
+    }
+
+    //A big enough second subtree is built alongside the first, on its own,
+    //then spliced in with its child links moved along with it
+    std::vector<BvhNode> second;
+    unsigned int rightDepth = 0;
+    std::thread worker([&]()
+    {
+        TRACE_SPAN("bvh subtree");
+        rightDepth = buildNode(boxes, first + leftCount, count - leftCount, spawnDepth - 1, second);
+    });
+    unsigned int leftDepth = buildNode(boxes, first, leftCount, spawnDepth - 1, nodes);
+    worker.join();
+
+    unsigned int offset = nodes.size();
+    nodes[self].first = offset;
+    for (unsigned int i = 0 ; i < second.size() ; ++i)
+    {
+        if (second[i].count == 0)
+            second[i].first += offset;
+        nodes.push_back(second[i]);
+    }
+    return 1 + std::max(leftDepth, rightDepth);
+}
+
+///////////////////////////////////////////////////////////
+//Build the hierarchy of a mesh
+///////////////////////////////////////////////////////////
+void buildBvh(const MeshView& mesh, Bvh& out)
+{
+    TRACE_SPAN("bvh");
+    const unsigned int triangles = mesh.triangleCount();
+    out.mesh = mesh;
+    out.depth = 0;
+    out.nodes.clear();
+    out.triangles.resize(triangles);
+    if (triangles == 0)
+        return;
+
+    std::vector<triangleBox> boxes(triangles);
+    parallelRows(triangles, 1, [&](int firstTriangle, int endTriangle)
+    {
+        for (int t = firstTriangle ; t < endTriangle ; ++t)
+        {
+            boxes[t].triangle = t;
+            for (int a = 0 ; a < 3 ; ++a)
+            {
+                double low = mesh.positions[mesh.indices[3 * t]][a], high = low;
+                for (int k = 1 ; k < 3 ; ++k)
+                {
+                    low = std::min(low, mesh.positions[mesh.indices[3 * t + k]][a]);
+                    high = std::max(high, mesh.positions[mesh.indices[3 * t + k]][a]);
+                }
+                boxes[t].low[a] = floatBelow(low);
+                boxes[t].high[a] = floatAbove(high);
+            }
+        }
+    });
+
+    //Splits are handed to other threads until there is one per thread
+    int spawnDepth = 0;
+    while ((1u << spawnDepth) < std::thread::hardware_concurrency())
+        ++spawnDepth;
+
+    std::vector<BvhNode> nodes;
+    nodes.reserve(2 * triangles / BVH_LEAF_TRIANGLES);
+    out.depth = buildNode(boxes, 0, triangles, spawnDepth, nodes);
+    out.nodes.assign(nodes.begin(), nodes.end());
+
+    //Leaves index the triangles in the order building left the boxes in
+    for (unsigned int i = 0 ; i < triangles ; ++i)
+        out.triangles[i] = boxes[i].triangle;
+}
+
+static bool sameArrays(const MeshView& a, const MeshView& b)
+{
+    return a.positions == b.positions && a.indices == b.indices &&
+           a.vertexCount == b.vertexCount && a.indexCount == b.indexCount;
+}
+
+///////////////////////////////////////////////////////////
+//Wait for the hierarchy being prepared, taking it as the cached one or,
+//if it is not wanted, stopping it where it is
+///////////////////////////////////////////////////////////
+static void finishPrepared(bool wanted)
+{
+    if (!builder.joinable())
+        return;
+    buildCancelled.store(!wanted, std::memory_order_relaxed);
+    builder.join();
+    buildCancelled.store(false, std::memory_order_relaxed);
+    if (wanted)
+    {
+        std::swap(cached, prepared);
+        cachedSource = buildingSource;
+        cacheValid = true;
+    }
+}
+
+static void stopPreparing()
+{
+    finishPrepared(false);
+}
+
+void prepareBvh(const MeshView& mesh)
+{
+    if (mesh.positions == NULL || mesh.indexCount == 0 ||
+        (cacheValid && sameArrays(cachedSource, mesh)) || (builder.joinable() && sameArrays(buildingSource, mesh)))
+        return;
+    finishPrepared(false);
+
+    static bool registered = false;
+    if (!registered)
+    {
+        atexit(stopPreparing);
+        registered = true;
+    }
+    buildingSource = mesh;
+    builder = std::thread([mesh]
+    {
+        TRACE_SPAN("bvh prepare");
+        buildBvh(mesh, prepared);
+    });
+}
+
+///////////////////////////////////////////////////////////
+//Hierarchy of a mesh, built once per set of arrays
+///////////////////////////////////////////////////////////
+const Bvh& bvhFor(const MeshView& mesh, bool* rebuilt)
+{
+    //What is left of a build started ahead on these arrays is waited for
+    if (builder.joinable())
+        finishPrepared(sameArrays(buildingSource, mesh));
+
+    bool stale = !cacheValid || !sameArrays(cachedSource, mesh);
+    if (rebuilt != NULL)
+        *rebuilt = stale;
+
+    if (stale)
+    {
+        buildBvh(mesh, cached);
+        cachedSource = mesh;
+        cacheValid = true;
+    }
+    return cached;
+}
+
+void forgetBvh()
+{
+    finishPrepared(false);
+    cacheValid = false;
+}
+
+///////////////////////////////////////////////////////////
+//Distance along the ray to a box, or HUGE_VAL if it misses or is
+//beyond limit
+///////////////////////////////////////////////////////////
+static double boxDistance(const BvhNode& node, const Point3& origin, const double inverse[3], double limit)
+{
+    double near = 0.0, far = limit;
+    for (int a = 0 ; a < 3 ; ++a)
+    {
+        double t0 = (node.low[a] - origin[a]) * inverse[a];
+        double t1 = (node.high[a] - origin[a]) * inverse[a];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        near = std::max(near, t0);
+        far = std::min(far, t1);
+    }
+    return near <= far ? near : HUGE_VAL;
+}
+
+///////////////////////////////////////////////////////////
+//Distance along the ray to a triangle (Moller and Trumbore), or HUGE_VAL
+///////////////////////////////////////////////////////////
+static double triangleDistance(const MeshView& mesh, unsigned int t, const Point3& origin, const Vector3& direction)
+{
+    const Point3& a = mesh.positions[mesh.indices[3 * t]];
+    Vector3 ab = mesh.positions[mesh.indices[3 * t + 1]] - a;
+    Vector3 ac = mesh.positions[mesh.indices[3 * t + 2]] - a;
+    Vector3 p = direction ^ ac;
+    double determinant = ab * p;
+    if (determinant == 0.0)
+        return HUGE_VAL;
+
+    double inverse = 1.0 / determinant;
+    Vector3 s = origin - a;
+    double u = (s * p) * inverse;
+    if (u < 0.0 || u > 1.0)
+        return HUGE_VAL;
+    Vector3 q = s ^ ab;
+    double v = (direction * q) * inverse;
+    if (v < 0.0 || u + v > 1.0)
+        return HUGE_VAL;
+    double distance = (ac * q) * inverse;
+    return distance > 0.0 ? distance : HUGE_VAL;
+}
+
+///////////////////////////////////////////////////////////
+//Fill in the rest of a hit once its triangle and distance are known
+///////////////////////////////////////////////////////////
+static PickHit finishHit(const MeshView& mesh, unsigned int triangle, double distance,
+                         const Point3& origin, const Vector3& direction)
+{
+    PickHit hit = { triangle, PICK_NONE, distance, origin + distance * direction };
+    if (triangle == PICK_NONE)
+        return hit;
+
+    double nearest = HUGE_VAL;
+    for (int k = 0 ; k < 3 ; ++k)
+    {
+        unsigned int vertex = mesh.indices[3 * triangle + k];
+        double d = hit.point.distanceToSquared(mesh.positions[vertex]);
+        if (d < nearest)
+        {
+            nearest = d;
+            hit.vertex = vertex;
+        }
+    }
+    return hit;
+}
+
+///////////////////////////////////////////////////////////
+//First triangle a ray hits
+///////////////////////////////////////////////////////////
+PickHit intersectBvh(const Bvh& bvh, const Point3& origin, const Vector3& direction)
+{
+    double inverse[3] = { 1.0 / direction.x, 1.0 / direction.y, 1.0 / direction.z };
+    unsigned int best = PICK_NONE;
+    double bestDistance = HUGE_VAL;
+
+    if (!bvh.nodes.empty() && boxDistance(bvh.nodes[0], origin, inverse, HUGE_VAL) != HUGE_VAL)
+    {
+        //Walking down holds at most one node per level besides the one
+        //being visited
+        unsigned int local[BVH_STACK_SIZE];
+        std::vector<unsigned int> deep;
+        unsigned int* stack = local;
+        if (bvh.depth + 1 > BVH_STACK_SIZE)
+        {
+            deep.resize(bvh.depth + 1);
+            stack = &deep[0];
+        }
+        int depth = 0;
+        stack[depth++] = 0;
+        while (depth > 0)
+        {
+            const BvhNode& node = bvh.nodes[stack[--depth]];
+            if (node.count > 0)
+            {
+                for (unsigned int i = node.first ; i < node.first + node.count ; ++i)
+                {
+                    double distance = triangleDistance(bvh.mesh, bvh.triangles[i], origin, direction);
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        best = bvh.triangles[i];
+                    }
+                }
+                continue;
+            }
+
+            //Push the farther child first so the nearer is visited next
+            unsigned int first = &node - &bvh.nodes[0] + 1, second = node.first;
+            double firstDistance = boxDistance(bvh.nodes[first], origin, inverse, bestDistance);
+            double secondDistance = boxDistance(bvh.nodes[second], origin, inverse, bestDistance);
+            if (firstDistance > secondDistance)
+            {
+                std::swap(first, second);
+                std::swap(firstDistance, secondDistance);
+            }
+            if (secondDistance != HUGE_VAL)
+                stack[depth++] = second;
+            if (firstDistance != HUGE_VAL)
+                stack[depth++] = first;
+        }
+    }
+
+    return finishHit(bvh.mesh, best, bestDistance, origin, direction);
+}
+
+///////////////////////////////////////////////////////////
+//Ray through a pixel of the tessellation window
+///////////////////////////////////////////////////////////
+void tessCursorRay(int x, int y, const shapeState& shape, Point3& origin, Vector3& direction)
+{
+    //The viewport and projection drawTessFrame sets up
+    double viewportX = 0.125 * windowSizex, viewportWidth = 0.75 * windowSizex;
+    double viewportHeight = 0.75 * windowSizey;
+    double ratio = (1.0 * windowSizex) / windowSizey;
+    double halfHeight = tan(QUARTER_CIRCLE / 2.0 * M_PI / 180.0);
+
+    //Through the pixel's center, in the eye's coordinates, which are the
+    //world's moved back by CAMERA_DISTANCE
+    double ndcX = 2.0 * (x + 0.5 - viewportX) / viewportWidth - 1.0;
+    double ndcY = 1.0 - 2.0 * (y + 0.5) / viewportHeight;
+    Vector3 eyeDirection(ndcX * halfHeight * ratio, ndcY * halfHeight, -1.0);
+
+    origin = tessEyePosition(shape);
+    direction = intoShape(shape, eyeDirection);
+}
+
+///////////////////////////////////////////////////////////
+//Picking under the cursor
+///////////////////////////////////////////////////////////
+void setPickCursor(int x, int y, bool report)
+{
+    cursorX = x;
+    cursorY = y;
+    reportPick = report;
+}
+
+const PickHit& pickFrame(const MeshView& mesh, const shapeState& shape)
+{
+    TRACE_SPAN("pick");
+    picked = finishHit(mesh, PICK_NONE, 0.0, Point3(), Vector3());
+    if (cursorX < 0 || mesh.indexCount == 0)
+        return picked;
+
+    Point3 origin;
+    Vector3 direction;
+    tessCursorRay(cursorX, cursorY, shape, origin, direction);
+    picked = intersectBvh(bvhFor(mesh), origin, direction);
+    if (reportPick)
+    {
+        if (picked.triangle == PICK_NONE)
+            printf("Nothing under (%d, %d)\n", cursorX, cursorY);
+        else
+            printf("Triangle %u, vertex %u at (%g, %g, %g)\n", picked.triangle, picked.vertex,
+                   mesh.positions[picked.vertex].x, mesh.positions[picked.vertex].y, mesh.positions[picked.vertex].z);
+        reportPick = false;
+    }
+    if (picked.triangle == PICK_NONE)
+        return picked;
+
+    //Fill the triangle behind its own edges, and mark the vertex on top
+    glPolygonMode(GL_FRONT, GL_FILL);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.0, 1.0);
+    glColor3f(RED_D);
+    glBegin(GL_TRIANGLES);
+    for (int k = 0 ; k < 3 ; ++k)
+    {
+        const Point3& p = mesh.positions[mesh.indices[3 * picked.triangle + k]];
+        glVertex3d(p.x, p.y, p.z);
+    }
+    glEnd();
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glPolygonMode(GL_FRONT, GL_LINE);
+
+    const Point3& vertex = mesh.positions[picked.vertex];
+    glDisable(GL_DEPTH_TEST);
+    glPointSize(PICK_POINT_SIZE);
+    glColor3f(BLUE_D);
+    glBegin(GL_POINTS);
+    glVertex3d(vertex.x, vertex.y, vertex.z);
+    glEnd();
+    glPointSize(1.0);
+    glEnable(GL_DEPTH_TEST);
+
+    return picked;
+}
+
+const PickHit& lastPick()
+{
+    return picked;
+}
+
+///////////////////////////////////////////////////////////
+//First triangle a ray hits, testing every one
+///////////////////////////////////////////////////////////
+static PickHit intersectAll(const MeshView& mesh, const Point3& origin, const Vector3& direction)
+{
+    unsigned int best = PICK_NONE;
+    double bestDistance = HUGE_VAL;
+    for (unsigned int t = 0 ; t < mesh.triangleCount() ; ++t)
+    {
+        double distance = triangleDistance(mesh, t, origin, direction);
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            best = t;
+        }
+    }
+    return finishHit(mesh, best, bestDistance, origin, direction);
+}
+
+///////////////////////////////////////////////////////////
+//Build and query times for each shape at several levels
+///////////////////////////////////////////////////////////
+struct reportLevel
+{
+    short rendering;
+    const char* name;
+    int primary;
+    int secondary;
+};
+
+static const reportLevel reportLevels[] =
+{
+    { RENDERING_CUBE, "Cube", 8, 1 },
+    { RENDERING_CUBE, "Cube", 150, 1 },
+    { RENDERING_CYL, "Cylinder", 150, 150 },
+    { RENDERING_CONE, "Cone", 150, 150 },
+    { RENDERING_SPH, "Sphere", 4, 1 },
+    { RENDERING_SPH, "Sphere", 6, 1 },
+    { RENDERING_SPH, "Sphere", 8, 1 },
+    { RENDERING_SPH, "Sphere", 9, 1 },
+};
+
+// Rays cast through a grid over the window for each mesh, and how many of
+// them are checked against testing every triangle
+#define REPORT_RAYS_ACROSS 100
+#define REPORT_CHECKED_RAYS 50
+
+int bvhReport()
+{
+    typedef std::chrono::steady_clock clock;
+    int failures = 0;
+
+    //An arbitrary turn, so no ray runs along the meshes' grid lines
+    shapeState shape = { 0, 0, 23.0, 41.0, 7.0 };
+    const int height = int(windowSizey * THREE_QUARTER_WINDOW);
+
+    printf("%-9s %9s %9s %9s %6s %9s %9s %11s\n", "Shape", "Level", "Triangles", "Nodes", "Depth", "Build ms", "Hits", "Query us");
+    for (unsigned int i = 0 ; i < sizeof(reportLevels) / sizeof(reportLevels[0]) ; ++i)
+    {
+        const reportLevel& level = reportLevels[i];
+        Mesh mesh;
+        generateMesh(level.rendering, level.primary, level.secondary, mesh);
+
+        Bvh bvh;
+        clock::time_point begin = clock::now();
+        buildBvh(mesh, bvh);
+        double buildMs = std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+
+        std::vector<Point3> origins;
+        std::vector<Vector3> directions;
+        for (int row = 0 ; row < REPORT_RAYS_ACROSS ; ++row)
+            for (int column = 0 ; column < REPORT_RAYS_ACROSS ; ++column)
+            {
+                Point3 origin;
+                Vector3 direction;
+                tessCursorRay(windowSizex * (column + 0.5) / REPORT_RAYS_ACROSS, height * (row + 0.5) / REPORT_RAYS_ACROSS,
+                              shape, origin, direction);
+                origins.push_back(origin);
+                directions.push_back(direction);
+            }
+
+        unsigned int hits = 0;
+        std::vector<PickHit> results(origins.size());
+        begin = clock::now();
+        for (unsigned int ray = 0 ; ray < origins.size() ; ++ray)
+            results[ray] = intersectBvh(bvh, origins[ray], directions[ray]);
+        double queryUs = std::chrono::duration<double, std::micro>(clock::now() - begin).count() / origins.size();
+
+        //Spread the checked rays over the grid
+        bool ok = true;
+        for (unsigned int ray = 0 ; ray < origins.size() ; ++ray)
+        {
+            hits += results[ray].triangle != PICK_NONE;
+            if (ray % (origins.size() / REPORT_CHECKED_RAYS) != 0)
+                continue;
+            //A ray through an edge may hit either triangle at the same distance
+            PickHit expected = intersectAll(mesh, origins[ray], directions[ray]);
+            ok = ok && (expected.triangle == results[ray].triangle ||
+                        (results[ray].triangle != PICK_NONE && fabs(expected.distance - results[ray].distance) < 1e-12));
+        }
+        failures += !ok;
+
+        char levelText[32];
+        sprintf(levelText, "%d x %d", level.primary, level.secondary);
+        printf("%-9s %9s %9u %9u %6u %9.2f %9u %11.2f%s\n", level.name, levelText, mesh.triangleCount(),
+               (unsigned int)bvh.nodes.size(), bvh.depth, buildMs, hits, queryUs, ok ? "" : "  DISAGREES WITH BRUTE FORCE");
+    }
+
+    return failures;
+}
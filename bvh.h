@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////
+//
+// File:  bvh.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for picking: a bounding
+//               volume hierarchy over a mesh's triangles, the ray through
+//               a point of the tessellation window, and the triangle and
+//               vertex that ray hits first.
+//
+//               The hierarchy is built top down with binned surface area
+//               heuristic splits.  Nodes are kept depth first in one
+//               array, a node's first child straight after it and the
+//               index of its second child in the node, so a query walks
+//               contiguous memory with no pointers.  Subtrees big enough
+//               to pay for a thread are built on their own and spliced in.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __BVH_H__
+#define __BVH_H__
+
+#include "resources.h"
+#include "mesh.h"
+
+// Nothing picked
+#define PICK_NONE 0xffffffffu
+
+// Centroid bins tried along each axis at every split
+#define BVH_BINS 16
+
+// Ranges this small always become leaves, and ranges up to the largest
+// leaf do if splitting would not pay
+#define BVH_LEAF_TRIANGLES 2
+#define BVH_MAX_LEAF_TRIANGLES 8
+
+// Cost of visiting a node, against 1 for testing a triangle
+#define BVH_NODE_COST 1.0
+
+// Size of the dot on the picked vertex, in pixels
+#define PICK_POINT_SIZE 7.0
+
+// Subtrees with fewer triangles than this are built by the thread that
+// split them off
+#define BVH_PARALLEL_MIN_TRIANGLES 16384
+
+// A box, rounded outwards to floats; leaves have count triangles starting
+// at first in the hierarchy's triangle list, and other nodes have count 0
+// and their second child at first
+struct BvhNode
+{
+    float low[3];
+    float high[3];
+    unsigned int first;
+    unsigned int count;
+};
+
+// depth is the most nodes below the root on the way to a leaf, which
+// bounds a query's stack of nodes still to visit
+struct Bvh
+{
+    trackedVector<BvhNode, MEMORY_TESSELLATION> nodes;
+    trackedVector<unsigned int, MEMORY_TESSELLATION> triangles;
+    MeshView mesh;
+    unsigned int depth;
+};
+
+// The first triangle a ray hits, the mesh vertex of it nearest the hit,
+// and where along the ray the hit is
+struct PickHit
+{
+    unsigned int triangle;      // PICK_NONE on a miss
+    unsigned int vertex;
+    double distance;
+    Point3 point;
+};
+
+// Build the hierarchy of a mesh's triangles into out
+void buildBvh(const MeshView& mesh, Bvh& out);
+
+// Hierarchy of a mesh, reusing the last one built if it was of the same
+// arrays (rebuilt, if given, says whether it was) and finishing one
+// prepareBvh() started on them; forgetBvh() drops it, stopping any build
+// under way, when those arrays are rewritten
+const Bvh& bvhFor(const MeshView& mesh, bool* rebuilt = NULL);
+void forgetBvh();
+
+// Start building the hierarchy of a mesh on a thread of its own, unless
+// it is built or being built already, so picking need not wait for all of
+// it
+void prepareBvh(const MeshView& mesh);
+
+// First triangle the ray from origin along direction hits, from either side
+PickHit intersectBvh(const Bvh& bvh, const Point3& origin, const Vector3& direction);
+
+// Ray through pixel (x, y) of the tessellation window, from the top left,
+// in the coordinates of a shape turned by shape's rotation
+void tessCursorRay(int x, int y, const shapeState& shape, Point3& origin, Vector3& direction);
+
+// Move the cursor frames are picked under, or take it away if x < 0; if
+// report is set the next frame prints what it picks
+void setPickCursor(int x, int y, bool report = false);
+
+// Pick under the cursor on mesh, the mesh the tessellation window draws
+// this frame, and highlight the hit in the current state
+const PickHit& pickFrame(const MeshView& mesh, const shapeState& shape);
+
+// What the last frame picked
+const PickHit& lastPick();
+
+// Build the hierarchy of each shape up to a million triangle sphere,
+// checking queries against testing every triangle and printing build and
+// query times; returns the number of meshes that disagreed
+int bvhReport();
+
+#endif
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////
+//
+// File:  coalesce.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for coalescing input.
+//
+////////////////////////////////////////////////////////////
+
+#include "resources.h"
+#include "coalesce.h"
+#include "latency.h"
+#include "replay.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+extern void markDirty(unsigned int changes);
+
+// Rotation queued since the last frame, and whether a frame is already
+// on its way to apply it
+static double queuedX = 0.0;
+static double queuedY = 0.0;
+static bool framePosted = false;
+
+// Whether a tessellation change is waiting to be built, when the first
+// one still waiting was asked for (sessionTime milliseconds), the
+// latency stamp of the event that asked for it (-1 for none), and a count
+// of requests identifying the latest one's timer
+static bool tessellationPending = false;
+static int firstRequest;
+static long long firstRequestStamp = -1;
+static int requestCount = 0;
+
+///////////////////////////////////////////////////////////
+//Queue rotation for the next frame
+///////////////////////////////////////////////////////////
+void queueRotation(double xDegrees, double yDegrees)
+{
+    queuedX += xDegrees;
+    queuedY += yDegrees;
+
+    //One redraw covers every event that arrives before it
+    if (!framePosted)
+    {
+        framePosted = true;
+        markDirty(DIRTY_ROTATION);
+    }
+    else
+        awaitDisplay(LATENCY_TESS_WINDOW);
+}
+
+void applyQueuedRotation()
+{
+    renderings[activeRendering].xRotation += queuedX;
+    renderings[activeRendering].yRotation += queuedY;
+    queuedX = queuedY = 0.0;
+    framePosted = false;
+}
+
+///////////////////////////////////////////////////////////
+//Build the tessellation that was last asked for
+///////////////////////////////////////////////////////////
+static void buildTessellation()
+{
+    tessellationPending = false;
+    tessChange = true;
+    markDirty(DIRTY_TESSELLATION);
+    if (replaying())
+        noteReplayBuild();
+
+    //The oldest request settled into this build is shown when the
+    //tessellation window swaps, though the build runs from a timer
+    if (firstRequestStamp >= 0)
+    {
+        awaitDeferred(firstRequestStamp, LATENCY_TESS_WINDOW);
+        firstRequestStamp = -1;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Timer callback of a tessellation request
+///////////////////////////////////////////////////////////
+static void settleTimer(int request)
+{
+    if (!tessellationPending)
+        return;
+
+    //The latest request has gone unanswered for debounceMs, or requests
+    //have kept coming for longer than the latency bound
+    if (request == requestCount || sessionTime() - firstRequest >= maxLatencyMs)
+        buildTessellation();
+}
+
+///////////////////////////////////////////////////////////
+//Ask for the tessellation to be rebuilt once requests settle
+///////////////////////////////////////////////////////////
+void requestTessellation()
+{
+    if (debounceMs <= 0)
+    {
+        buildTessellation();
+        return;
+    }
+
+    if (!tessellationPending)
+    {
+        tessellationPending = true;
+        firstRequest = sessionTime();
+        firstRequestStamp = deferDisplay();
+    }
+    sessionTimer(debounceMs, settleTimer, ++requestCount);
+}
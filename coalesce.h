@@ -0,0 +1,31 @@
+////////////////////////////////////////////////////////////
+//
+// File:  coalesce.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for coalescing input.
+//               Rotation from any number of motion events or key repeats
+//               is queued and applied once by the next frame, and changes
+//               to the tessellation level are debounced so that holding
+//               '+' builds only the level it settles on.  The debounce
+//               runs on the session's clock, so replays settle the same.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __COALESCE_H__
+#define __COALESCE_H__
+
+// Add to the rotation of the active shape at the next frame
+void queueRotation(double xDegrees, double yDegrees);
+
+// Apply the rotation queued since the last frame; called as the
+// tessellation window starts drawing
+void applyQueuedRotation();
+
+// Rebuild the tessellation once no further change has been asked for in
+// debounceMs, or at the latest maxLatencyMs after the first unbuilt one
+void requestTessellation();
+
+#endif
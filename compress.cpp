@@ -0,0 +1,957 @@
+////////////////////////////////////////////////////////////
+//
+// File:  compress.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the compressed
+//               mesh container.  The encoder may take its time; the
+//               decoder is a single pass over the packed values, whose
+//               lengths are read ahead of them, so loading stays bound by
+//               I/O.  The optional rANS pass makes files smaller but
+//               decodes several times slower.
+//
+//               Layout (doubles in host byte order, values little endian):
+//                   "TSM3", flags byte, varint vertex count, varint index
+//                   count, offset[3] and scale[3] as doubles, then the
+//                   stream: a length byte per vertex (three 2 bit codes,
+//                   length - 1 of each delta), the deltas, the indices
+//                   and a length byte per four indices (2 bit codes for 0,
+//                   1, 2 or 4 bytes).  With
+//                   COMPRESS_FLAG_ENTROPY each of those four parts is
+//                   instead a flag byte and either its varint length and
+//                   bytes (flag 0) or its varint length, the 256 symbol
+//                   frequencies as varints (each zero followed by a varint
+//                   count of the zeros after it) and the rANS bytes (flag 1).
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "resources.h"
+#include "compress.h"
+#include "quantize.h"
+
+// Lower bound of the rANS state, which is renormalized 16 bits at a time
+#define RANS_LOW (1u << 16)
+
+///////////////////////////////////////////////////////////
+//Varints and zigzag
+///////////////////////////////////////////////////////////
+static void putVarint(std::vector<unsigned char>& out, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+static inline bool getVarint(const unsigned char*& p, const unsigned char* end, unsigned int& value)
+{
+    value = 0;
+    for (int shift = 0 ; shift < 35 ; shift += 7)
+    {
+        if (p == end)
+            return false;
+        unsigned int byte = *p++;
+        value |= (byte & 0x7f) << shift;
+        if (byte < 0x80)
+            return true;
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////
+//Packed vertices: three deltas of 1 to 4 little endian bytes each, their
+//lengths less one in the 2 bit fields of a code byte.  The deltas take one
+//or two bytes about equally often, so a varint's branch on its length
+//would be mispredicted half the time; a code's layout is looked up instead.
+///////////////////////////////////////////////////////////
+static inline unsigned int packedLength(unsigned int value)
+{
+    return value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+}
+
+static void putPacked(std::vector<unsigned char>& out, unsigned int value, unsigned int length)
+{
+    for (unsigned int b = 0 ; b < length ; ++b)
+        out.push_back((unsigned char)(value >> (8 * b)));
+}
+
+// Where each delta of a vertex starts, the mask leaving its bytes of the
+// word read there, and the vertex's length, for every code
+struct vertexLayout
+{
+    unsigned char offset[3];
+    unsigned char length;
+    unsigned int mask[3];
+};
+
+struct vertexLayouts
+{
+    vertexLayout code[64];
+
+    constexpr vertexLayouts() : code()
+    {
+        for (int c = 0 ; c < 64 ; ++c)
+        {
+            unsigned int offset = 0;
+            for (int a = 0 ; a < 3 ; ++a)
+            {
+                unsigned int length = ((c >> (2 * a)) & 3) + 1;
+                code[c].offset[a] = offset;
+                code[c].mask[a] = 0xffffffffu >> (32 - 8 * length);
+                offset += length;
+            }
+            code[c].length = offset;
+        }
+    }
+};
+
+static constexpr vertexLayouts layouts;
+
+//Read the word a delta starts, which the caller knows is all there
+static inline unsigned int getWord(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static inline unsigned int zigzag(int value)
+{
+    return ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+}
+
+static inline int unzigzag(unsigned int value)
+{
+    return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+//Add a vertex's deltas to the running position and store it
+static inline void putVertex(const unsigned char* deltas, const vertexLayout& layout, int q[3],
+                             const double offset[3], const double step[3], Point3* position)
+{
+    q[0] += unzigzag(getWord(deltas + layout.offset[0]) & layout.mask[0]);
+    q[1] += unzigzag(getWord(deltas + layout.offset[1]) & layout.mask[1]);
+    q[2] += unzigzag(getWord(deltas + layout.offset[2]) & layout.mask[2]);
+    *position = Point3(offset[0] + step[0] * q[0], offset[1] + step[1] * q[1], offset[2] + step[2] * q[2]);
+}
+
+///////////////////////////////////////////////////////////
+//Packed indices: four to a code byte the same way, each taking 0, 1, 2 or
+//4 bytes.  A new vertex is 0 back and takes no bytes at all.
+///////////////////////////////////////////////////////////
+static constexpr unsigned int indexLengths[4] = { 0, 1, 2, 4 };
+
+static inline unsigned int indexCode(unsigned int value)
+{
+    return value == 0 ? 0 : value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : 3;
+}
+
+struct indexLayout
+{
+    unsigned char offset[4];
+    unsigned char length;
+    unsigned int mask[4];
+};
+
+struct indexLayouts
+{
+    indexLayout code[256];
+
+    constexpr indexLayouts() : code()
+    {
+        for (int c = 0 ; c < 256 ; ++c)
+        {
+            unsigned int offset = 0;
+            for (int k = 0 ; k < 4 ; ++k)
+            {
+                unsigned int length = indexLengths[(c >> (2 * k)) & 3];
+                code[c].offset[k] = offset;
+                code[c].mask[k] = length == 0 ? 0 : 0xffffffffu >> (32 - 8 * length);
+                offset += length;
+            }
+            code[c].length = offset;
+        }
+    }
+};
+
+static constexpr indexLayouts indexGroups;
+
+//Store the index back from the next new vertex, noting one not yet seen
+static inline void putIndex(unsigned int back, unsigned int& next, unsigned int& unseen, unsigned int* index)
+{
+    unseen |= back > next;
+    *index = next - back;
+    next += back == 0;
+}
+
+//Store a whole group, kept to one call site so that it is inlined and its
+//running values stay in registers
+static inline void putGroup(const unsigned char* read, const indexLayout& layout, unsigned int& next,
+                            unsigned int& unseen, unsigned int* index)
+{
+    putIndex(getWord(read + layout.offset[0]) & layout.mask[0], next, unseen, index);
+    putIndex(getWord(read + layout.offset[1]) & layout.mask[1], next, unseen, index + 1);
+    putIndex(getWord(read + layout.offset[2]) & layout.mask[2], next, unseen, index + 2);
+    putIndex(getWord(read + layout.offset[3]) & layout.mask[3], next, unseen, index + 3);
+}
+
+///////////////////////////////////////////////////////////
+//Score of a vertex for the triangle order (Forsyth's heuristic): vertices
+//recently used score high, and so do vertices with few triangles left
+///////////////////////////////////////////////////////////
+static double vertexScore(int cachePosition, unsigned int remaining)
+{
+    if (remaining == 0)
+        return -1.0;
+
+    double score = 0.0;
+    if (cachePosition >= 0)
+    {
+        //The last triangle's vertices get a fixed score so that strips
+        //do not keep turning back on themselves
+        if (cachePosition < 3)
+            score = 0.75;
+        else
+            score = pow(1.0 - double(cachePosition - 3) / (COMPRESS_CACHE_SIZE - 3), 1.5);
+    }
+    return score + 2.0 / sqrt((double)remaining);
+}
+
+///////////////////////////////////////////////////////////
+//Put the triangles in vertex cache order and renumber the vertices
+///////////////////////////////////////////////////////////
+void optimizeMeshOrder(const MeshView& mesh, Mesh& out)
+{
+    const unsigned int triangles = mesh.triangleCount();
+    const unsigned int vertices = mesh.vertexCount;
+
+    //Triangles using each vertex; the first remaining[v] of a vertex's
+    //list are the ones not yet emitted
+    std::vector<unsigned int> remaining(vertices, 0);
+    std::vector<unsigned int> useStart(vertices + 1, 0);
+    std::vector<unsigned int> useList(3 * triangles);
+    for (unsigned int i = 0 ; i < 3 * triangles ; ++i)
+        remaining[mesh.indices[i]]++;
+    for (unsigned int v = 0 ; v < vertices ; ++v)
+        useStart[v + 1] = useStart[v] + remaining[v];
+    std::vector<unsigned int> fill(useStart.begin(), useStart.end() - 1);
+    for (unsigned int i = 0 ; i < 3 * triangles ; ++i)
+        useList[fill[mesh.indices[i]]++] = i / 3;
+
+    std::vector<int> cachePosition(vertices, -1);
+    std::vector<double> score(vertices);
+    std::vector<double> triangleScore(triangles, 0.0);
+    std::vector<bool> emitted(triangles, false);
+    for (unsigned int v = 0 ; v < vertices ; ++v)
+        score[v] = vertexScore(-1, remaining[v]);
+    for (unsigned int t = 0 ; t < triangles ; ++t)
+        for (int k = 0 ; k < 3 ; ++k)
+            triangleScore[t] += score[mesh.indices[3 * t + k]];
+
+    std::vector<unsigned int> order;
+    order.reserve(triangles);
+    std::vector<unsigned int> cache, nextCache;
+    unsigned int cursor = 0;
+    long best = -1;
+
+    while (order.size() < triangles)
+    {
+        //Nothing in the cache has triangles left, so start somewhere new
+        if (best < 0)
+        {
+            while (emitted[cursor])
+                cursor++;
+            best = cursor;
+        }
+
+        const unsigned int t = best;
+        const unsigned int* corners = mesh.indices + 3 * t;
+        emitted[t] = true;
+        order.push_back(t);
+
+        //Retire the triangle from its vertices' lists
+        for (int k = 0 ; k < 3 ; ++k)
+        {
+            unsigned int v = corners[k];
+            unsigned int* uses = &useList[useStart[v]];
+            for (unsigned int i = 0 ; i < remaining[v] ; ++i)
+                if (uses[i] == t)
+                {
+                    uses[i] = uses[remaining[v] - 1];
+                    break;
+                }
+            remaining[v]--;
+        }
+
+        //Its vertices move to the front of the cache
+        nextCache.assign(corners, corners + 3);
+        for (unsigned int i = 0 ; i < cache.size() ; ++i)
+            if (cache[i] != corners[0] && cache[i] != corners[1] && cache[i] != corners[2])
+                nextCache.push_back(cache[i]);
+
+        for (unsigned int i = 0 ; i < nextCache.size() ; ++i)
+        {
+            unsigned int v = nextCache[i];
+            cachePosition[v] = i < COMPRESS_CACHE_SIZE ? (int)i : -1;
+            score[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+
+        //Rescore the triangles the changes touched and take the best
+        best = -1;
+        double bestScore = -1.0;
+        for (unsigned int i = 0 ; i < nextCache.size() ; ++i)
+        {
+            unsigned int v = nextCache[i];
+            for (unsigned int u = 0 ; u < remaining[v] ; ++u)
+            {
+                unsigned int other = useList[useStart[v] + u];
+                const unsigned int* c = mesh.indices + 3 * other;
+                triangleScore[other] = score[c[0]] + score[c[1]] + score[c[2]];
+                if (triangleScore[other] > bestScore)
+                {
+                    bestScore = triangleScore[other];
+                    best = other;
+                }
+            }
+        }
+
+        if (nextCache.size() > COMPRESS_CACHE_SIZE)
+            nextCache.resize(COMPRESS_CACHE_SIZE);
+        cache.swap(nextCache);
+    }
+
+    //Number the vertices in order of first use, dropping unused ones
+    std::vector<int> renumber(vertices, -1);
+    out.clear();
+    out.indices.reserve(3 * triangles);
+    for (unsigned int i = 0 ; i < triangles ; ++i)
+        for (int k = 0 ; k < 3 ; ++k)
+        {
+            unsigned int v = mesh.indices[3 * order[i] + k];
+            if (renumber[v] < 0)
+            {
+                renumber[v] = out.positions.size();
+                out.positions.push_back(mesh.positions[v]);
+                if (mesh.normals != NULL)
+                    out.normals.push_back(mesh.normals[v]);
+            }
+            out.indices.push_back(renumber[v]);
+        }
+}
+
+///////////////////////////////////////////////////////////
+//Scale symbol counts to frequencies summing to 2^COMPRESS_PROB_BITS,
+//keeping every symbol that occurs
+///////////////////////////////////////////////////////////
+static void normalizeFrequencies(const unsigned int counts[256], unsigned int total, unsigned int freq[256])
+{
+    const int target = 1 << COMPRESS_PROB_BITS;
+    int sum = 0;
+    for (int s = 0 ; s < 256 ; ++s)
+    {
+        freq[s] = 0;
+        if (counts[s] > 0)
+            freq[s] = std::max(1u, (unsigned int)((unsigned long long)counts[s] * target / total));
+        sum += freq[s];
+    }
+    if (sum == 0)
+        return;
+
+    //Settle rounding on the most frequent symbols
+    while (sum != target)
+    {
+        int largest = -1;
+        for (int s = 0 ; s < 256 ; ++s)
+            if (freq[s] > 1 && (largest < 0 || freq[s] > freq[largest]))
+                largest = s;
+        if (largest < 0)
+            for (int s = 0 ; s < 256 ; ++s)
+                if (freq[s] > 0)
+                    largest = s;
+        int step = sum < target ? 1 : -1;
+        freq[largest] += step;
+        sum += step;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Order-0 rANS with COMPRESS_RANS_STATES interleaved states.  Each state
+//has its own stream of bytes, so the decoder has that many independent
+//chains of work in flight rather than one shared read position.
+///////////////////////////////////////////////////////////
+static void ransEncode(const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
+{
+    unsigned int counts[256] = {0};
+    for (unsigned int i = 0 ; i < in.size() ; ++i)
+        counts[in[i]]++;
+
+    unsigned int freq[256], start[256];
+    normalizeFrequencies(counts, in.size(), freq);
+    for (int s = 0, cumulative = 0 ; s < 256 ; cumulative += freq[s], ++s)
+        start[s] = cumulative;
+
+    //Most symbols do not occur, so a zero frequency is followed by how
+    //many more zeros come after it
+    putVarint(out, in.size());
+    for (int s = 0 ; s < 256 ; )
+    {
+        putVarint(out, freq[s]);
+        int run = 1;
+        if (freq[s] == 0)
+        {
+            while (s + run < 256 && freq[s + run] == 0)
+                run++;
+            putVarint(out, run - 1);
+        }
+        s += run;
+    }
+
+    //rANS runs backwards, so each stream is filled from the end of a buffer
+    std::vector<unsigned char> buffers[COMPRESS_RANS_STATES];
+    unsigned char* streams[COMPRESS_RANS_STATES];
+    unsigned int state[COMPRESS_RANS_STATES];
+    for (int k = 0 ; k < COMPRESS_RANS_STATES ; ++k)
+    {
+        buffers[k].resize(2 * in.size() / COMPRESS_RANS_STATES + 8);
+        streams[k] = &buffers[k][0] + buffers[k].size();
+        state[k] = RANS_LOW;
+    }
+
+    for (long i = (long)in.size() - 1 ; i >= 0 ; --i)
+    {
+        unsigned int& x = state[i % COMPRESS_RANS_STATES];
+        unsigned char*& p = streams[i % COMPRESS_RANS_STATES];
+        unsigned int f = freq[in[i]];
+        //In 64 bits: a symbol with the whole table (f == 4096) puts the
+        //bound at 2^32
+        if (x >= (((unsigned long long)RANS_LOW >> COMPRESS_PROB_BITS) << 16) * f)
+        {
+            p -= 2;
+            p[0] = (unsigned char)x;
+            p[1] = (unsigned char)(x >> 8);
+            x >>= 16;
+        }
+        x = ((x / f) << COMPRESS_PROB_BITS) + (x % f) + start[in[i]];
+    }
+
+    //Each stream starts with its final state, and their lengths go first
+    for (int k = 0 ; k < COMPRESS_RANS_STATES ; ++k)
+    {
+        streams[k] -= 4;
+        for (int b = 0 ; b < 4 ; ++b)
+            streams[k][b] = (unsigned char)(state[k] >> (8 * b));
+        putVarint(out, &buffers[k][0] + buffers[k].size() - streams[k]);
+    }
+    for (int k = 0 ; k < COMPRESS_RANS_STATES ; ++k)
+        out.insert(out.end(), streams[k], &buffers[k][0] + buffers[k].size());
+}
+
+///////////////////////////////////////////////////////////
+//Decode one symbol, with everything about the slot in one table entry:
+//the symbol, its frequency less one, and the slot's offset in its range
+///////////////////////////////////////////////////////////
+static inline unsigned char ransSymbol(unsigned int& x, const unsigned int* slots)
+{
+    unsigned int entry = slots[x & ((1u << COMPRESS_PROB_BITS) - 1)];
+    x = (((entry >> 8) & 0xfff) + 1) * (x >> COMPRESS_PROB_BITS) + (entry >> 20);
+    return (unsigned char)entry;
+}
+
+static inline void ransStep(unsigned int& x, const unsigned char*& p, const unsigned int* slots, unsigned char* o)
+{
+    *o = ransSymbol(x, slots);
+
+    //A state needs at most one 16 bit word after each symbol.  Whether it
+    //needs it is a coin toss, so it is read without branching (the caller
+    //makes sure the word is there).  The shift by 0 or 16 is what keeps
+    //the compiler from spreading the four states over one vector
+    //register, which takes longer than the states one at a time.
+    unsigned int low = x < RANS_LOW;
+    x = (x << (16 * low)) | ((p[0] | (p[1] << 8)) & (0u - low));
+    p += 2 * low;
+}
+
+static bool ransDecode(const unsigned char*& p, const unsigned char* end, unsigned long long limit,
+                       std::vector<unsigned char>& out)
+{
+    unsigned int size;
+    if (!getVarint(p, end, size) || size > limit)
+        return false;
+
+    unsigned int freq[256], start[256];
+    unsigned int cumulative = 0;
+    for (unsigned int s = 0 ; s < 256 ; )
+    {
+        unsigned int run = 0;
+        if (!getVarint(p, end, freq[s]) || freq[s] > (1u << COMPRESS_PROB_BITS))
+            return false;
+        if (freq[s] == 0 && (!getVarint(p, end, run) || run > 255 - s))
+            return false;
+        for (unsigned int r = 0 ; r <= run ; ++r)
+        {
+            freq[s + r] = freq[s];
+            start[s + r] = cumulative;
+        }
+        cumulative += freq[s];
+        s += run + 1;
+    }
+    if (size > 0 && cumulative != (1u << COMPRESS_PROB_BITS))
+        return false;
+
+    unsigned int slots[1 << COMPRESS_PROB_BITS];
+    for (unsigned int s = 0 ; s < 256 ; ++s)
+        for (unsigned int slot = start[s] ; slot < start[s] + freq[s] ; ++slot)
+            slots[slot] = s | ((freq[s] - 1) << 8) | ((slot - start[s]) << 20);
+
+    //Find each state's stream and read the state off its front
+    unsigned int lengths[COMPRESS_RANS_STATES];
+    const unsigned char* streams[COMPRESS_RANS_STATES];
+    const unsigned char* ends[COMPRESS_RANS_STATES];
+    unsigned int x[COMPRESS_RANS_STATES];
+    for (int k = 0 ; k < COMPRESS_RANS_STATES ; ++k)
+        if (!getVarint(p, end, lengths[k]) || lengths[k] < 4)
+            return false;
+    for (int k = 0 ; k < COMPRESS_RANS_STATES ; ++k)
+    {
+        if ((unsigned int)(end - p) < lengths[k])
+            return false;
+        x[k] = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+        streams[k] = p + 4;
+        ends[k] = p + lengths[k];
+        p = ends[k];
+    }
+
+    const unsigned int base = out.size();
+    out.resize(base + size);
+    unsigned char* o = out.data() + base;
+    unsigned int i = 0;
+
+    //Each state reads at most one word a round, so the rounds that cannot
+    //run off the end of any stream are worked out a run at a time and run
+    //unchecked.  The states are copied to locals so that they live in
+    //registers.
+    unsigned int x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3];
+    const unsigned char* p0 = streams[0];
+    const unsigned char* p1 = streams[1];
+    const unsigned char* p2 = streams[2];
+    const unsigned char* p3 = streams[3];
+    for (;;)
+    {
+        long rounds = (size - i) / 4;
+        rounds = std::min(rounds, std::min(ends[0] - p0, ends[1] - p1) / 2);
+        rounds = std::min(rounds, std::min(ends[2] - p2, ends[3] - p3) / 2);
+        if (rounds <= 0)
+            break;
+        for (unsigned int stop = i + 4 * rounds ; i < stop ; i += 4)
+        {
+            ransStep(x0, p0, slots, o + i);
+            ransStep(x1, p1, slots, o + i + 1);
+            ransStep(x2, p2, slots, o + i + 2);
+            ransStep(x3, p3, slots, o + i + 3);
+        }
+    }
+    x[0] = x0; x[1] = x1; x[2] = x2; x[3] = x3;
+    streams[0] = p0; streams[1] = p1; streams[2] = p2; streams[3] = p3;
+
+    for ( ; i < size ; ++i)
+    {
+        int k = i % COMPRESS_RANS_STATES;
+        o[i] = ransSymbol(x[k], slots);
+        if (x[k] < RANS_LOW)
+        {
+            if (ends[k] - streams[k] < 2)
+                return false;
+            x[k] = (x[k] << 16) | streams[k][0] | (streams[k][1] << 8);
+            streams[k] += 2;
+        }
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//A part of the stream behind the entropy flag: a byte saying whether it is
+//rANS coded, then either the coded part or its varint length and bytes.
+//Each part has its own symbol frequencies, and a part coding would not
+//make smaller (as in small meshes, where the table outweighs the saving)
+//is stored as it is.
+///////////////////////////////////////////////////////////
+static void putPart(const std::vector<unsigned char>& part, std::vector<unsigned char>& out)
+{
+    std::vector<unsigned char> coded;
+    ransEncode(part, coded);
+
+    std::vector<unsigned char> stored;
+    putVarint(stored, part.size());
+    stored.insert(stored.end(), part.begin(), part.end());
+
+    const std::vector<unsigned char>& smaller = coded.size() < stored.size() ? coded : stored;
+    out.push_back(&smaller == &coded);
+    out.insert(out.end(), smaller.begin(), smaller.end());
+}
+
+static bool getPart(const unsigned char*& p, const unsigned char* end, unsigned long long limit,
+                    std::vector<unsigned char>& out)
+{
+    if (p == end || *p > 1)
+        return false;
+    if (*p++ == 1)
+        return ransDecode(p, end, limit, out);
+
+    unsigned int size;
+    if (!getVarint(p, end, size) || size > limit || size > (unsigned long)(end - p))
+        return false;
+    out.insert(out.end(), p, p + size);
+    p += size;
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//Compress a mesh
+///////////////////////////////////////////////////////////
+void compressMesh(const MeshView& mesh, bool entropy, std::vector<unsigned char>& out)
+{
+    Mesh ordered;
+    optimizeMeshOrder(mesh, ordered);
+    QuantizedMesh quantized;
+    quantizeMesh(ordered, quantized);
+
+    out.assign(COMPRESS_MAGIC, COMPRESS_MAGIC + 4);
+    out.push_back(entropy ? COMPRESS_FLAG_ENTROPY : 0);
+    putVarint(out, quantized.vertexCount());
+    putVarint(out, quantized.indexCount);
+    const unsigned char* ranges[2] = { (const unsigned char*)quantized.offset, (const unsigned char*)quantized.scale };
+    for (int k = 0 ; k < 2 ; ++k)
+        out.insert(out.end(), ranges[k], ranges[k] + 3 * sizeof(double));
+
+    //Each vertex's three deltas from the vertex before have their lengths
+    //in one byte, all the vertices' lengths ahead of all their values
+    std::vector<unsigned char> lengths, values;
+    lengths.reserve(quantized.vertexCount());
+    values.reserve(2 * quantized.positions.size());
+    int previous[3] = { 0, 0, 0 };
+    for (unsigned int i = 0 ; i < quantized.positions.size() ; i += 3)
+    {
+        unsigned char code = 0;
+        for (int a = 0 ; a < 3 ; ++a)
+        {
+            unsigned int delta = zigzag(quantized.positions[i + a] - previous[a]);
+            unsigned int length = packedLength(delta);
+            code |= (length - 1) << (2 * a);
+            putPacked(values, delta, length);
+            previous[a] = quantized.positions[i + a];
+        }
+        lengths.push_back(code);
+    }
+
+    //Vertices are numbered in order of first use, so an index is either the
+    //next new vertex or one a short way behind it.  Their codes, one per
+    //group of four, go after all the values.
+    std::vector<unsigned char> groups((quantized.indexCount + 3) / 4, 0), backs;
+    unsigned int next = 0;
+    for (unsigned int i = 0 ; i < quantized.indexCount ; ++i)
+    {
+        unsigned int index = quantized.indices[i];
+        unsigned int code = indexCode(next - index);
+        groups[i / 4] |= code << (2 * (i % 4));
+        putPacked(backs, next - index, indexLengths[code]);
+        if (index == next)
+            next++;
+    }
+
+    const std::vector<unsigned char>* parts[COMPRESS_PARTS] = { &lengths, &values, &backs, &groups };
+    for (int k = 0 ; k < COMPRESS_PARTS ; ++k)
+        if (entropy)
+            putPart(*parts[k], out);
+        else
+            out.insert(out.end(), parts[k]->begin(), parts[k]->end());
+}
+
+///////////////////////////////////////////////////////////
+//Decompress a mesh
+///////////////////////////////////////////////////////////
+bool decompressMesh(const unsigned char* data, unsigned int size, Mesh& out)
+{
+    const unsigned char* p = data;
+    const unsigned char* end = data + size;
+    if (size < 5 || memcmp(p, COMPRESS_MAGIC, 4) != 0)
+        return false;
+    unsigned char flags = p[4];
+    p += 5;
+
+    unsigned int vertexCount, indexCount;
+    if (!getVarint(p, end, vertexCount) || !getVarint(p, end, indexCount) || indexCount % 3 != 0)
+        return false;
+
+    double offset[3], scale[3];
+    if (end - p < (long)(6 * sizeof(double)))
+        return false;
+    memcpy(offset, p, sizeof(offset));
+    memcpy(scale, p + sizeof(offset), sizeof(scale));
+    p += sizeof(offset) + sizeof(scale);
+
+    //The entropy stage decodes into a buffer kept between calls
+    static thread_local std::vector<unsigned char> decoded;
+    if (flags & COMPRESS_FLAG_ENTROPY)
+    {
+        //A vertex takes at most 13 bytes and an index 5
+        const unsigned long long limit = 13ull * vertexCount + 5ull * indexCount;
+        decoded.clear();
+        for (int k = 0 ; k < COMPRESS_PARTS ; ++k)
+            if (!getPart(p, end, limit - decoded.size(), decoded))
+                return false;
+        if (p != end)
+            return false;
+        p = decoded.data();
+        end = p + decoded.size();
+    }
+
+    //Every vertex takes at least four bytes, and every four indices one
+    if (4ull * vertexCount + (indexCount + 3ull) / 4 > (unsigned long long)(end - p))
+        return false;
+
+    double step[3];
+    for (int a = 0 ; a < 3 ; ++a)
+        step[a] = scale[a] / QUANTIZE_RANGE;
+
+    out.positions.resize(vertexCount);
+    out.indices.resize(indexCount);
+
+    //The codes come ahead of the deltas, so where each vertex starts is a
+    //sum of table lookups rather than waiting on the bytes before it.  A
+    //vertex is at most 12 bytes and its last delta's word reaches 3 past
+    //it, so how many vertices can be read unchecked is worked out a run at
+    //a time and the loop itself has no branch on the bytes.  The stream is
+    //read through a copy of p, which the checked reads would otherwise
+    //keep in memory rather than a register.
+    const unsigned char* codes = p;
+    const unsigned char* read = p + vertexCount;
+    int q[3] = { 0, 0, 0 };
+    unsigned int badCodes = 0;
+    unsigned char tail[15];
+    Point3* position = out.positions.data();
+    unsigned int i = 0;
+    while (i < vertexCount)
+    {
+        long room = end - read;
+        unsigned int run = room >= 15 ? std::min<unsigned long>(vertexCount - i, (room - 15) / 12 + 1) : 0;
+        for (unsigned int stop = i + run ; i < stop ; ++i)
+        {
+            badCodes |= codes[i];
+            const vertexLayout& layout = layouts.code[codes[i] & 63];
+            putVertex(read, layout, q, offset, step, position + i);
+            read += layout.length;
+        }
+
+        //The last few vertices are read from a padded copy
+        if (run == 0)
+        {
+            badCodes |= codes[i];
+            const vertexLayout& layout = layouts.code[codes[i] & 63];
+            if (room < layout.length)
+                return false;
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, read, room);
+            putVertex(tail, layout, q, offset, step, position + i);
+            read += layout.length;
+            ++i;
+        }
+    }
+    if (badCodes >= 64)
+        return false;
+
+    //The indices are read four at a time from their values in the same
+    //way.  Their codes are the last bytes of the stream, so that the
+    //values' unchecked reads stay within it even when there are none.  An
+    //index that is not the next new vertex must be one already seen; one
+    //that is not is noted and the mesh failed once all are read.
+    const unsigned int groupCount = (indexCount + 3) / 4;
+    if ((unsigned long long)(end - read) < groupCount)
+        return false;
+    const unsigned char* groups = end - groupCount;
+    const unsigned int fullGroups = indexCount / 4;
+    unsigned int next = 0;
+    unsigned int unseen = 0;
+    unsigned char groupTail[16];
+    unsigned int* index = out.indices.data();
+    unsigned int g = 0;
+    while (g < groupCount)
+    {
+        long room = end - read;
+        unsigned int run = room >= 16 ? std::min<unsigned long>(fullGroups - g, (room - 16) / 16 + 1) : 0;
+        for (unsigned int stop = g + run ; g < stop ; ++g, index += 4)
+        {
+            const indexLayout& layout = indexGroups.code[groups[g]];
+            putGroup(read, layout, next, unseen, index);
+            read += layout.length;
+        }
+
+        //The last group may be short, and its unused codes must be 0
+        if (run == 0)
+        {
+            const indexLayout& layout = indexGroups.code[groups[g]];
+            unsigned int count = std::min(4u, indexCount - 4 * g);
+            if (groups - read < layout.length || (groups[g] >> (2 * count)) != 0)
+                return false;
+            memset(groupTail, 0, sizeof(groupTail));
+            memcpy(groupTail, read, std::min<long>(room, sizeof(groupTail)));
+            for (unsigned int k = 0 ; k < count ; ++k)
+                putIndex(getWord(groupTail + layout.offset[k]) & layout.mask[k], next, unseen, index + k);
+            read += layout.length;
+            index += count;
+            ++g;
+        }
+    }
+    if (unseen || next > vertexCount)
+        return false;
+
+    return read == groups;
+}
+
+///////////////////////////////////////////////////////////
+//Compress a mesh into a file
+///////////////////////////////////////////////////////////
+bool writeCompressedMesh(const std::string& path, const MeshView& mesh, bool entropy)
+{
+    std::vector<unsigned char> bytes;
+    compressMesh(mesh, entropy, bytes);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == NULL)
+        return false;
+    bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && written;
+}
+
+///////////////////////////////////////////////////////////
+//Check a decoded mesh against the source put in the same order
+///////////////////////////////////////////////////////////
+static bool roundTrips(const Mesh& ordered, const Mesh& decoded, double bound)
+{
+    if (decoded.positions.size() != ordered.positions.size() || decoded.indices != ordered.indices)
+        return false;
+    for (unsigned int i = 0 ; i < ordered.positions.size() ; ++i)
+        if ((decoded.positions[i] - ordered.positions[i]).length() > bound * (1 + 1e-9) + 1e-15)
+            return false;
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//Container bytes decoded per second, by the fastest of the runs in a tenth
+//of a second so that other work on the machine does not count against
+//the decoder; loading keeps up with a disk reading at that rate
+///////////////////////////////////////////////////////////
+static double decodeSpeed(const std::vector<unsigned char>& bytes, Mesh& decoded)
+{
+    typedef std::chrono::steady_clock clock;
+    clock::time_point begin = clock::now();
+    double fastest = 0.0;
+    do
+    {
+        clock::time_point start = clock::now();
+        decompressMesh(bytes.data(), bytes.size(), decoded);
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        if (fastest == 0.0 || seconds < fastest)
+            fastest = seconds;
+    } while (clock::now() - begin < std::chrono::milliseconds(100));
+
+    return double(bytes.size()) / fastest;
+}
+
+///////////////////////////////////////////////////////////
+//Size and speed of the container for each shape at several levels
+///////////////////////////////////////////////////////////
+struct reportLevel
+{
+    short rendering;
+    const char* name;
+    int primary;
+    int secondary;
+};
+
+static const reportLevel reportLevels[] =
+{
+    { RENDERING_CUBE, "Cube", 1, 1 },
+    { RENDERING_CUBE, "Cube", 8, 1 },
+    { RENDERING_CUBE, "Cube", 64, 1 },
+    { RENDERING_CYL, "Cylinder", 8, 2 },
+    { RENDERING_CYL, "Cylinder", 32, 8 },
+    { RENDERING_CYL, "Cylinder", 150, 64 },
+    { RENDERING_CONE, "Cone", 8, 2 },
+    { RENDERING_CONE, "Cone", 32, 8 },
+    { RENDERING_CONE, "Cone", 150, 64 },
+    { RENDERING_SPH, "Sphere", 1, 1 },
+    { RENDERING_SPH, "Sphere", 4, 1 },
+    { RENDERING_SPH, "Sphere", 6, 1 },
+};
+
+// Container bytes a second the decoder must keep up with, so that loading
+// stays bound by I/O
+#define REPORT_DECODE_BAR 1e9
+
+int compressReport()
+{
+    int failures = 0;
+    int slowEntropy = 0;
+
+    printf("%-9s %9s %9s %10s %16s %16s %10s %10s\n",
+           "Shape", "Level", "Triangles", "Raw bytes", "Packed (ratio)", "rANS (ratio)", "GB/s", "GB/s rANS");
+    for (unsigned int i = 0 ; i < sizeof(reportLevels) / sizeof(reportLevels[0]) ; ++i)
+    {
+        const reportLevel& level = reportLevels[i];
+        Mesh mesh, ordered, decoded;
+        generateMesh(level.rendering, level.primary, level.secondary, mesh);
+        optimizeMeshOrder(mesh, ordered);
+        QuantizedMesh quantized;
+        quantizeMesh(ordered, quantized);
+
+        std::vector<unsigned char> packed, entropy;
+        compressMesh(mesh, false, packed);
+        compressMesh(mesh, true, entropy);
+
+        bool ok = decompressMesh(packed.data(), packed.size(), decoded) && roundTrips(ordered, decoded, quantized.errorBound);
+        ok = ok && decompressMesh(entropy.data(), entropy.size(), decoded) && roundTrips(ordered, decoded, quantized.errorBound);
+        failures += !ok;
+
+        //The packed container is the one loading depends on, so a row it
+        //misses the bar on fails.  The entropy stage gives up decode speed
+        //for size and is flagged but counted separately.
+        double packedSpeed = decodeSpeed(packed, decoded);
+        double entropySpeed = decodeSpeed(entropy, decoded);
+        failures += packedSpeed < REPORT_DECODE_BAR;
+        slowEntropy += entropySpeed < REPORT_DECODE_BAR;
+
+        double raw = mesh.positions.size() * sizeof(Point3) + mesh.indices.size() * sizeof(unsigned int);
+        char levelText[32], packedText[32], entropyText[32];
+        sprintf(levelText, "%d x %d", level.primary, level.secondary);
+        sprintf(packedText, "%lu (%.1fx)", (unsigned long)packed.size(), raw / packed.size());
+        sprintf(entropyText, "%lu (%.1fx)", (unsigned long)entropy.size(), raw / entropy.size());
+        printf("%-9s %9s %9u %10.0f %16s %16s %10.2f %10.2f%s%s%s\n", level.name, levelText, mesh.triangleCount(), raw,
+               packedText, entropyText, packedSpeed / 1e9, entropySpeed / 1e9,
+               packedSpeed < REPORT_DECODE_BAR ? "  PACKED BELOW BAR" : "",
+               entropySpeed < REPORT_DECODE_BAR ? "  rANS BELOW BAR" : "",
+               ok ? "" : "  ROUND TRIP FAILED");
+    }
+    printf("GB/s is container bytes decoded per second on one core; the bar is %.2f GB/s\n", REPORT_DECODE_BAR / 1e9);
+    if (slowEntropy > 0)
+        printf("rANS decode is below the bar on %d of %d rows\n", slowEntropy,
+               (int)(sizeof(reportLevels) / sizeof(reportLevels[0])));
+
+    //A stream of one symbol gives that symbol the whole table
+    std::vector<unsigned char> single(4096, 7), coded, decodedSingle;
+    ransEncode(single, coded);
+    const unsigned char* p = coded.data();
+    if (!ransDecode(p, coded.data() + coded.size(), single.size(), decodedSingle) || decodedSingle != single)
+    {
+        printf("A stream of one symbol did not round trip through rANS\n");
+        failures++;
+    }
+
+    return failures;
+}
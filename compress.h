@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////
+//
+// File:  compress.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the compressed mesh
+//               container used to archive the tessellator's output.
+//
+//               Triangles are first put in vertex cache order and the
+//               vertices renumbered in order of first use.  Vertices are
+//               then quantized to 16 bits per axis and stored as zigzag
+//               deltas from the vertex before, and each index as its
+//               distance below the next unused vertex number (0 for a new
+//               vertex), each value in as few bytes as hold it.  An
+//               order-0 rANS stage can be run over each part of the result
+//               for archives where size matters more than load time.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __COMPRESS_H__
+#define __COMPRESS_H__
+
+#include <string>
+#include <vector>
+#include "mesh.h"
+
+// Container header
+#define COMPRESS_MAGIC "TSM3"
+#define COMPRESS_FLAG_ENTROPY 1
+
+// Parts of the stream: vertex codes, vertex deltas, indices, index codes
+#define COMPRESS_PARTS 4
+
+// Vertex cache the triangle order is optimized for
+#define COMPRESS_CACHE_SIZE 32
+
+// rANS probabilities are out of 2^COMPRESS_PROB_BITS
+#define COMPRESS_PROB_BITS 12
+
+// Interleaved rANS states (the decoder's main loop is unrolled for four)
+#define COMPRESS_RANS_STATES 4
+
+// Put the triangles of mesh in vertex cache order, renumbering the vertices
+// in order of first use; this is the order a decoded mesh comes back in
+void optimizeMeshOrder(const MeshView& mesh, Mesh& out);
+
+// Compress a mesh, with or without the entropy stage
+void compressMesh(const MeshView& mesh, bool entropy, std::vector<unsigned char>& out);
+
+// Decompress a container into out, returning false if it is malformed
+bool decompressMesh(const unsigned char* data, unsigned int size, Mesh& out);
+
+// Compress a mesh into a file, returning false if it could not be written
+bool writeCompressedMesh(const std::string& path, const MeshView& mesh, bool entropy);
+
+// Compress every shape at several levels, checking that each decodes to
+// the generator's mesh and printing sizes and decode speed (container
+// bytes per second); returns the number of meshes that did not round trip
+// or whose packed container decoded below 1 GB/s
+int compressReport();
+
+#endif
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////
+//
+// File:  ctmath.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the math the generators share with the
+//               meshes baked in at compile time.  Everything here gives
+//               the same bits whether the compiler or the program runs
+//               it: sine and cosine are evaluated by the same series both
+//               ways, and the square root is correctly rounded both ways
+//               (exact integer arithmetic for the compiler, the hardware
+//               instruction at run time).
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __CTMATH_H__
+#define __CTMATH_H__
+
+#include <cmath>
+#include <type_traits>
+
+// Two parts of pi/2 whose sum is accurate well past double precision, so
+// that reducing an angle by multiples of it loses nothing
+#define CT_HALF_PI_HI 1.57079632679489655800e+00
+#define CT_HALF_PI_LO 6.12323399573676603587e-17
+
+///////////////////////////////////////////////////////////
+//Correctly rounded square root the compiler can evaluate
+///////////////////////////////////////////////////////////
+constexpr double ctExactSqrt(double x)
+{
+    if (!(x > 0))
+        return 0.0;
+
+    //Scale by powers of 4 (exact) until 1 <= x < 4
+    double scale = 1.0;
+    while (x >= 4.0) { x *= 0.25; scale *= 2.0; }
+    while (x < 1.0) { x *= 4.0; scale *= 0.5; }
+
+    //x * 2^104 is an integer whose root has 53 significant bits
+    __extension__ typedef unsigned __int128 wide;
+    wide n = (wide)(unsigned long long)(x * 4503599627370496.0) << 52;
+
+    //Digit by digit integer square root
+    wide root = 0;
+    wide bit = (wide)1 << 106;
+    while (bit > n)
+        bit >>= 2;
+    while (bit != 0)
+    {
+        if (n >= root + bit)
+        {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+            root >>= 1;
+        bit >>= 2;
+    }
+
+    //n is now the remainder; the root is never exactly halfway
+    if (n > root)
+        root++;
+
+    return (double)(unsigned long long)root / 4503599627370496.0 * scale;
+}
+
+///////////////////////////////////////////////////////////
+//Square root shared by the generators and the baked meshes
+///////////////////////////////////////////////////////////
+constexpr double ctSqrt(double x)
+{
+    if (std::is_constant_evaluated())
+        return ctExactSqrt(x);
+    return std::sqrt(x);
+}
+
+///////////////////////////////////////////////////////////
+//Sine and cosine of |x| <= pi/4 by their Taylor series
+///////////////////////////////////////////////////////////
+constexpr double ctSinKernel(double x)
+{
+    double x2 = x * x;
+    double term = x;
+    double sum = x;
+    for (int k = 1 ; k <= 11 ; ++k)
+    {
+        term *= -x2 / ((2 * k) * (2 * k + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double ctCosKernel(double x)
+{
+    double x2 = x * x;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1 ; k <= 11 ; ++k)
+    {
+        term *= -x2 / ((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+///////////////////////////////////////////////////////////
+//Reduce x to r in [-pi/4, pi/4], returning which quarter turn it was in
+///////////////////////////////////////////////////////////
+constexpr int ctQuadrant(double x, double& r)
+{
+    double turns = x / CT_HALF_PI_HI;
+    long long q = (long long)(turns < 0 ? turns - 0.5 : turns + 0.5);
+    r = (x - q * CT_HALF_PI_HI) - q * CT_HALF_PI_LO;
+    return (int)(q & 3);
+}
+
+constexpr double ctSin(double x)
+{
+    double r = 0.0;
+    switch (ctQuadrant(x, r))
+    {
+    case 0:  return ctSinKernel(r);
+    case 1:  return ctCosKernel(r);
+    case 2:  return -ctSinKernel(r);
+    default: return -ctCosKernel(r);
+    }
+}
+
+constexpr double ctCos(double x)
+{
+    double r = 0.0;
+    switch (ctQuadrant(x, r))
+    {
+    case 0:  return ctCosKernel(r);
+    case 1:  return -ctSinKernel(r);
+    case 2:  return -ctCosKernel(r);
+    default: return ctSinKernel(r);
+    }
+}
+
+#endif
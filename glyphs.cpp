@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////
+//
+// File:  glyphs.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for drawing text from
+//               glyph display lists.
+//
+////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <map>
+#include "glyphs.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+// Each GLUT window has its own context, and so its own lists; the first
+// list of each font, by window
+static std::map<int, GLuint> glyphBases;
+
+// The GLUT fonts behind GLYPHS_SMALL, etc.
+static void* glyphFont(int font)
+{
+    switch (font)
+    {
+    case GLYPHS_LABEL:
+        return GLUT_BITMAP_HELVETICA_18;
+    case GLYPHS_LARGE:
+        return GLUT_BITMAP_TIMES_ROMAN_24;
+    default:
+        return GLUT_BITMAP_HELVETICA_12;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Build the glyph lists for the current window
+///////////////////////////////////////////////////////////
+void loadGlyphs()
+{
+    int window = glutGetWindow();
+    if (glyphBases.count(window))
+        return;
+
+    //One list per ASCII character per font, each just drawing the glyph
+    //(which also moves the raster position on past it)
+    GLuint base = glGenLists(GLYPH_FONTS * 128);
+    for (int font = 0 ; font < GLYPH_FONTS ; ++font)
+        for (int c = 0 ; c < 128 ; ++c)
+        {
+            glNewList(base + font * 128 + c, GL_COMPILE);
+            glutBitmapCharacter(glyphFont(font), c);
+            glEndList();
+        }
+
+    glyphBases[window] = base;
+}
+
+///////////////////////////////////////////////////////////
+//Draw text from the glyph lists
+///////////////////////////////////////////////////////////
+void drawGlyphs(int font, const char* text)
+{
+    std::map<int, GLuint>::const_iterator base = glyphBases.find(glutGetWindow());
+    if (base == glyphBases.end())
+        return;
+
+    glListBase(base->second + font * 128);
+    glCallLists(strlen(text), GL_UNSIGNED_BYTE, text);
+}
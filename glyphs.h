@@ -0,0 +1,32 @@
+////////////////////////////////////////////////////////////
+//
+// File:  glyphs.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for drawing text from
+//               display lists, one per glyph, so that a whole string is a
+//               single glCallLists instead of a glutBitmapCharacter call
+//               per character.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __GLYPHS_H__
+#define __GLYPHS_H__
+
+// Fonts with glyph lists
+#define GLYPHS_SMALL 0      // GLUT_BITMAP_HELVETICA_12
+#define GLYPHS_LABEL 1      // GLUT_BITMAP_HELVETICA_18
+#define GLYPHS_LARGE 2      // GLUT_BITMAP_TIMES_ROMAN_24
+#define GLYPH_FONTS  3
+
+// Build the glyph lists of every font in the current window's context, if
+// not done yet.  This must not be called while a display list is being
+// compiled, so windows call it before compiling anything that draws text.
+void loadGlyphs();
+
+// Draw text in the given font at the current raster position
+void drawGlyphs(int font, const char* text);
+
+#endif
@@ -9,11 +9,16 @@
 INCLUDE =
 LIBDIRS =
 
-LDLIBS = -lglut -lGLU -lGL -lXext -lX11 -lm
+LDLIBS = -lglut -lGLU -lGL -lEGL -lXext -lX11 -lm
 
-CFLAGS = -g $(INCLUDE)
+# Trace spans (trace.h); build with "make TRACE=0" to compile them out
+TRACE = 1
+
+# The generators and the baked meshes must round the same way, so no
+# multiply-add may be fused in one and not the other
+CFLAGS = -g -O2 -pthread -ffp-contract=off -DTRACE_ENABLED=$(TRACE) $(INCLUDE)
 CCFLAGS =  $(CFLAGS)
-CXXFLAGS = $(CFLAGS)
+CXXFLAGS = $(CFLAGS) -std=c++20
 
 LIBFLAGS = -g $(LIBDIRS) $(LDLIBS)
 CLIBFLAGS = $(LIBFLAGS)
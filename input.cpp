@@ -13,19 +13,27 @@
 
 #include "resources.h"
 #include "input.h"
+#include "refine.h"
+#include "glyphs.h"
+#include "coalesce.h"
+#include "latency.h"
+#include "replay.h"
+#include "bvh.h"
+#include "mesh.h"
 #if defined(__APPLE__) && defined(__MACH__)
 #include <GLUT/glut.h>
 #else
 #include <GL/glut.h>
 #endif
 
-extern void refreshAll();
+extern void markDirty(unsigned int changes);
+extern void exportMesh();
 
-void UpdateTextEntry(char key)
+unsigned int UpdateTextEntry(char key)
 {
     //If the key is not a valid key return
     if (key != BACKSPACE && (key < '0' || key > '9') && key != ENTER)
-        return;
+        return 0;
 
     //If primary tessellation field is the active field
     if (fields[PRIMARY_TESS_FIELD_INDEX].active)
@@ -39,19 +47,20 @@ void UpdateTextEntry(char key)
             //Check that it is not out of bounds
             if(renderings[activeRendering].primaryTessellation < TESSELLATION_MIN)
                 renderings[activeRendering].primaryTessellation = TESSELLATION_MIN;
-            if(renderings[activeRendering].primaryTessellation > TESSELLATION_MAX)
-                renderings[activeRendering].primaryTessellation = TESSELLATION_MAX;
+            if(renderings[activeRendering].primaryTessellation > maxPrimaryTessellation(activeRendering))
+                renderings[activeRendering].primaryTessellation = maxPrimaryTessellation(activeRendering);
 
             //Deactivate the text field and set the flag to recalculate the tessellation
             fields[PRIMARY_TESS_FIELD_INDEX].active = false;
             tessChange = true;
+            return DIRTY_TEXT | DIRTY_TESSELLATION;
         }
         //Check for BACKSPACE key
         else if (key == BACKSPACE)
         {
             //Check that the text field is not empty
             if (fields[PRIMARY_TESS_FIELD_INDEX].buttonText.length() == 0)
-                return;
+                return 0;
 
             //Delete the last typed character
             fields[PRIMARY_TESS_FIELD_INDEX].buttonText.erase(fields[PRIMARY_TESS_FIELD_INDEX].buttonText.length() - 1);
@@ -81,13 +90,14 @@ void UpdateTextEntry(char key)
             //Deactivate the text field and set the flag to recalculate the tessellation
             fields[SECONDARY_TESS_FIELD_INDEX].active = false ;
             tessChange = true;
+            return DIRTY_TEXT | DIRTY_TESSELLATION;
         }
         //Check for BACKSPACE key
         else if (key == BACKSPACE)
         {
             //Check that the text field is not empty
             if (fields[SECONDARY_TESS_FIELD_INDEX].buttonText.length() == 0)
-                return;
+                return 0;
 
             //Delete the last typed character
             fields[SECONDARY_TESS_FIELD_INDEX].buttonText.erase(fields[SECONDARY_TESS_FIELD_INDEX].buttonText.length() - 1);
@@ -98,15 +108,139 @@ void UpdateTextEntry(char key)
              fields[SECONDARY_TESS_FIELD_INDEX].buttonText += key;
         }
     }
+
+    //Only the text in the field changed
+    return DIRTY_TEXT;
 }
 
 void input(unsigned char key, int x, int y)
 {
+    noteEvent(LATENCY_KEYBOARD);
+    recordEvent(REPLAY_KEYBOARD, key, x, y);
+
+    //What the key changed, and so which windows need redrawing
+    unsigned int changes = 0;
+
     switch (key)
     {
     case 'z':
     case 'Z':
         helpActive = !helpActive;
+        changes |= DIRTY_HELP;
+        break;
+
+    case 'a':
+    case 'A':
+        //Toggle between the fields' tessellation and the automatic level of detail
+        tessMode = (tessMode == TESS_MODE_AUTO_LOD) ? TESS_MODE_MANUAL : TESS_MODE_AUTO_LOD;
+        tessChange = true;
+        changes |= DIRTY_MODE | DIRTY_TESSELLATION;
+        break;
+
+    case 't':
+    case 'T':
+        //Toggle between the fields' tessellation and the chordal tolerance
+        tessMode = (tessMode == TESS_MODE_TOLERANCE) ? TESS_MODE_MANUAL : TESS_MODE_TOLERANCE;
+        tessChange = true;
+        changes |= DIRTY_MODE | DIRTY_TESSELLATION;
+        break;
+
+    case '<':
+    case ',':
+        //Tighten the tolerance
+        if (chordTolerance / 2 >= TOLERANCE_MIN)
+        {
+            chordTolerance /= 2;
+
+            //The tessellation sub window needs recalculating once the key settles
+            if (tessMode == TESS_MODE_TOLERANCE)
+            {
+                requestTessellation();
+                changes |= DIRTY_MODE;
+            }
+        }
+        break;
+
+    case '>':
+    case '.':
+        //Loosen the tolerance
+        if (chordTolerance * 2 <= TOLERANCE_MAX)
+        {
+            chordTolerance *= 2;
+
+            //The tessellation sub window needs recalculating once the key settles
+            if (tessMode == TESS_MODE_TOLERANCE)
+            {
+                requestTessellation();
+                changes |= DIRTY_MODE;
+            }
+        }
+        break;
+
+    case 'p':
+    case 'P':
+        //Toggle drawing a coarse proxy while the shape is being rotated
+        progressiveRefinement = !progressiveRefinement;
+        changes |= DIRTY_MODE;
+        break;
+
+    case 'c':
+    case 'C':
+        //Toggle culling clusters that face away before drawing
+        coneCulling = !coneCulling;
+        changes |= DIRTY_MODE | DIRTY_TESSELLATION;
+        break;
+
+    case 'h':
+    case 'H':
+        //Toggle picking under the cursor
+        picking = !picking;
+        if (!picking)
+            setPickCursor(-1, -1);
+        changes |= DIRTY_PICK;
+        break;
+
+    case 's':
+    case 'S':
+        //Toggle filled, lit drawing
+        solidShading = !solidShading;
+        changes |= DIRTY_TESSELLATION;
+        break;
+
+    case 'i':
+    case 'I':
+        //Toggle the instanced stress scene
+        sceneMode = !sceneMode;
+        changes |= DIRTY_MODE | DIRTY_TESSELLATION;
+        break;
+
+    case 'k':
+    case 'K':
+        //Toggle drawing from 16 bit quantized vertices
+        quantizedVertices = !quantizedVertices;
+        changes |= DIRTY_MODE | DIRTY_TESSELLATION;
+        break;
+
+    case 'l':
+    case 'L':
+        //Toggle the latency lines, printing the latencies so far
+        latencyHud = !latencyHud;
+        latencyReport(stdout);
+        changes |= DIRTY_LATENCY;
+        break;
+
+    case 'm':
+    case 'M':
+        //Toggle the memory line, printing the counts so far
+        memoryHud = !memoryHud;
+        memoryReport(stdout);
+        changes |= DIRTY_MODE;
+        break;
+
+    case 'x':
+    case 'X':
+        //Archive the shape's mesh
+        exportMesh();
         break;
 
     case ESCAPE:
@@ -119,12 +253,13 @@ void input(unsigned char key, int x, int y)
     case '+':
     case '=':
         //Check the bounds of the tessellation
-        if (renderings[activeRendering].primaryTessellation < TESSELLATION_MAX)
+        if (renderings[activeRendering].primaryTessellation < maxPrimaryTessellation(activeRendering))
         {
             renderings[activeRendering].primaryTessellation++;
 
-            //The tessellation sub window needs recalculating
-            tessChange = true;
+            //The tessellation sub window needs recalculating once the key settles
+            requestTessellation();
+            changes |= DIRTY_TEXT;
         }
         break;
 
@@ -135,8 +270,9 @@ void input(unsigned char key, int x, int y)
         {
             renderings[activeRendering].primaryTessellation--;
 
-            //The tessellation sub window needs recalculating
-            tessChange = true;
+            //The tessellation sub window needs recalculating once the key settles
+            requestTessellation();
+            changes |= DIRTY_TEXT;
         }
         break;
 
@@ -147,8 +283,9 @@ void input(unsigned char key, int x, int y)
         {
             renderings[activeRendering].secondaryTessellation--;
 
-            //The tessellation sub window needs recalculating
-            tessChange = true;
+            //The tessellation sub window needs recalculating once the key settles
+            requestTessellation();
+            changes |= DIRTY_TEXT;
         }
         break;
 
@@ -159,8 +296,9 @@ void input(unsigned char key, int x, int y)
         {
             renderings[activeRendering].secondaryTessellation++;
 
-            //The tessellation sub window needs recalculating
-            tessChange = true;
+            //The tessellation sub window needs recalculating once the key settles
+            requestTessellation();
+            changes |= DIRTY_TEXT;
         }
         break;
 
@@ -168,7 +306,7 @@ void input(unsigned char key, int x, int y)
         //If one of the text fields is active then pass on the key pressed
         //to the update text function
         if (fields[PRIMARY_TESS_FIELD_INDEX].active || fields[SECONDARY_TESS_FIELD_INDEX].active)
-            UpdateTextEntry(key);
+            changes |= UpdateTextEntry(key);
         //If the button was 1-4 and the text fields are inactive.
         //Changes the shape being tessellated
         else if (!fields[PRIMARY_TESS_FIELD_INDEX].active && !fields[SECONDARY_TESS_FIELD_INDEX].active &&
@@ -179,11 +317,13 @@ void input(unsigned char key, int x, int y)
 
             //The tessellation sub window needs recalculating
             tessChange = true;
+            changes |= DIRTY_SHAPE;
         }
     }
 
-    //Refresh all the sub-windows
-    refreshAll();
+    //Redraw only the windows showing what changed
+    markDirty(changes);
+    eventHandled();
 }
 
 ///////////////////////////////////////////////////////////
@@ -191,18 +331,21 @@ void input(unsigned char key, int x, int y)
 ///////////////////////////////////////////////////////////
 void specialInput(int key, int x, int y)
 {
-    //Check for arrow keys and adjust the rotations accordingly
+    noteEvent(LATENCY_SPECIAL);
+    recordEvent(REPLAY_SPECIAL, key, x, y);
+
+    //Check for arrow keys and queue the rotation for the next frame
     switch(key)
     {
-        case GLUT_KEY_DOWN: renderings[activeRendering].xRotation += ARROW_MOVE_FACTOR;  break;
-        case GLUT_KEY_UP: renderings[activeRendering].xRotation -= ARROW_MOVE_FACTOR;  break;
-        case GLUT_KEY_LEFT: renderings[activeRendering].yRotation -= ARROW_MOVE_FACTOR;  break;
-        case GLUT_KEY_RIGHT: renderings[activeRendering].yRotation += ARROW_MOVE_FACTOR;  break;
+        case GLUT_KEY_DOWN: queueRotation(ARROW_MOVE_FACTOR, 0);  break;
+        case GLUT_KEY_UP: queueRotation(-ARROW_MOVE_FACTOR, 0);  break;
+        case GLUT_KEY_LEFT: queueRotation(0, -ARROW_MOVE_FACTOR);  break;
+        case GLUT_KEY_RIGHT: queueRotation(0, ARROW_MOVE_FACTOR);  break;
     }
 
-    //Refresh only the tessellation subwindow
-    glutSetWindow(tessWindow);
-    glutPostRedisplay();
+    //Draw the coarse proxy while the arrow keys repeat
+    noteInteraction();
+    eventHandled();
 }
 
 
@@ -211,10 +354,18 @@ void specialInput(int key, int x, int y)
 ///////////////////////////////////////////////////////////
 void mouseInput(int button, int state, int x, int y)
 {
+    noteEvent(LATENCY_MOUSE);
+    recordEvent(REPLAY_MOUSE, button, state, x, y);
+
     //STATUS PANE CLICK------------------------------------
     if (glutGetWindow() == statusWindow && state == GLUT_DOWN  && !helpActive)
     {
+        //What the click changed, and so which windows need redrawing
+        unsigned int changes = 0;
+
         //Assume that the text fields are inactive
+        if (fields[PRIMARY_TESS_FIELD_INDEX].active || fields[SECONDARY_TESS_FIELD_INDEX].active)
+            changes |= DIRTY_TEXT;
         fields[PRIMARY_TESS_FIELD_INDEX].active = false;
         fields[SECONDARY_TESS_FIELD_INDEX].active = false;
 
@@ -227,6 +378,7 @@ void mouseInput(int button, int state, int x, int y)
                 //Set the new active rendering and set the flag for new tessellation calculation
                 activeRendering = 0;
                 tessChange = true;
+                changes |= DIRTY_SHAPE;
             }
             //Cylinder button was clicked
             else if (x >= ((windowSizex * QUARTER_WINDOW) + RENDERING_BUTTON_ADJUST_X) &&
@@ -236,6 +388,7 @@ void mouseInput(int button, int state, int x, int y)
                 //Set the new active rendering and set the flag for new tessellation calculation
                 activeRendering = 1 ;
                 tessChange = true;
+                changes |= DIRTY_SHAPE;
             }
 
             //Cone button was clicked
@@ -246,6 +399,7 @@ void mouseInput(int button, int state, int x, int y)
                 //Set the new active rendering and set the flag for new tessellation calculation
                 activeRendering = 2 ;
                 tessChange = true;
+                changes |= DIRTY_SHAPE;
             }
 
             //Sphere button was clicked
@@ -256,6 +410,7 @@ void mouseInput(int button, int state, int x, int y)
                 //Set the new active rendering and set the flag for new tessellation calculation
                 activeRendering = 3 ;
                 tessChange = true;
+                changes |= DIRTY_SHAPE;
             }
         }
         //Primary tessellation text field was clicked
@@ -267,6 +422,7 @@ void mouseInput(int button, int state, int x, int y)
             //Set the text field to active and set its text to empty
             fields[PRIMARY_TESS_FIELD_INDEX].active = true ;
             fields[PRIMARY_TESS_FIELD_INDEX].buttonText = "";
+            changes |= DIRTY_TEXT;
         }
         // Secondary tessellation text field was clicked
         else if(x >= fields[SECONDARY_TESS_FIELD_INDEX].x - HALF_WINDOW &&
@@ -277,6 +433,7 @@ void mouseInput(int button, int state, int x, int y)
             //Set the text field to active and set its text to empty
             fields[SECONDARY_TESS_FIELD_INDEX].active = true ;
             fields[SECONDARY_TESS_FIELD_INDEX].buttonText = "";
+            changes |= DIRTY_TEXT;
         }
         // Help window button
         else if(x >= windowSizex - HELP_BUTTON_LEFT_OFFSET &&
@@ -285,6 +442,7 @@ void mouseInput(int button, int state, int x, int y)
                 y >= ((windowSizey * QUARTER_WINDOW) - HELP_BUTTON_BOT_OFFSET))
         {
             helpActive = !helpActive;
+            changes |= DIRTY_HELP;
         }
         // Primary inc/dec tessellation buttons
         else if (y <= ((windowSizey * QUARTER_WINDOW) - (fields[PRIMARY_TESS_FIELD_INDEX].y - TESS_FIELD_EDGE_TOP_OFFSET)) &&
@@ -293,12 +451,13 @@ void mouseInput(int button, int state, int x, int y)
             if(x >= fields[PRIMARY_TESS_FIELD_INDEX].x + TESS_INC_LEFT_OFFSET &&
                x <= fields[PRIMARY_TESS_FIELD_INDEX].x + TESS_INC_RIGHT_OFFSET)
             {
-                if (renderings[activeRendering].primaryTessellation < TESSELLATION_MAX)
+                if (renderings[activeRendering].primaryTessellation < maxPrimaryTessellation(activeRendering))
                 {
                     renderings[activeRendering].primaryTessellation++;
 
-                    //The tessellation sub window needs recalculating
-                    tessChange = true;
+                    //The tessellation sub window needs recalculating once the clicks settle
+                    requestTessellation();
+                    changes |= DIRTY_TEXT;
                 }
             }
 
@@ -309,8 +468,9 @@ void mouseInput(int button, int state, int x, int y)
                 {
                     renderings[activeRendering].primaryTessellation--;
 
-                    //The tessellation sub window needs recalculating
-                    tessChange = true;
+                    //The tessellation sub window needs recalculating once the clicks settle
+                    requestTessellation();
+                    changes |= DIRTY_TEXT;
                 }
             }
         }
@@ -325,8 +485,9 @@ void mouseInput(int button, int state, int x, int y)
                 {
                     renderings[activeRendering].secondaryTessellation++;
 
-                    //The tessellation sub window needs recalculating
-                    tessChange = true;
+                    //The tessellation sub window needs recalculating once the clicks settle
+                    requestTessellation();
+                    changes |= DIRTY_TEXT;
                 }
             }
 
@@ -337,26 +498,51 @@ void mouseInput(int button, int state, int x, int y)
                 {
                     renderings[activeRendering].secondaryTessellation--;
 
-                    //The tessellation sub window needs recalculating
-                    tessChange = true;
+                    //The tessellation sub window needs recalculating once the clicks settle
+                    requestTessellation();
+                    changes |= DIRTY_TEXT;
                 }
             }
         }
 
-        //Redraw all the
-        refreshAll();
+        //Redraw only the windows showing what changed
+        markDirty(changes);
     }
 
     //TESSELLATION PANE CLICK------------------------------
     else if(glutGetWindow() == tessWindow)
     {
+        //Where the button went down, to tell a click from a drag
+        static int downx = 0, downy = 0;
+
         //Set the state of the mouse button (whether down or up)
         mouseDown = (state == GLUT_DOWN) ? true : false;
 
+        //Nothing is picked during a drag; a click picks and prints
+        if (picking)
+        {
+            if (mouseDown)
+                setPickCursor(-1, -1);
+            else
+                setPickCursor(x, y, x == downx && y == downy);
+            markDirty(DIRTY_PICK);
+        }
+        if (mouseDown)
+        {
+            downx = x;
+            downy = y;
+        }
+
         //Set the position at which the mouse was clicked
         lastx = x;
         lasty = y;
+
+        //Draw the coarse proxy while the button is held
+        if (mouseDown)
+            noteInteraction();
     }
+
+    eventHandled();
 }
 
 ///////////////////////////////////////////////////////////
@@ -364,6 +550,9 @@ void mouseInput(int button, int state, int x, int y)
 ///////////////////////////////////////////////////////////
 void mouseMovement(int x, int y)
 {
+    noteEvent(LATENCY_MOTION);
+    recordEvent(REPLAY_MOTION, x, y);
+
     //If the last mouse click was a down action (i.e mouse is being held down)
     if(mouseDown)
     {
@@ -371,66 +560,137 @@ void mouseMovement(int x, int y)
         double dx = double(x - lastx) / windowSizex;
         double dy = double(y - lasty) / windowSizey;
 
-        //Adjust the rotations of the active rendering
-        renderings[activeRendering].xRotation += (HALF_CIRCLE * dy);
-        renderings[activeRendering].yRotation += (HALF_CIRCLE * dx);
+        //Queue the rotation; every sample before the next frame is drawn by it
+        queueRotation(HALF_CIRCLE * dy, HALF_CIRCLE * dx);
 
         //Set the last x and y to the current x and y
         lastx = x;
         lasty = y;
 
-        //Redraw only the tessellation window as not to flicker the status window
-        glutSetWindow(tessWindow);
-        glutPostRedisplay();
+        //Keep drawing the coarse proxy until the drag goes idle
+        noteInteraction();
     }
+
+    eventHandled();
 }
 
 ///////////////////////////////////////////////////////////
-//Displays the help dialog
+//Call back function for mouse movement with no button held
 ///////////////////////////////////////////////////////////
-void ShowHelp()
+void mouseHover(int x, int y)
 {
-    const short num_lines = 10;
-
-    std::string helpStringWor[num_lines];
-    std::string helpStringDef[num_lines];
-    helpStringWor[0] = "HELP: (shortcut keys)                                        Framwork created by Greg Fotiades & Alex Koutmos";
-
-    helpStringWor[1] = "Q / q / Esc";
-    helpStringDef[1] = "- Closes Program";
-
-    helpStringWor[2] = "+ / -";
-    helpStringDef[2] = "- Increases/Decreases Primary Tessellation";
-
-    helpStringWor[3] = "[ / ]";
-    helpStringDef[3] = "- Increases/Decreases Secondary Tessellation (Cyl/Cone only)";
+    noteEvent(LATENCY_MOTION);
+    recordEvent(REPLAY_HOVER, x, y);
 
-    helpStringWor[4] = "1-4";
-    helpStringDef[4] = "- Change Rendering (Cube, Cylinder, etc.)";
-
-    helpStringWor[5] = "Z / z";
-    helpStringDef[5] = "- Toggle The Help Menu";
+    //Pick under the cursor as it moves over the shape
+    if (picking)
+    {
+        setPickCursor(x, y);
+        markDirty(DIRTY_PICK);
+    }
 
-    helpStringWor[6] = "Text Box Interaction";
-    helpStringDef[6] = "- Click on box, type number, press enter.";
+    eventHandled();
+}
 
-    helpStringWor[7] = "Arrows or Mouse drag";
-    helpStringDef[7] = "- Rotates currently selected rendering";
+///////////////////////////////////////////////////////////
+//Displays the help dialog
+///////////////////////////////////////////////////////////
+void ShowHelp()
+{
+    const short num_lines = 10;
 
-    helpStringWor[8] = "";
-    helpStringWor[9] = "Press \'z\' to exit this menu....";
+    static const char* const helpStringWor[num_lines] =
+    {
+        "HELP: (shortcut keys)                                        Framwork created by Greg Fotiades & Alex Koutmos",
+        "Q / q / Esc",
+        "+ / -",
+        "[ / ]",
+        "1-4",
+        "Z / z",
+        "Text Box Interaction",
+        "Arrows or Mouse drag",
+        "S / s",
+        "Press \'z\' to exit this menu...."
+    };
+    static const char* const helpStringDef[num_lines] =
+    {
+        "",
+        "- Closes Program",
+        "- Increases/Decreases Primary Tessellation",
+        "- Increases/Decreases Secondary Tessellation (Cyl/Cone only)",
+        "- Change Rendering (Cube, Cylinder, etc.)",
+        "- Toggle The Help Menu",
+        "- Click on box, type number, press enter.",
+        "- Rotates currently selected rendering",
+        "- Solid shading, lit with the surface normals",
+        ""
+    };
+
+    //Keys toggling the tessellation and drawing modes, in a column on the right
+    const short num_mode_lines = 11;
+
+    static const char* const modeStringWor[num_mode_lines] =
+    {
+        "A / a",
+        "P / p",
+        "T / t",
+        "< / >",
+        "C / c",
+        "H / h",
+        "I / i",
+        "K / k",
+        "L / l",
+        "M / m",
+        "X / x"
+    };
+    static const char* const modeStringDef[num_mode_lines] =
+    {
+        "- Automatic level of detail",
+        "- Progressive refinement",
+        "- Chordal tolerance mode",
+        "- Halves/Doubles the tolerance",
+        "- Cluster cone culling",
+        "- Pick under the cursor",
+        "- Instanced stress scene",
+        "- Quantized 16 bit vertices",
+        "- Show input latency",
+        "- Show memory use",
+        "- Export compressed mesh"
+    };
+
+    //The help only moves when the window is resized, so it is compiled
+    //into a display list for the size it was last drawn at
+    static GLuint helpList = 0;
+    static int listSizex = 0, listSizey = 0;
+    if (helpList != 0 && listSizex == windowSizex && listSizey == windowSizey)
+    {
+        glCallList(helpList);
+        return;
+    }
+    if (helpList == 0)
+        helpList = glGenLists(1);
+    listSizex = windowSizex;
+    listSizey = windowSizey;
+    glNewList(helpList, GL_COMPILE_AND_EXECUTE);
 
     glColor3f(BLACK_D);
     for (int i = 0, offset = 15 ; i < num_lines ; ++i, offset += 15)
     {
         glRasterPos2i(HELP_TEXT_WORD_OFFSET, (int)(windowSizey * QUARTER_WINDOW) - offset);
-
-        for (unsigned int k = 0 ; k < helpStringWor[i].length() ; ++k)
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, helpStringWor[i].at(k));
+        drawGlyphs(GLYPHS_SMALL, helpStringWor[i]);
 
         glRasterPos2i(HELP_TEXT_DEF_OFFSET, (int)(windowSizey * QUARTER_WINDOW) - offset);
+        drawGlyphs(GLYPHS_SMALL, helpStringDef[i]);
+    }
 
-        for (unsigned int k = 0 ; k < helpStringDef[i].length() ; ++k)
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, helpStringDef[i].at(k));
+    for (int i = 0, offset = 15 ; i < num_mode_lines ; ++i, offset += 15)
+    {
+        glRasterPos2i(windowSizex - HELP_MODE_COLUMN_OFFSET, (int)(windowSizey * QUARTER_WINDOW) - offset);
+        drawGlyphs(GLYPHS_SMALL, modeStringWor[i]);
+
+        glRasterPos2i(windowSizex - HELP_MODE_COLUMN_OFFSET + HELP_MODE_DEF_OFFSET, (int)(windowSizey * QUARTER_WINDOW) - offset);
+        drawGlyphs(GLYPHS_SMALL, modeStringDef[i]);
     }
+
+    glEndList();
 }
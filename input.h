@@ -15,13 +15,15 @@
 
 void mouseMovement(int x, int y);
 
+void mouseHover(int x, int y);
+
 void mouseInput(int button, int state, int x, int y);
 
 void specialInput(int key, int x, int y);
 
 void input(unsigned char key, int x, int y);
 
-void UpdateTextEntry(char key);
+unsigned int UpdateTextEntry(char key);
 
 void ShowHelp();
 
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////
+//
+// File:  latency.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for measuring the
+//               time from an input event to the buffer swap that shows it.
+//
+////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include "latency.h"
+
+// An event waiting on the windows it redraws
+struct pendingEvent
+{
+    int type;
+    long long start;
+    unsigned int windows;
+};
+
+// Latency histogram of one event type
+struct latencyHistogram
+{
+    unsigned long buckets[LATENCY_BUCKETS];
+    unsigned long count;
+    long long max;
+};
+
+static const char* eventNames[LATENCY_EVENT_TYPES] = { "keyboard", "special", "mouse", "motion" };
+
+static latencyHistogram histograms[LATENCY_EVENT_TYPES];
+static pendingEvent pending[LATENCY_PENDING_MAX];
+static int pendingCount = 0;
+
+// Event the current callback is handling, or -1 outside of one
+static int currentType = -1;
+static long long currentStart;
+
+///////////////////////////////////////////////////////////
+//Monotonic time in microseconds
+///////////////////////////////////////////////////////////
+static long long now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+///////////////////////////////////////////////////////////
+//Stamp the event being handled
+///////////////////////////////////////////////////////////
+void noteEvent(int type)
+{
+    currentType = type;
+    currentStart = now();
+}
+
+void eventHandled()
+{
+    currentType = -1;
+}
+
+///////////////////////////////////////////////////////////
+//Carry the current event's stamp to the windows it redraws
+///////////////////////////////////////////////////////////
+void awaitDisplay(unsigned int windows)
+{
+    //Redraws asked for by timers belong to no event
+    if (currentType < 0 || windows == 0)
+        return;
+
+    //An event asking for several redraws waits on all of them
+    if (pendingCount > 0 && pending[pendingCount - 1].start == currentStart &&
+        pending[pendingCount - 1].type == currentType)
+    {
+        pending[pendingCount - 1].windows |= windows;
+        return;
+    }
+
+    //Events that do not fit before the next swap go unmeasured
+    if (pendingCount == LATENCY_PENDING_MAX)
+        return;
+
+    pending[pendingCount].type = currentType;
+    pending[pendingCount].start = currentStart;
+    pending[pendingCount].windows = windows;
+    ++pendingCount;
+}
+
+///////////////////////////////////////////////////////////
+//Hold the current event until a later redraw
+///////////////////////////////////////////////////////////
+long long deferDisplay()
+{
+    if (currentType < 0)
+        return -1;
+    awaitDisplay(LATENCY_DEFERRED);
+    return currentStart;
+}
+
+void awaitDeferred(long long start, unsigned int windows)
+{
+    for (int i = 0 ; i < pendingCount ; ++i)
+        if (pending[i].start == start && (pending[i].windows & LATENCY_DEFERRED))
+            pending[i].windows = (pending[i].windows & ~LATENCY_DEFERRED) | windows;
+}
+
+///////////////////////////////////////////////////////////
+//Record the events a window's swap completes
+///////////////////////////////////////////////////////////
+int noteSwap(unsigned int window)
+{
+    long long swapped = now();
+    int completed = 0;
+    int kept = 0;
+
+    for (int i = 0 ; i < pendingCount ; ++i)
+    {
+        pending[i].windows &= ~window;
+        if (pending[i].windows != 0)
+        {
+            pending[kept++] = pending[i];
+            continue;
+        }
+
+        latencyHistogram& histogram = histograms[pending[i].type];
+        long long latency = swapped - pending[i].start;
+        long long bucket = latency / LATENCY_BUCKET_US;
+        histogram.buckets[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1]++;
+        histogram.count++;
+        if (latency > histogram.max)
+            histogram.max = latency;
+        ++completed;
+    }
+    pendingCount = kept;
+
+    return completed;
+}
+
+///////////////////////////////////////////////////////////
+//Latency below which the given fraction of events fall, in microseconds
+///////////////////////////////////////////////////////////
+static long long percentile(const latencyHistogram& histogram, double fraction)
+{
+    //Rank of the event sought, counting from 1
+    unsigned long rank = (unsigned long)(fraction * histogram.count);
+    if (rank < fraction * histogram.count || rank == 0)
+        ++rank;
+
+    unsigned long seen = 0;
+    for (int bucket = 0 ; bucket < LATENCY_BUCKETS ; ++bucket)
+    {
+        seen += histogram.buckets[bucket];
+        if (seen >= rank)
+        {
+            //The top of the bucket, but never more than was measured
+            long long top = (long long)(bucket + 1) * LATENCY_BUCKET_US;
+            return top < histogram.max ? top : histogram.max;
+        }
+    }
+    return histogram.max;
+}
+
+///////////////////////////////////////////////////////////
+//Summarize an event type
+///////////////////////////////////////////////////////////
+latencyStats getLatencyStats(int type)
+{
+    const latencyHistogram& histogram = histograms[type];
+    latencyStats stats = { histogram.count, 0.0, 0.0, 0.0 };
+    if (histogram.count > 0)
+    {
+        stats.p50 = percentile(histogram, 0.50) / 1000.0;
+        stats.p99 = percentile(histogram, 0.99) / 1000.0;
+        stats.max = histogram.max / 1000.0;
+    }
+    return stats;
+}
+
+///////////////////////////////////////////////////////////
+//Print the summary of every event type
+///////////////////////////////////////////////////////////
+void latencyReport(FILE* out)
+{
+    fprintf(out, "Input to display latency (ms, %g ms buckets)\n", LATENCY_BUCKET_US / 1000.0);
+    fprintf(out, "%-10s %8s %8s %8s %8s\n", "event", "count", "p50", "p99", "max");
+    for (int type = 0 ; type < LATENCY_EVENT_TYPES ; ++type)
+    {
+        latencyStats stats = getLatencyStats(type);
+        fprintf(out, "%-10s %8lu %8.2f %8.2f %8.2f\n", eventNames[type], stats.count, stats.p50, stats.p99, stats.max);
+    }
+}
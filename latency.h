@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////
+//
+// File:  latency.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for measuring the time
+//               from an input event to the buffer swap that shows it.
+//
+//               Each input callback stamps its event with the monotonic
+//               clock.  Redraws the event asks for carry the stamp to the
+//               windows they post, and the event's latency is recorded in
+//               its type's histogram once every one of those windows has
+//               swapped.  A redraw put off to a timer, such as a debounced
+//               rebuild, holds its event until the timer asks for it.
+//               Events that draw nothing are not recorded.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#include <cstdio>
+
+// Event types, one histogram each
+#define LATENCY_KEYBOARD 0
+#define LATENCY_SPECIAL 1
+#define LATENCY_MOUSE 2
+#define LATENCY_MOTION 3
+#define LATENCY_EVENT_TYPES 4
+
+// Windows an event can be waiting on, and a redraw put off until later
+#define LATENCY_TESS_WINDOW 1
+#define LATENCY_STATUS_WINDOW 2
+#define LATENCY_DEFERRED 4
+
+// Histogram buckets are LATENCY_BUCKET_US wide; the last one collects
+// everything slower
+#define LATENCY_BUCKET_US 100
+#define LATENCY_BUCKETS 4096
+
+// Events that can be waiting for their swap at once
+#define LATENCY_PENDING_MAX 256
+
+// Summary of one event type, in milliseconds
+struct latencyStats
+{
+    unsigned long count;
+    double p50;
+    double p99;
+    double max;
+};
+
+// Stamp the event an input callback is handling; every callback starts
+// with this and ends with eventHandled()
+void noteEvent(int type);
+void eventHandled();
+
+// The event being handled will be shown by the next swap of these windows
+void awaitDisplay(unsigned int windows);
+
+// The event being handled will be shown by a redraw a timer asks for
+// later; returns its stamp to pass to awaitDeferred, or -1 outside of an
+// event
+long long deferDisplay();
+
+// The redraw deferred by the event of the given stamp has been asked for,
+// and will be shown by the next swap of these windows
+void awaitDeferred(long long start, unsigned int windows);
+
+// A window has swapped its buffers; returns the number of events whose
+// latency this completed
+int noteSwap(unsigned int window);
+
+// Summary of an event type's latencies so far
+latencyStats getLatencyStats(int type);
+
+// Print every event type's summary
+void latencyReport(FILE* out);
+
+#endif
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////
+//
+// File:  lod.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the automatic
+//               level of detail mode.  Each shape gets a chain of meshes
+//               generated once, and every frame the finest one whose
+//               edges still span LOD_PIXELS_PER_EDGE pixels is drawn, so
+//               resizing the window never builds any new geometry.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include "resources.h"
+#include "lod.h"
+#include "mesh.h"
+
+// Primary tessellations the cube, cylinder and cone chains are built from
+static const int lodLadder[] = { 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128 };
+
+// Edge length of the icosahedron the sphere starts from (radius 0.5)
+#define ICOSAHEDRON_EDGE 0.5257
+
+// Circumference of the cylinder and cone rings (radius 0.5)
+#define RING_CIRCUMFERENCE M_PI
+
+// The chains, indexed by rendering
+static std::vector<lodLevel> lodChains[4];
+
+///////////////////////////////////////////////////////////
+//Length of the sides the secondary tessellation divides
+///////////////////////////////////////////////////////////
+static double sideLength(short rendering)
+{
+    //Cylinder sides are straight up, cone sides run to the apex
+    return (rendering == RENDERING_CONE) ? sqrt(1.25) : 1.0;
+}
+
+///////////////////////////////////////////////////////////
+//Longest edge (in shape units) of a chain level
+///////////////////////////////////////////////////////////
+static double edgeLength(short rendering, const lodLevel& level)
+{
+    switch (rendering)
+    {
+    case RENDERING_CYL:
+    case RENDERING_CONE:
+        return std::max(RING_CIRCUMFERENCE / level.primaryTessellation,
+                        sideLength(rendering) / level.secondaryTessellation);
+    case RENDERING_SPH:
+        return ICOSAHEDRON_EDGE / (1 << (level.primaryTessellation - 1));
+    default:
+        return 1.0 / level.primaryTessellation;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Generate the level of detail chain for a rendering
+///////////////////////////////////////////////////////////
+void buildLodChain(short rendering)
+{
+    std::vector<lodLevel>& chain = lodChains[rendering];
+
+    //Chains are only ever built once
+    if (!chain.empty())
+        return;
+
+    if (rendering == RENDERING_SPH)
+    {
+        //Every subdivision depth up to the cap
+        chain.resize(LOD_SPHERE_MAX_DEPTH);
+        for (int depth = 1 ; depth <= LOD_SPHERE_MAX_DEPTH ; ++depth)
+        {
+            chain[depth - 1].primaryTessellation = depth;
+            chain[depth - 1].secondaryTessellation = 1;
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0 ; i < sizeof(lodLadder) / sizeof(lodLadder[0]) ; ++i)
+        {
+            lodLevel level;
+            level.primaryTessellation = lodLadder[i];
+            level.secondaryTessellation = 1;
+
+            if (rendering == RENDERING_CYL || rendering == RENDERING_CONE)
+            {
+                //Rings need at least 3 sectors
+                if (level.primaryTessellation < 3)
+                    continue;
+
+                //Keep the side edges about as long as the ring edges
+                level.secondaryTessellation = std::max(1, int(level.primaryTessellation * sideLength(rendering) / RING_CIRCUMFERENCE + 0.5));
+            }
+
+            chain.push_back(level);
+        }
+    }
+
+    //Generate the meshes of every level up front
+    for (unsigned int i = 0 ; i < chain.size() ; ++i)
+        generateMesh(rendering, chain[i].primaryTessellation, chain[i].secondaryTessellation, chain[i].mesh);
+}
+
+///////////////////////////////////////////////////////////
+//Choose the chain level that suits the on-screen size
+///////////////////////////////////////////////////////////
+const lodLevel& selectLod(short rendering, int viewportHeight)
+{
+    buildLodChain(rendering);
+    const std::vector<lodLevel>& chain = lodChains[rendering];
+
+    //Pixels covered by one unit at the distance of the shape's center
+    double pixelsPerUnit = viewportHeight /
+        (2.0 * CAMERA_DISTANCE * tan(QUARTER_CIRCLE * DEGREE_RADIAN_FACTOR / 2));
+
+    //Take the finest level whose edges still cover enough pixels
+    unsigned int selected = 0;
+    for (unsigned int i = 1 ; i < chain.size() ; ++i)
+    {
+        if (edgeLength(rendering, chain[i]) * pixelsPerUnit < LOD_PIXELS_PER_EDGE)
+            break;
+        selected = i;
+    }
+
+    return chain[selected];
+}
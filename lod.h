@@ -0,0 +1,35 @@
+////////////////////////////////////////////////////////////
+//
+// File:  lod.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the automatic level
+//               of detail mode, which picks the tessellation of a shape
+//               from how large it is on screen instead of from the fields.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __LOD_H__
+#define __LOD_H__
+
+#include <vector>
+#include "mesh.h"
+
+// One precomputed entry of a shape's level of detail chain
+struct lodLevel
+{
+    int primaryTessellation;
+    int secondaryTessellation;
+    Mesh mesh;
+};
+
+// Generate every level in the chain of the given rendering (if not done yet)
+void buildLodChain(short rendering);
+
+// Pick the finest chain level whose edges are still at least
+// LOD_PIXELS_PER_EDGE long in a viewport of the given height
+const lodLevel& selectLod(short rendering, int viewportHeight);
+
+#endif
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////
+//
+// File:  memtrack.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the allocation
+//               accounting.
+//
+////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include "resources.h"
+#include "memtrack.h"
+#include "mesh.h"
+#include "quantize.h"
+
+// Counts of one category; generators may allocate from several threads
+struct memoryCounters
+{
+    std::atomic<unsigned long long> allocations;
+    std::atomic<unsigned long long> current;
+    std::atomic<unsigned long long> peak;
+};
+
+// Each category's counts, then all of them together
+static memoryCounters counters[MEMORY_CATEGORIES + 1];
+
+static const char* categoryNames[MEMORY_CATEGORIES + 1] = { "tessellation", "draw", "ui", "all" };
+
+///////////////////////////////////////////////////////////
+//Count an allocation
+///////////////////////////////////////////////////////////
+static void countAllocation(memoryCounters& counter, std::size_t bytes)
+{
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    unsigned long long current = counter.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    //Raise the peak unless another thread already has
+    unsigned long long peak = counter.peak.load(std::memory_order_relaxed);
+    while (current > peak && !counter.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+        ;
+}
+
+void noteAllocation(int category, std::size_t bytes)
+{
+    countAllocation(counters[category], bytes);
+    countAllocation(counters[MEMORY_ALL], bytes);
+}
+
+void noteFree(int category, std::size_t bytes)
+{
+    counters[category].current.fetch_sub(bytes, std::memory_order_relaxed);
+    counters[MEMORY_ALL].current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////
+//Read a category's counts
+///////////////////////////////////////////////////////////
+memoryStats getMemoryStats(int category)
+{
+    memoryStats stats;
+    stats.allocations = counters[category].allocations.load(std::memory_order_relaxed);
+    stats.current = counters[category].current.load(std::memory_order_relaxed);
+    stats.peak = counters[category].peak.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void resetMemoryPeaks()
+{
+    for (int category = 0 ; category <= MEMORY_ALL ; ++category)
+        counters[category].peak.store(counters[category].current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+const char* memoryCategoryName(int category)
+{
+    return categoryNames[category];
+}
+
+///////////////////////////////////////////////////////////
+//Print every category's counts
+///////////////////////////////////////////////////////////
+void memoryReport(FILE* out)
+{
+    fprintf(out, "%-13s %12s %14s %14s\n", "Category", "Allocations", "Current KB", "Peak KB");
+    for (int category = 0 ; category <= MEMORY_ALL ; ++category)
+    {
+        memoryStats stats = getMemoryStats(category);
+        fprintf(out, "%-13s %12llu %14.1f %14.1f\n", categoryNames[category], stats.allocations,
+                stats.current / 1024.0, stats.peak / 1024.0);
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Peak memory of generating and drawing each shape at several levels
+///////////////////////////////////////////////////////////
+struct memoryLevel
+{
+    short rendering;
+    const char* name;
+    int primary;
+    int secondary;
+};
+
+static const memoryLevel memoryLevels[] =
+{
+    { RENDERING_CUBE, "Cube", 8, 1 },
+    { RENDERING_CUBE, "Cube", 64, 1 },
+    { RENDERING_CUBE, "Cube", 150, 1 },
+    { RENDERING_CYL, "Cylinder", 32, 8 },
+    { RENDERING_CYL, "Cylinder", 150, 64 },
+    { RENDERING_CYL, "Cylinder", 150, 150 },
+    { RENDERING_CONE, "Cone", 32, 8 },
+    { RENDERING_CONE, "Cone", 150, 64 },
+    { RENDERING_CONE, "Cone", 150, 150 },
+    { RENDERING_SPH, "Sphere", 4, 1 },
+    { RENDERING_SPH, "Sphere", 6, 1 },
+    { RENDERING_SPH, "Sphere", 8, 1 },
+};
+
+int memoryLevelReport(unsigned long long budgetBytes)
+{
+    int overBudget = 0;
+
+    printf("%-9s %11s %9s %10s %10s %16s %12s %12s\n",
+           "Shape", "Level", "Triangles", "Mesh KB", "16 bit KB", "Tessellation KB", "Draw KB", "Total KB");
+    for (unsigned int i = 0 ; i < sizeof(memoryLevels) / sizeof(memoryLevels[0]) ; ++i)
+    {
+        const memoryLevel& level = memoryLevels[i];
+        unsigned long long before[MEMORY_CATEGORIES + 1];
+        for (int category = 0 ; category <= MEMORY_ALL ; ++category)
+            before[category] = getMemoryStats(category).current;
+        resetMemoryPeaks();
+
+        //What the tessellation window holds to draw the level, from doubles
+        //and then from 16 bit vertices in their place
+        unsigned int triangles;
+        double meshBytes, quantizedBytes;
+        {
+            Mesh mesh;
+            generateMesh(level.rendering, level.primary, level.secondary, mesh);
+            triangles = mesh.triangleCount();
+            meshBytes = mesh.positions.size() * sizeof(Point3) + mesh.normals.size() * sizeof(Vector3) +
+                        mesh.indices.size() * sizeof(unsigned int);
+            QuantizedMesh quantized;
+            replaceWithQuantized(mesh, quantized);
+            quantizedBytes = getMemoryStats(MEMORY_TESSELLATION).current + getMemoryStats(MEMORY_DRAW).current -
+                             before[MEMORY_TESSELLATION] - before[MEMORY_DRAW];
+        }
+
+        //Peaks above what was held before the level was generated; the
+        //categories peak at different times, so the budget is checked
+        //against the most held at once
+        unsigned long long tessellation = getMemoryStats(MEMORY_TESSELLATION).peak - before[MEMORY_TESSELLATION];
+        unsigned long long draw = getMemoryStats(MEMORY_DRAW).peak - before[MEMORY_DRAW];
+        unsigned long long total = getMemoryStats(MEMORY_ALL).peak - before[MEMORY_ALL];
+        bool over = budgetBytes > 0 && total > budgetBytes;
+        overBudget += over;
+
+        char levelText[32];
+        sprintf(levelText, "%d x %d", level.primary, level.secondary);
+        printf("%-9s %11s %9u %10.1f %10.1f %16.1f %12.1f %12.1f%s\n", level.name, levelText, triangles,
+               meshBytes / 1024, quantizedBytes / 1024, tessellation / 1024.0, draw / 1024.0, total / 1024.0,
+               over ? "  OVER BUDGET" : "");
+    }
+
+    return overBudget;
+}
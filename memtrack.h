@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////
+//
+// File:  memtrack.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the allocation accounting.  Containers
+//               built on trackedAllocator count their allocations and
+//               bytes against a category, keeping the bytes currently held
+//               and the most ever held at once, so that the status window
+//               and --mem-report can show where memory goes.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __MEMTRACK_H__
+#define __MEMTRACK_H__
+
+#include <cstddef>
+#include <cstdio>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Categories memory is counted against
+#define MEMORY_TESSELLATION 0   // Generated meshes, proxies and LOD chains
+#define MEMORY_DRAW 1           // Copies made for drawing (quantized meshes)
+#define MEMORY_UI 2             // Status window text
+#define MEMORY_CATEGORIES 3
+
+// Every category together, counted as one so that its peak is the most
+// ever held at once rather than the sum of each category's own peak
+#define MEMORY_ALL MEMORY_CATEGORIES
+
+// Counts of one category
+struct memoryStats
+{
+    unsigned long long allocations;
+    unsigned long long current;
+    unsigned long long peak;
+};
+
+// Count an allocation or free of the given size
+void noteAllocation(int category, std::size_t bytes);
+void noteFree(int category, std::size_t bytes);
+
+// Counts of a category, or of MEMORY_ALL, so far
+memoryStats getMemoryStats(int category);
+
+// Start every category's peak, and the combined one, again from what it
+// holds now
+void resetMemoryPeaks();
+
+// Name of a category, or of MEMORY_ALL
+const char* memoryCategoryName(int category);
+
+// Memory a tracked container can take instead of the heap's, such as a
+// shared memory segment.  allocate returns NULL for what it cannot take,
+// and release returns false for memory it did not hand out.
+struct trackedArena
+{
+    virtual void* allocate(std::size_t bytes) = 0;
+    virtual bool release(void* memory, std::size_t bytes) = 0;
+};
+
+// Allocator counting what it hands out against Category.  It takes from
+// the heap unless given an arena, which moves and swaps with the
+// container's contents; a copy of the container goes to the heap.
+template <class T, int Category>
+struct trackedAllocator
+{
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    template <class U> struct rebind { typedef trackedAllocator<U, Category> other; };
+
+    trackedArena* arena;
+
+    trackedAllocator() : arena(NULL) {}
+    explicit trackedAllocator(trackedArena* arena_) : arena(arena_) {}
+    template <class U> trackedAllocator(const trackedAllocator<U, Category>& other) : arena(other.arena) {}
+
+    trackedAllocator select_on_container_copy_construction() const { return trackedAllocator(); }
+
+    T* allocate(std::size_t n)
+    {
+        void* memory = arena != NULL ? arena->allocate(n * sizeof(T)) : NULL;
+        if (memory == NULL)
+            memory = ::operator new(n * sizeof(T));
+        noteAllocation(Category, n * sizeof(T));
+        return static_cast<T*>(memory);
+    }
+
+    void deallocate(T* memory, std::size_t n)
+    {
+        noteFree(Category, n * sizeof(T));
+        if (arena == NULL || !arena->release(memory, n * sizeof(T)))
+            ::operator delete(memory);
+    }
+};
+
+template <class T, class U, int Category>
+bool operator==(const trackedAllocator<T, Category>& a, const trackedAllocator<U, Category>& b) { return a.arena == b.arena; }
+template <class T, class U, int Category>
+bool operator!=(const trackedAllocator<T, Category>& a, const trackedAllocator<U, Category>& b) { return a.arena != b.arena; }
+
+// Containers counted against a category
+template <class T, int Category>
+using trackedVector = std::vector<T, trackedAllocator<T, Category> >;
+typedef std::basic_string<char, std::char_traits<char>, trackedAllocator<char, MEMORY_UI> > uiString;
+
+// Print every category's counts
+void memoryReport(FILE* out);
+
+// Generate every shape at several levels, printing the peak memory of each
+// category and of all of them together per level; returns the number of
+// levels whose combined peak is over budgetBytes (0 for no budget)
+int memoryLevelReport(unsigned long long budgetBytes);
+
+#endif
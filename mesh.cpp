@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////
+//
+// File:  mesh.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for generating a shape
+//               into an arbitrary mesh and drawing one.
+//
+////////////////////////////////////////////////////////////
+
+#include "resources.h"
+#include "mesh.h"
+#include "trace.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+// Following rendering functions will be defined
+// in the renderings.o object at link time
+extern void Cone(int n, int m);
+extern void Cube(int n);
+extern void Cylinder(int n, int m);
+extern void Sphere(int n);
+extern double ConeTolerance(double tolerance, int& n, int& m);
+extern double CubeTolerance(int& n);
+extern double CylinderTolerance(double tolerance, int& n, int& m);
+extern double SphereTolerance(double tolerance, int& n);
+
+// By default the generators fill the tessellation window's mesh; each
+// thread has its own sink, so meshes can be generated on several at once
+thread_local Mesh* meshSink = &activeMesh;
+
+///////////////////////////////////////////////////////////
+//Generate a rendering into the given mesh
+///////////////////////////////////////////////////////////
+void generateMesh(short rendering, int primary, int secondary, Mesh& out)
+{
+    //Point the generators at the output mesh for the duration of the call
+    Mesh* previous = meshSink;
+    meshSink = &out;
+    {
+        TRACE_SPAN("mesh clear");
+        out.clear();
+    }
+
+    //Depending on the rendering call the appropriate generator
+    switch (rendering)
+    {
+    case RENDERING_CUBE:
+        { TRACE_SPAN("Cube");  Cube(primary); }  break;
+    case RENDERING_CYL:
+        { TRACE_SPAN("Cylinder");  Cylinder(primary, secondary); }  break;
+    case RENDERING_CONE:
+        { TRACE_SPAN("Cone");  Cone(primary, secondary); }  break;
+    case RENDERING_SPH:
+        { TRACE_SPAN("Sphere");  Sphere(primary); }  break;
+    }
+
+    meshSink = previous;
+}
+
+int maxPrimaryTessellation(short rendering)
+{
+    return rendering == RENDERING_SPH ? SPHERE_MAX_DEPTH : TESSELLATION_MAX;
+}
+
+///////////////////////////////////////////////////////////
+//Derive a rendering's tessellation from a chordal tolerance
+///////////////////////////////////////////////////////////
+double toleranceTessellation(short rendering, double tolerance, int& primary, int& secondary)
+{
+    //Only the cylinder and cone use the secondary tessellation
+    secondary = 1;
+
+    switch (rendering)
+    {
+    case RENDERING_CYL:
+        return CylinderTolerance(tolerance, primary, secondary);
+    case RENDERING_CONE:
+        return ConeTolerance(tolerance, primary, secondary);
+    case RENDERING_SPH:
+        return SphereTolerance(tolerance, primary);
+    default:
+        return CubeTolerance(primary);
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Draw a mesh
+///////////////////////////////////////////////////////////
+void drawMesh(const MeshView& mesh, const TriangleRun* runs, unsigned int runCount)
+{
+    if (mesh.indexCount == 0)
+        return;
+
+    //Hand OpenGL the whole vertex array and draw every triangle in one call,
+    //or each run in one
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_DOUBLE, sizeof(Point3), mesh.positions);
+    if (runs == NULL)
+        glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, mesh.indices);
+    else
+        for (unsigned int run = 0 ; run < runCount ; ++run)
+            glDrawElements(GL_TRIANGLES, 3 * runs[run].count, GL_UNSIGNED_INT, mesh.indices + 3 * runs[run].first);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
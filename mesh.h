@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////
+//
+// File:  mesh.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the indexed mesh the generators produce,
+//               and the declarations for generating a shape into a caller
+//               owned mesh, so that meshes other than the one in the
+//               tessellation window can be built and kept around, and for
+//               drawing such a mesh.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __MESH_H__
+#define __MESH_H__
+
+#include <vector>
+#include "vecmath.h"
+#include "memtrack.h"
+
+// A tessellated shape: vertex positions, the true surface's unit normal at
+// each (written by the generators in the same pass as the positions), and
+// three indices into them per counter-clockwise (front facing) triangle,
+// counted as tessellation memory
+struct Mesh
+{
+    trackedVector<Point3, MEMORY_TESSELLATION> positions;
+    trackedVector<Vector3, MEMORY_TESSELLATION> normals;
+    trackedVector<unsigned int, MEMORY_TESSELLATION> indices;
+
+    void clear() { positions.clear(); normals.clear(); indices.clear(); }
+    unsigned int triangleCount() const { return indices.size() / 3; }
+};
+
+// A read-only window onto a mesh's arrays, which may belong to a Mesh or to
+// a table baked in at compile time.  normals is NULL for meshes that came
+// from somewhere other than the generators, such as a decoded archive.
+struct MeshView
+{
+    const Point3* positions;
+    unsigned int vertexCount;
+    const unsigned int* indices;
+    unsigned int indexCount;
+    const Vector3* normals;
+
+    constexpr MeshView() : positions(0), vertexCount(0), indices(0), indexCount(0), normals(0) {}
+    constexpr MeshView(const Point3* positions_, unsigned int vertexCount_,
+                       const unsigned int* indices_, unsigned int indexCount_,
+                       const Vector3* normals_ = 0)
+        : positions(positions_), vertexCount(vertexCount_), indices(indices_), indexCount(indexCount_),
+          normals(normals_) {}
+    MeshView(const Mesh& mesh)
+        : positions(mesh.positions.data()), vertexCount(mesh.positions.size()),
+          indices(mesh.indices.data()), indexCount(mesh.indices.size()),
+          normals(mesh.normals.size() == mesh.positions.size() && !mesh.normals.empty() ? mesh.normals.data() : 0) {}
+
+    unsigned int triangleCount() const { return indexCount / 3; }
+};
+
+// Triangles [first, first + count) of a mesh
+struct TriangleRun
+{
+    unsigned int first;
+    unsigned int count;
+};
+
+// Run the generator of the given rendering (RENDERING_CUBE, etc.) with the
+// given primary and secondary tessellation, replacing the contents of out;
+// a sphere deeper than SPHERE_MAX_DEPTH comes out empty
+void generateMesh(short rendering, int primary, int secondary, Mesh& out);
+
+// Largest primary tessellation of a rendering: TESSELLATION_MAX, or
+// SPHERE_MAX_DEPTH for the sphere
+int maxPrimaryTessellation(short rendering);
+
+// Work out the smallest tessellation of the given rendering that keeps its
+// triangles within tolerance of the true surface, returning the deviation
+// actually achieved
+double toleranceTessellation(short rendering, double tolerance, int& primary, int& secondary);
+
+// Draw a mesh with the current state, or only the given runs of its
+// triangles if runs is not NULL
+void drawMesh(const MeshView& mesh, const TriangleRun* runs = NULL, unsigned int runCount = 0);
+
+// Mesh that the generators currently append to on this thread
+extern thread_local Mesh* meshSink;
+
+#endif
@@ -0,0 +1,274 @@
+////////////////////////////////////////////////////////////
+//
+// File:  meshlet.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for cluster culling.
+//               Clusters are grown across the corner table's edges from
+//               the first unclustered triangle, so they are compact
+//               patches rather than strips along the generators' rows.
+//
+//               A cluster can be culled when, for every point p in its
+//               sphere and every normal n in its cone, (p - eye) . n > 0.
+//               With v = center - eye at angle theta to the axis and a
+//               cone of half angle alpha, the smallest v . n is
+//               |v| cos(theta + alpha), and p can move it by at most the
+//               radius, so the test is exact for the sphere and cone and
+//               never drops a triangle OpenGL would have drawn.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include "meshlet.h"
+#include "topology.h"
+#include "trace.h"
+
+// Clusters and the arrays they were made from
+struct cachedMeshlets
+{
+    MeshView source;
+    MeshletMesh meshlets;
+};
+
+// Clusters of each mesh drawn lately, newest first, and the ones given
+// out last
+static std::list<cachedMeshlets> cache;
+static const MeshletMesh* last = NULL;
+
+// The last frame's culling
+static meshletCullStats lastCull;
+
+///////////////////////////////////////////////////////////
+//Unit normal of triangle t, or zero if it has no area
+///////////////////////////////////////////////////////////
+static Vector3 triangleNormal(const MeshView& mesh, unsigned int t)
+{
+    const Point3& a = mesh.positions[mesh.indices[3 * t]];
+    const Point3& b = mesh.positions[mesh.indices[3 * t + 1]];
+    const Point3& c = mesh.positions[mesh.indices[3 * t + 2]];
+    Vector3 n = (b - a) ^ (c - a);
+    double length = n.length();
+    return length > 0.0 ? n / length : Vector3();
+}
+
+///////////////////////////////////////////////////////////
+//Fit the sphere and cone of a cluster of the given triangles
+///////////////////////////////////////////////////////////
+static void fitMeshlet(const MeshView& mesh, const std::vector<Vector3>& normals,
+                       const unsigned int* triangles, Meshlet& meshlet)
+{
+    //Sphere about the middle of the bounding box
+    Point3 low = mesh.positions[mesh.indices[3 * triangles[0]]], high = low;
+    for (unsigned int i = 0 ; i < meshlet.triangleCount ; ++i)
+        for (int k = 0 ; k < 3 ; ++k)
+        {
+            const Point3& p = mesh.positions[mesh.indices[3 * triangles[i] + k]];
+            low = Point3(std::min(low.x, p.x), std::min(low.y, p.y), std::min(low.z, p.z));
+            high = Point3(std::max(high.x, p.x), std::max(high.y, p.y), std::max(high.z, p.z));
+        }
+    meshlet.center = Point3((low.x + high.x) / 2, (low.y + high.y) / 2, (low.z + high.z) / 2);
+    meshlet.radius = 0.0;
+    for (unsigned int i = 0 ; i < meshlet.triangleCount ; ++i)
+        for (int k = 0 ; k < 3 ; ++k)
+            meshlet.radius = std::max(meshlet.radius,
+                                      meshlet.center.distanceTo(mesh.positions[mesh.indices[3 * triangles[i] + k]]));
+
+    //Cone about the mean normal; triangles without area have no facing to
+    //keep and OpenGL draws nothing of them anyway.  Until one is found the
+    //cone is the whole sphere of directions, which is never culled.
+    meshlet.axis = Vector3();
+    meshlet.coneCos = -1.0;
+    meshlet.coneSin = 0.0;
+    Vector3 sum;
+    for (unsigned int i = 0 ; i < meshlet.triangleCount ; ++i)
+        sum += normals[triangles[i]];
+    meshlet.cullable = sum.length() > 0.0;
+    if (!meshlet.cullable)
+        return;
+    meshlet.axis = sum / sum.length();
+    meshlet.coneCos = 1.0;
+    for (unsigned int i = 0 ; i < meshlet.triangleCount ; ++i)
+        if (normals[triangles[i]].lengthSquared() > 0.0)
+            meshlet.coneCos = std::min(meshlet.coneCos, meshlet.axis * normals[triangles[i]]);
+
+    //A cone of 90 degrees or more faces the eye from everywhere
+    meshlet.cullable = meshlet.coneCos > 0.0;
+    meshlet.coneSin = sqrt(std::max(0.0, 1.0 - meshlet.coneCos * meshlet.coneCos));
+}
+
+///////////////////////////////////////////////////////////
+//Cluster a mesh's triangles
+///////////////////////////////////////////////////////////
+void buildMeshlets(const MeshView& mesh, MeshletMesh& out)
+{
+    TRACE_SPAN("meshlets");
+    const unsigned int triangles = mesh.triangleCount();
+    out.indices.resize(3 * triangles);
+    out.meshlets.clear();
+    out.view = MeshView(mesh.positions, mesh.vertexCount, out.indices.data(), out.indices.size(), mesh.normals);
+    if (triangles == 0)
+        return;
+
+    CornerTable table;
+    buildCornerTable(mesh, table);
+
+    std::vector<Vector3> normals(triangles);
+    for (unsigned int t = 0 ; t < triangles ; ++t)
+        normals[t] = triangleNormal(mesh, t);
+
+    //Triangles in cluster order; each cluster is a breadth first flood from
+    //its first triangle, so its own part of this list is also its queue
+    std::vector<unsigned int> order;
+    order.reserve(triangles);
+    std::vector<unsigned char> clustered(triangles, 0);
+    unsigned int seed = 0;
+    while (order.size() < triangles)
+    {
+        while (clustered[seed])
+            ++seed;
+
+        Meshlet meshlet;
+        meshlet.firstTriangle = order.size();
+        clustered[seed] = 1;
+        order.push_back(seed);
+        const Vector3& seedNormal = normals[seed];
+
+        for (unsigned int next = meshlet.firstTriangle ;
+             next < order.size() && order.size() - meshlet.firstTriangle < MESHLET_MAX_TRIANGLES ; ++next)
+        {
+            unsigned int t = order[next];
+            for (int k = 0 ; k < 3 && order.size() - meshlet.firstTriangle < MESHLET_MAX_TRIANGLES ; ++k)
+            {
+                unsigned int neighbour = table.neighbour(3 * t + k);
+                if (neighbour == TOPOLOGY_NONE || clustered[neighbour] ||
+                    normals[neighbour] * seedNormal < MESHLET_JOIN_COS)
+                    continue;
+                clustered[neighbour] = 1;
+                order.push_back(neighbour);
+            }
+        }
+
+        meshlet.triangleCount = order.size() - meshlet.firstTriangle;
+        fitMeshlet(mesh, normals, &order[meshlet.firstTriangle], meshlet);
+        out.meshlets.push_back(meshlet);
+    }
+
+    for (unsigned int i = 0 ; i < triangles ; ++i)
+        for (int k = 0 ; k < 3 ; ++k)
+            out.indices[3 * i + k] = mesh.indices[3 * order[i] + k];
+}
+
+///////////////////////////////////////////////////////////
+//Clusters of a mesh, made once per set of arrays
+///////////////////////////////////////////////////////////
+const MeshletMesh& meshletsFor(const MeshView& mesh, bool* changed)
+{
+    const MeshletMesh* found = NULL;
+    for (std::list<cachedMeshlets>::iterator c = cache.begin() ; found == NULL && c != cache.end() ; ++c)
+        if (c->source.positions == mesh.positions && c->source.indices == mesh.indices &&
+            c->source.vertexCount == mesh.vertexCount && c->source.indexCount == mesh.indexCount)
+        {
+            cache.splice(cache.begin(), cache, c);
+            found = &cache.front().meshlets;
+        }
+
+    //Anything not kept is clustered, pushing out the mesh drawn longest ago
+    if (found == NULL)
+    {
+        if (cache.size() >= MESHLET_CACHE_MESHES)
+            cache.pop_back();
+        cache.push_front(cachedMeshlets());
+        cache.front().source = mesh;
+        buildMeshlets(mesh, cache.front().meshlets);
+        found = &cache.front().meshlets;
+    }
+
+    if (changed != NULL)
+        *changed = found != last;
+    last = found;
+    return *found;
+}
+
+void forgetMeshlets()
+{
+    cache.clear();
+    last = NULL;
+}
+
+///////////////////////////////////////////////////////////
+//World vectors in the shape's coordinates
+///////////////////////////////////////////////////////////
+Vector3 intoShape(const shapeState& shape, const Vector3& v)
+{
+    //The shape is drawn turned by Rx Ry Rz, so the vector is turned back
+    //by the inverse, Rz' Ry' Rx', applied right to left
+    double x = v.x, y = v.y, z = v.z;
+    double a = -shape.xRotation * M_PI / 180.0;
+    double turned = y * cos(a) - z * sin(a);
+    z = y * sin(a) + z * cos(a);
+    y = turned;
+
+    a = -shape.yRotation * M_PI / 180.0;
+    turned = x * cos(a) + z * sin(a);
+    z = -x * sin(a) + z * cos(a);
+    x = turned;
+
+    a = -shape.zRotation * M_PI / 180.0;
+    turned = x * cos(a) - y * sin(a);
+    y = x * sin(a) + y * cos(a);
+    x = turned;
+
+    return Vector3(x, y, z);
+}
+
+Point3 tessEyePosition(const shapeState& shape)
+{
+    return Point3(0, 0, 0) + intoShape(shape, Vector3(0.0, 0.0, CAMERA_DISTANCE));
+}
+
+///////////////////////////////////////////////////////////
+//Drop the clusters that face away from the eye
+///////////////////////////////////////////////////////////
+meshletCullStats cullMeshlets(const MeshletMesh& mesh, const Point3& eye, std::vector<TriangleRun>& runs)
+{
+    TRACE_SPAN("cull meshlets");
+    meshletCullStats stats = { (unsigned int)mesh.meshlets.size(), 0, mesh.view.triangleCount(), 0 };
+    runs.clear();
+
+    for (unsigned int i = 0 ; i < mesh.meshlets.size() ; ++i)
+    {
+        const Meshlet& meshlet = mesh.meshlets[i];
+        if (meshlet.cullable)
+        {
+            //|v| cos(theta + alpha), less the radius, must stay positive
+            Vector3 v = meshlet.center - eye;
+            double along = v * meshlet.axis;
+            double across = sqrt(std::max(0.0, v.lengthSquared() - along * along));
+            if (along * meshlet.coneCos - across * meshlet.coneSin > meshlet.radius)
+            {
+                ++stats.culledMeshlets;
+                stats.culledTriangles += meshlet.triangleCount;
+                continue;
+            }
+        }
+
+        //Clusters are contiguous, so a kept cluster after a kept one
+        //extends its run
+        if (!runs.empty() && runs.back().first + runs.back().count == meshlet.firstTriangle)
+            runs.back().count += meshlet.triangleCount;
+        else
+            runs.push_back(TriangleRun { meshlet.firstTriangle, meshlet.triangleCount });
+    }
+
+    lastCull = stats;
+    return stats;
+}
+
+const meshletCullStats& lastMeshletCull()
+{
+    return lastCull;
+}
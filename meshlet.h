@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////
+//
+// File:  meshlet.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for cluster culling.  A
+//               mesh's triangles are grouped into small connected patches
+//               of similar facing, each with a bounding sphere and a cone
+//               holding all of its normals.  Per frame a patch that faces
+//               away from the eye wherever it is looked at from is dropped
+//               before it is handed to OpenGL, rather than sending each of
+//               its triangles down the pipeline for GL_CULL_FACE to reject.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __MESHLET_H__
+#define __MESHLET_H__
+
+#include <vector>
+#include "resources.h"
+#include "mesh.h"
+
+// Most triangles in a cluster
+#define MESHLET_MAX_TRIANGLES 64
+
+// A triangle joins a cluster only if its normal is within this cosine of
+// the normal of the cluster's first triangle (about 25 degrees), so clusters
+// keep cones narrow enough to cull
+#define MESHLET_JOIN_COS 0.9
+
+// Meshes whose clusters are kept: the full tessellation and one per proxy
+// level drawn while it is rotated
+#define MESHLET_CACHE_MESHES 4
+
+// A patch of triangles [firstTriangle, firstTriangle + triangleCount) of
+// the reordered mesh
+struct Meshlet
+{
+    unsigned int firstTriangle;
+    unsigned int triangleCount;
+    Point3 center;              // Bounding sphere
+    double radius;
+    Vector3 axis;               // Every normal is within the cone's angle of axis
+    double coneCos;
+    double coneSin;
+    bool cullable;              // False if the cone is too wide to ever face away
+};
+
+// A mesh's triangles reordered cluster by cluster, counted as draw memory;
+// view is the source's vertices with the reordered indices
+struct MeshletMesh
+{
+    trackedVector<unsigned int, MEMORY_DRAW> indices;
+    trackedVector<Meshlet, MEMORY_DRAW> meshlets;
+    MeshView view;
+};
+
+// What one frame's culling kept out of the pipeline
+struct meshletCullStats
+{
+    unsigned int meshlets;
+    unsigned int culledMeshlets;
+    unsigned int triangles;
+    unsigned int culledTriangles;
+};
+
+// Cluster a mesh's triangles into out
+void buildMeshlets(const MeshView& mesh, MeshletMesh& out);
+
+// Clusters of a mesh, reusing ones made of the same arrays if they are
+// still kept (changed, if given, says whether they are not the ones given
+// out last); forgetMeshlets() drops them all when the arrays are rewritten
+const MeshletMesh& meshletsFor(const MeshView& mesh, bool* changed = NULL);
+void forgetMeshlets();
+
+// A vector of the tessellation window's world turned into the coordinates
+// of a shape turned by shape's rotation
+Vector3 intoShape(const shapeState& shape, const Vector3& v);
+
+// Where the tessellation window's eye is in the coordinates of a shape
+// turned by shape's rotation
+Point3 tessEyePosition(const shapeState& shape);
+
+// Fill runs with the triangles of mesh.view that may face eye, merging
+// neighbouring clusters, and return what was culled
+meshletCullStats cullMeshlets(const MeshletMesh& mesh, const Point3& eye, std::vector<TriangleRun>& runs);
+
+// What the last frame drawn with culling culled
+const meshletCullStats& lastMeshletCull();
+
+#endif
@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////
+//
+// File:  parametric.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the parametric tessellation engine.  A
+//               surface f(u, v) over the unit square is sampled on a
+//               rows x cols grid and appended to a Mesh as shared
+//               vertices plus two triangles per cell.
+//
+//               A surface is any class providing
+//
+//                   typedef ... Column;
+//                   Column column(double u) const;
+//                   Point3 point(const Column& c, double v) const;
+//                   Vector3 normal(const Column& c, double v) const;
+//
+//               column() is evaluated once per grid column (this is where
+//               the trig goes), point() and normal() once per vertex in the
+//               same loop, so the per vertex work is a few multiply-adds the
+//               compiler can vectorize.  normal() is the true surface's unit
+//               outward normal, not one averaged from the triangles.
+//               The triangles of a cell are (p[r][c], p[r+1][c], p[r][c+1])
+//               and (p[r+1][c], p[r+1][c+1], p[r][c+1]), so dv x du must
+//               point out of the surface for them to face the viewer.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __PARAMETRIC_H__
+#define __PARAMETRIC_H__
+
+#include <algorithm>
+#include <vector>
+#include "mesh.h"
+#include "tasks.h"
+#include "trace.h"
+
+// Grid options
+#define GRID_WRAP_COLUMNS 1   // Column cols is column 0 again (closed rings)
+#define GRID_POLE_AT_TOP  2   // Row 0 is a single point (cone apex, cap center)
+#define GRID_SPLIT_POLE   4   // With GRID_POLE_AT_TOP, the point is repeated for
+                              // each cell under it, so each can take its own
+                              // normal (cone apex)
+
+// Grids with fewer vertices than this are not worth a thread
+#define PARALLEL_GRID_MIN_VERTICES 16384
+
+///////////////////////////////////////////////////////////
+//Run body(firstRow, endRow) over [0, rows), split into tasks when
+//the grid is big enough to pay for them
+///////////////////////////////////////////////////////////
+template <class Body>
+void parallelRows(int rows, int verticesPerRow, const Body& body)
+{
+    int workers = taskWorkers();
+    int bands = std::min(workers * TASKS_PER_WORKER, rows);
+    if (workers <= 1 || bands <= 1 || rows * verticesPerRow < PARALLEL_GRID_MIN_VERTICES)
+    {
+        body(0, rows);
+        return;
+    }
+
+    //Contiguous bands of rows, more than there are threads so that one
+    //that finishes early takes another's; this thread runs the first
+    TaskGroup bandTasks;
+    for (int b = 1 ; b < bands ; ++b)
+        bandTasks.spawn([&body, rows, bands, b] { body(rows * b / bands, rows * (b + 1) / bands); });
+    body(0, rows / bands);
+    bandTasks.wait();
+}
+
+// Where a grid's vertices and triangles go in its share of a mesh
+struct gridLayout
+{
+    int rows;
+    int cols;
+    bool wrap;
+    int rowVertices;                // Vertices per grid row
+    int firstFullRow;               // First row that is a whole ring of vertices
+    unsigned int poleVertices;      // 1 if row 0 is a single point, cols if it is split
+    unsigned int vertexCount;
+    unsigned int triangleCount;
+
+    constexpr gridLayout(int rows_, int cols_, unsigned int options)
+        : rows(rows_), cols(cols_), wrap((options & GRID_WRAP_COLUMNS) != 0),
+          rowVertices(wrap ? cols_ : cols_ + 1),
+          firstFullRow((options & GRID_POLE_AT_TOP) ? 1 : 0),
+          poleVertices((options & GRID_POLE_AT_TOP) ? ((options & GRID_SPLIT_POLE) ? cols_ : 1) : 0),
+          vertexCount(poleVertices + (rows_ + 1 - firstFullRow) * rowVertices),
+          triangleCount(2 * rows_ * cols_ - (poleVertices ? cols_ : 0))
+    {
+    }
+
+    //Index (from the grid's first vertex) of the vertex at row r, column c,
+    //where a pole row's is the one over cell c
+    constexpr unsigned int vertexAt(int r, int c) const
+    {
+        if (r < firstFullRow)
+            return poleVertices > 1 ? c : 0;
+        if (wrap && c == cols)
+            c = 0;
+        return poleVertices + (r - firstFullRow) * rowVertices + c;
+    }
+
+    //Triangles before the cells below row r
+    constexpr unsigned int trianglesBefore(int r) const
+    {
+        return 2 * r * cols - ((poleVertices && r > 0) ? cols : 0);
+    }
+};
+
+///////////////////////////////////////////////////////////
+//Column terms of grid column c
+///////////////////////////////////////////////////////////
+template <class Surface>
+constexpr typename Surface::Column gridColumn(const Surface& surface, const gridLayout& grid, int c)
+{
+    return surface.column(double(c) / grid.cols);
+}
+
+///////////////////////////////////////////////////////////
+//Fill vertex rows [firstRow, endRow) of a grid and the cells below them.
+//positions, normals and indices point at the grid's first vertex and
+//index, and base is the mesh index of its first vertex.  This is the one
+//kernel both the generators and the meshes baked at compile time go
+//through.
+///////////////////////////////////////////////////////////
+template <class Surface>
+constexpr void fillGridRows(const Surface& surface, const gridLayout& grid,
+                            const typename Surface::Column* columns,
+                            Point3* positions, Vector3* normals, unsigned int* indices,
+                            unsigned int base, int firstRow, int endRow)
+{
+    //A split pole's vertices take the normal halfway across their cells
+    if (grid.poleVertices && firstRow == 0)
+        for (unsigned int c = 0 ; c < grid.poleVertices ; ++c)
+        {
+            const typename Surface::Column column =
+                grid.poleVertices > 1 ? surface.column((c + 0.5) / grid.cols) : columns[0];
+            positions[c] = surface.point(column, 0.0);
+            normals[c] = surface.normal(column, 0.0);
+        }
+
+    for (int r = std::max(firstRow, grid.firstFullRow) ; r < endRow ; ++r)
+    {
+        const double v = double(r) / grid.rows;
+        Point3* row = positions + grid.vertexAt(r, 0);
+        Vector3* rowNormals = normals + grid.vertexAt(r, 0);
+        for (int c = 0 ; c < grid.rowVertices ; ++c)
+        {
+            row[c] = surface.point(columns[c], v);
+            rowNormals[c] = surface.normal(columns[c], v);
+        }
+    }
+
+    //Row r of vertices owns the cells below it
+    for (int r = firstRow ; r < std::min(endRow, grid.rows) ; ++r)
+    {
+        unsigned int* cell = indices + 3 * grid.trianglesBefore(r);
+        for (int c = 0 ; c < grid.cols ; ++c)
+        {
+            if (r >= grid.firstFullRow)
+            {
+                *cell++ = base + grid.vertexAt(r, c);
+                *cell++ = base + grid.vertexAt(r + 1, c);
+                *cell++ = base + grid.vertexAt(r, c + 1);
+            }
+            *cell++ = base + grid.vertexAt(r + 1, c);
+            *cell++ = base + grid.vertexAt(r + 1, c + 1);
+            *cell++ = base + (r < grid.firstFullRow ? grid.vertexAt(r, c) : grid.vertexAt(r, c + 1));
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Tessellate surface into out with the given grid resolution
+///////////////////////////////////////////////////////////
+template <class Surface>
+void tessellateSurface(const Surface& surface, int rows, int cols, unsigned int options, Mesh& out)
+{
+    if (rows < 1 || cols < 1)
+        return;
+
+    const gridLayout grid(rows, cols, options);
+
+    //Column terms are shared by every row
+    std::vector<typename Surface::Column> columns(grid.rowVertices);
+    for (int c = 0 ; c < grid.rowVertices ; ++c)
+        columns[c] = gridColumn(surface, grid, c);
+
+    //Everything is written in place, so rows can be filled independently
+    const unsigned int base = out.positions.size();
+    const unsigned int firstIndex = out.indices.size();
+    out.positions.resize(base + grid.vertexCount);
+    out.normals.resize(base + grid.vertexCount);
+    out.indices.resize(firstIndex + 3 * grid.triangleCount);
+    Point3* positions = &out.positions[base];
+    Vector3* normals = &out.normals[base];
+    unsigned int* indices = &out.indices[firstIndex];
+
+    parallelRows(rows + 1, grid.rowVertices, [&](int firstRow, int endRow)
+    {
+        TRACE_SPAN("grid rows");
+        fillGridRows(surface, grid, &columns[0], positions, normals, indices, base, firstRow, endRow);
+    });
+}
+
+#endif
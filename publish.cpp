@@ -0,0 +1,455 @@
+////////////////////////////////////////////////////////////
+//
+// File:  publish.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for publishing the
+//               active mesh.  The segment is mapped into a reservation of
+//               address space, so that growing it never moves what is
+//               already in it, and each slot's positions and indices are
+//               allocators' arenas: the tessellation window generates
+//               straight into the slot readers are not pointed at, and the
+//               hand-off is a store of the slot number and a bump of the
+//               generation, plus a futex wake for any reader asleep on it.
+//               Meshes built anywhere else are copied in.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "resources.h"
+#include "publish.h"
+#include "sharedmesh.h"
+
+// The segment being published to, mapped at the start of a reservation
+// that is kept for the life of the process once made
+static int segmentFd = -1;
+static unsigned char* segment = NULL;
+static unsigned char* reservation = NULL;
+static size_t mappedBytes = 0;
+static std::string segmentName;
+
+static size_t pageRound(size_t bytes)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    return (bytes + page - 1) / page * page;
+}
+
+static sharedMeshHeader& header()
+{
+    return *(sharedMeshHeader*)segment;
+}
+
+///////////////////////////////////////////////////////////
+//Map bytes more of the segment after what is mapped, returning where
+//they start
+///////////////////////////////////////////////////////////
+static bool growSegment(uint64_t bytes, uint64_t& offset)
+{
+    offset = mappedBytes;
+    if (offset + bytes > PUBLISH_RESERVE_BYTES || ftruncate(segmentFd, offset + bytes) != 0 ||
+        mmap(segment + offset, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, segmentFd, offset) == MAP_FAILED)
+        return false;
+    mappedBytes = offset + bytes;
+    header().segmentBytes.store(mappedBytes, std::memory_order_release);
+    return true;
+}
+
+// Allocations a slot region holds at once: a growing array's old copy and
+// new one, and a mesh still held while the next is built
+#define ARENA_LIVE 4
+
+// A region of the segment one array of one slot is allocated from.  An
+// allocation goes at either end of it, so a growing array's old copy and
+// new one fit side by side; a region that is outgrown is left behind for a
+// bigger one at the end of the segment.
+struct slotArena : trackedArena
+{
+    uint64_t offset;
+    uint64_t capacity;
+    uint64_t live[ARENA_LIVE];
+    uint64_t liveBytes[ARENA_LIVE];
+    unsigned int liveCount;
+
+    bool overlapsLive(uint64_t at, uint64_t bytes) const
+    {
+        for (unsigned int i = 0 ; i < liveCount ; ++i)
+            if (at < live[i] + liveBytes[i] && live[i] < at + bytes)
+                return true;
+        return false;
+    }
+
+    void* allocate(std::size_t bytes)
+    {
+        if (!publishing())
+            return NULL;
+        bytes = std::max<uint64_t>((bytes + 63) & ~uint64_t(63), 64);
+
+        uint64_t at = offset;
+        if (liveCount == ARENA_LIVE || bytes > capacity || overlapsLive(at, bytes))
+        {
+            at = offset + capacity - bytes;
+            if (liveCount == ARENA_LIVE || bytes > capacity || overlapsLive(at, bytes))
+            {
+                //Room for a doubling array's next copy beside this one;
+                //pages are only backed once written
+                uint64_t grown = pageRound(std::max<uint64_t>(4 * bytes, PUBLISH_MIN_REGION_BYTES));
+                if (!growSegment(grown, at))
+                    return NULL;
+                offset = at;
+                capacity = grown;
+                liveCount = 0;
+            }
+        }
+        live[liveCount] = at;
+        liveBytes[liveCount++] = bytes;
+        return segment + at;
+    }
+
+    bool release(void* memory, std::size_t)
+    {
+        //A region left behind is not used again, so only this one's count
+        unsigned char* at = (unsigned char*)memory;
+        if (reservation == NULL || at < reservation || at >= reservation + PUBLISH_RESERVE_BYTES)
+            return false;
+        for (unsigned int i = 0 ; i < liveCount ; ++i)
+            if (reservation + live[i] == at)
+            {
+                live[i] = live[--liveCount];
+                liveBytes[i] = liveBytes[liveCount];
+                break;
+            }
+        return true;
+    }
+
+    bool holds(const void* memory, uint64_t bytes) const
+    {
+        for (unsigned int i = 0 ; i < liveCount ; ++i)
+            if (segment + live[i] == memory && bytes <= liveBytes[i])
+                return true;
+        return false;
+    }
+};
+
+static slotArena positionArenas[2];
+static slotArena indexArenas[2];
+
+///////////////////////////////////////////////////////////
+//Create the segment with just its header
+///////////////////////////////////////////////////////////
+bool startPublishing(const char* name)
+{
+    stopPublishing();
+
+    //A segment left by an earlier run is unlinked rather than truncated,
+    //so readers still mapping it are not cut off
+    shm_unlink(name);
+    segmentFd = shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (segmentFd < 0)
+        return false;
+    if (reservation == NULL)
+    {
+        void* reserved = mmap(NULL, PUBLISH_RESERVE_BYTES, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        reservation = reserved == MAP_FAILED ? NULL : (unsigned char*)reserved;
+    }
+    mappedBytes = pageRound(sizeof(sharedMeshHeader));
+    if (reservation == NULL || ftruncate(segmentFd, mappedBytes) != 0 ||
+        mmap(reservation, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, segmentFd, 0) == MAP_FAILED)
+    {
+        close(segmentFd);
+        segmentFd = -1;
+        shm_unlink(name);
+        return false;
+    }
+    segment = reservation;
+    segmentName = name;
+    for (int slot = 0 ; slot < 2 ; ++slot)
+    {
+        positionArenas[slot].capacity = positionArenas[slot].liveCount = 0;
+        indexArenas[slot].capacity = indexArenas[slot].liveCount = 0;
+    }
+
+    sharedMeshHeader* created = new (segment) sharedMeshHeader();
+    created->headerBytes = sizeof(sharedMeshHeader);
+    created->segmentBytes.store(mappedBytes, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    created->magic = SHARED_MESH_MAGIC;
+    return true;
+}
+
+bool publishing()
+{
+    return segment != NULL;
+}
+
+///////////////////////////////////////////////////////////
+//Mark the slot readers are not pointed at as being written, returning it
+///////////////////////////////////////////////////////////
+static unsigned int openBackSlot()
+{
+    unsigned int back = 1 - header().active.load(std::memory_order_relaxed);
+    sharedMeshSlot& slot = header().slots[back];
+
+    //Odd while written, so a reader still on this slot sees it change
+    if ((slot.sequence.load(std::memory_order_relaxed) & 1) == 0)
+    {
+        slot.sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    return back;
+}
+
+///////////////////////////////////////////////////////////
+//Generate a mesh in the slot readers are not pointed at
+///////////////////////////////////////////////////////////
+void generatePublishable(short rendering, int primary, int secondary, Mesh& out)
+{
+    if (!publishing())
+    {
+        generateMesh(rendering, primary, secondary, out);
+        return;
+    }
+
+    Mesh built;
+    unsigned int back = openBackSlot();
+    built.positions = trackedVector<Point3, MEMORY_TESSELLATION>(trackedAllocator<Point3, MEMORY_TESSELLATION>(&positionArenas[back]));
+    built.indices = trackedVector<unsigned int, MEMORY_TESSELLATION>(trackedAllocator<unsigned int, MEMORY_TESSELLATION>(&indexArenas[back]));
+    generateMesh(rendering, primary, secondary, built);
+
+    //The mesh out held before, most likely the one readers are on now, is
+    //freed with built
+    out.positions.swap(built.positions);
+    out.normals.swap(built.normals);
+    out.indices.swap(built.indices);
+}
+
+///////////////////////////////////////////////////////////
+//Publish a mesh from the slot readers are not pointed at
+///////////////////////////////////////////////////////////
+void publishMesh(const MeshView& mesh, short rendering, int primary, int secondary)
+{
+    if (!publishing())
+        return;
+
+    unsigned int back = openBackSlot();
+    sharedMeshSlot& slot = header().slots[back];
+    uint64_t positionBytes = uint64_t(mesh.vertexCount) * sizeof(Point3);
+    uint64_t indexBytes = uint64_t(mesh.indexCount) * sizeof(unsigned int);
+
+    //A mesh generated for publishing is already in place; anything else is
+    //copied in, and the copy belongs to the slot until it is next written
+    const void* positions = mesh.positions;
+    const void* indices = mesh.indices;
+    if (!positionArenas[back].holds(positions, positionBytes) || !indexArenas[back].holds(indices, indexBytes))
+    {
+        void* positionsCopy = positionArenas[back].allocate(positionBytes);
+        void* indicesCopy = indexArenas[back].allocate(indexBytes);
+        if (positionsCopy != NULL)
+            positionArenas[back].release(positionsCopy, positionBytes);
+        if (indicesCopy != NULL)
+            indexArenas[back].release(indicesCopy, indexBytes);
+        if (positionsCopy == NULL || indicesCopy == NULL)
+        {
+            fprintf(stderr, "Could not grow %s to publish %llu bytes\n", segmentName.c_str(),
+                    (unsigned long long)(positionBytes + indexBytes));
+            return;
+        }
+        memcpy(positionsCopy, positions, positionBytes);
+        memcpy(indicesCopy, indices, indexBytes);
+        positions = positionsCopy;
+        indices = indicesCopy;
+    }
+
+    slot.rendering = rendering;
+    slot.primary = primary;
+    slot.secondary = secondary;
+    slot.vertexCount = mesh.vertexCount;
+    slot.indexCount = mesh.indexCount;
+    slot.positionsOffset = (const unsigned char*)positions - segment;
+    slot.indicesOffset = (const unsigned char*)indices - segment;
+    slot.publishedNs = sharedMeshClockNs();
+    slot.sequence.fetch_add(1, std::memory_order_release);
+
+    //The hand-off
+    header().active.store(back, std::memory_order_release);
+    header().generation.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, (uint32_t*)&header().generation, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+///////////////////////////////////////////////////////////
+//Remove the segment; meshes still in it may be freed, but not read
+///////////////////////////////////////////////////////////
+void stopPublishing()
+{
+    if (!publishing())
+        return;
+
+    //The reservation is kept, so memory in it is still told from the heap's
+    //when it is freed
+    mmap(reservation, mappedBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    close(segmentFd);
+    shm_unlink(segmentName.c_str());
+    segment = NULL;
+    segmentFd = -1;
+}
+
+// Meshes the report publishes, coarse to fine so the segment grows
+struct reportLevel
+{
+    short rendering;
+    const char* name;
+    int primary;
+    int secondary;
+};
+
+static const reportLevel reportLevels[] =
+{
+    { RENDERING_CUBE, "Cube", 8, 1 },
+    { RENDERING_CYL, "Cylinder", 32, 32 },
+    { RENDERING_SPH, "Sphere", 4, 1 },
+    { RENDERING_CONE, "Cone", 150, 150 },
+    { RENDERING_CUBE, "Cube", 150, 1 },
+    { RENDERING_SPH, "Sphere", 8, 1 },
+    { RENDERING_CUBE, "Cube", 2, 1 }
+};
+
+///////////////////////////////////////////////////////////
+//Publish the report meshes to a reader thread
+///////////////////////////////////////////////////////////
+int publishReport()
+{
+    char name[64];
+    sprintf(name, "/tessellation-report-%d", (int)getpid());
+    if (!startPublishing(name))
+    {
+        perror(name);
+        return 1;
+    }
+    sharedMeshReader reader;
+    if (!openSharedMesh(name, reader))
+    {
+        fprintf(stderr, "Could not map %s to read\n", name);
+        stopPublishing();
+        return 1;
+    }
+
+    //The reader wakes on each generation and checks the mesh against the
+    //publisher's, which is in this process only to be compared with
+    const unsigned int levels = sizeof(reportLevels) / sizeof(reportLevels[0]);
+    std::vector<Mesh> meshes(levels);
+    for (unsigned int i = 0 ; i < levels ; ++i)
+        generateMesh(reportLevels[i].rendering, reportLevels[i].primary, reportLevels[i].secondary, meshes[i]);
+
+    std::atomic<unsigned int> checked(0);
+    std::vector<double> wakeUs(levels);
+    int failures = 0;
+    std::thread consumer([&]
+    {
+        uint32_t seen = 0;
+        for (unsigned int i = 0 ; i < levels ; ++i)
+        {
+            while ((seen = waitSharedMesh(reader, seen, 1000)) == i)
+                ;
+            uint64_t woke = sharedMeshClockNs();
+            sharedMeshFrame frame;
+            const Mesh& expected = meshes[i];
+            bool ok = readSharedMesh(reader, frame) && frame.generation == i + 1 &&
+                      frame.mesh.vertexCount == expected.positions.size() && frame.mesh.indexCount == expected.indices.size() &&
+                      memcmp(frame.mesh.positions, expected.positions.data(), expected.positions.size() * sizeof(Point3)) == 0 &&
+                      memcmp(frame.mesh.indices, expected.indices.data(), expected.indices.size() * sizeof(unsigned int)) == 0 &&
+                      sharedMeshStillValid(reader, frame);
+            failures += !ok;
+            wakeUs[i] = (woke - frame.publishedNs) / 1000.0;
+            checked.store(i + 1, std::memory_order_release);
+        }
+    });
+
+    //Each mesh is generated in place, as the tessellation window does
+    printf("%-9s %9s %9s %10s %10s %10s\n", "Shape", "Level", "Triangles", "Bytes", "Publish ms", "Wake us");
+    Mesh built;
+    for (unsigned int i = 0 ; i < levels ; ++i)
+    {
+        generatePublishable(reportLevels[i].rendering, reportLevels[i].primary, reportLevels[i].secondary, built);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        publishMesh(built, reportLevels[i].rendering, reportLevels[i].primary, reportLevels[i].secondary);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        bool copied = segment + header().slots[header().active.load()].positionsOffset != (unsigned char*)built.positions.data();
+        failures += copied;
+
+        //One mesh at a time, so every generation is looked at
+        while (checked.load(std::memory_order_acquire) <= i)
+            std::this_thread::yield();
+
+        const reportLevel& level = reportLevels[i];
+        char levelText[32];
+        sprintf(levelText, "%d x %d", level.primary, level.secondary);
+        printf("%-9s %9s %9u %10lu %10.3f %10.1f%s\n", level.name, levelText, meshes[i].triangleCount(),
+               (unsigned long)(meshes[i].positions.size() * sizeof(Point3) + meshes[i].indices.size() * sizeof(unsigned int)),
+               ms, wakeUs[i], copied ? "  copied, not built in place" : "");
+    }
+    consumer.join();
+
+    //A mesh held while two more are published has had its slot rewritten,
+    //and the reader must be able to tell; these are copied in
+    sharedMeshFrame held;
+    readSharedMesh(reader, held);
+    publishMesh(meshes[0], reportLevels[0].rendering, reportLevels[0].primary, reportLevels[0].secondary);
+    bool keptValid = sharedMeshStillValid(reader, held);
+    publishMesh(meshes[1], reportLevels[1].rendering, reportLevels[1].primary, reportLevels[1].secondary);
+    if (!keptValid || sharedMeshStillValid(reader, held))
+    {
+        printf("A held mesh was not reported %s\n", keptValid ? "overwritten" : "valid");
+        ++failures;
+    }
+
+    printf("Segment grew to %llu bytes\n", (unsigned long long)header().segmentBytes.load());
+    closeSharedMesh(reader);
+    stopPublishing();
+    return failures;
+}
+
+///////////////////////////////////////////////////////////
+//Print each published mesh as it arrives
+///////////////////////////////////////////////////////////
+int watchPublished(const char* name)
+{
+    sharedMeshReader reader;
+    if (!openSharedMesh(name, reader))
+    {
+        fprintf(stderr, "Nothing is published as %s\n", name);
+        return 1;
+    }
+
+    const char* names[4] = { "Cube", "Cylinder", "Cone", "Sphere" };
+    uint32_t seen = 0;
+    while (true)
+    {
+        uint32_t generation = waitSharedMesh(reader, seen, -1);
+        if (generation == seen)
+            continue;
+        seen = generation;
+        sharedMeshFrame frame;
+        if (!readSharedMesh(reader, frame))
+            continue;
+        printf("Generation %u: %s %d x %d, %u vertices, %u triangles, %.1f us after publishing\n",
+               frame.generation, frame.rendering >= 0 && frame.rendering < 4 ? names[frame.rendering] : "?",
+               frame.primary, frame.secondary, frame.mesh.vertexCount, frame.mesh.triangleCount(),
+               (sharedMeshClockNs() - frame.publishedNs) / 1000.0);
+        fflush(stdout);
+    }
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////
+//
+// File:  publish.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for publishing the
+//               active mesh to other processes through the shared memory
+//               segment laid out in sharedmesh.h.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __PUBLISH_H__
+#define __PUBLISH_H__
+
+#include "mesh.h"
+
+// Address space the segment may grow into without moving
+#define PUBLISH_RESERVE_BYTES (1ull << 36)
+
+// A slot's arrays get regions of at least this, and of room for one more
+// doubling, so a growing tessellation does not grow the segment at every
+// step
+#define PUBLISH_MIN_REGION_BYTES (1u << 20)
+
+// Create (or take over) the segment of the given name; returns false if
+// it could not be made
+bool startPublishing(const char* name);
+
+// Whether a segment is being published to
+bool publishing();
+
+// Generate a rendering, replacing the contents of out, straight into the
+// slot readers are not pointed at, so that publishing it copies nothing
+void generatePublishable(short rendering, int primary, int secondary, Mesh& out);
+
+// Publish a mesh of the given rendering and tessellation, waking readers;
+// one not from generatePublishable is copied into the segment
+void publishMesh(const MeshView& mesh, short rendering, int primary, int secondary);
+
+// Remove the segment; readers that have it mapped keep their mapping
+void stopPublishing();
+
+// Publish every shape at several levels to a scratch segment while a
+// reader thread, going through the reader library, checks each one and
+// times the hand-off; returns the number of meshes the reader got wrong
+int publishReport();
+
+// Print each mesh published to the named segment as it arrives, until
+// interrupted
+int watchPublished(const char* name);
+
+#endif
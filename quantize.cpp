@@ -0,0 +1,220 @@
+////////////////////////////////////////////////////////////
+//
+// File:  quantize.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the compact
+//               vertex format.  Every shape fits in the unit cube, so 16
+//               bits per axis across its bounding box leaves the error
+//               under 2e-5, at 6 bytes a vertex instead of 24 for doubles
+//               (or 12 for floats), and the same again for the normals.
+//               The active mesh keeps only the 16 bit copy while nothing
+//               else needs its doubles.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <list>
+#include "resources.h"
+#include "quantize.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+// A quantized copy and the arrays it was made from
+struct cachedQuantized
+{
+    MeshView source;
+    QuantizedMesh quantized;
+};
+
+// The active mesh's 16 bit vertices when they replace its doubles, copies
+// of other meshes newest first, and the copy given out last
+static QuantizedMesh active;
+static bool activeValid = false;
+static std::list<cachedQuantized> cache;
+static const QuantizedMesh* last = NULL;
+
+///////////////////////////////////////////////////////////
+//Quantize a mesh to 16 bits per axis
+///////////////////////////////////////////////////////////
+void quantizeMesh(const MeshView& mesh, QuantizedMesh& out)
+{
+    out.positions.resize(3 * mesh.vertexCount);
+    out.indices = mesh.indices;
+    out.indexCount = mesh.indexCount;
+    out.maxError = 0.0;
+
+    //Fit the range of each axis to the bounding box
+    double bound = 0.0;
+    for (int a = 0 ; a < 3 ; ++a)
+    {
+        double low = 0.0, high = 0.0;
+        for (unsigned int i = 0 ; i < mesh.vertexCount ; ++i)
+        {
+            double value = mesh.positions[i][a];
+            if (i == 0 || value < low)  low = value;
+            if (i == 0 || value > high) high = value;
+        }
+        out.offset[a] = (low + high) / 2;
+        out.scale[a] = std::max((high - low) / 2, 1e-12);
+
+        double halfStep = out.scale[a] / QUANTIZE_RANGE / 2;
+        bound += halfStep * halfStep;
+    }
+    out.errorBound = sqrt(bound);
+
+    for (unsigned int i = 0 ; i < mesh.vertexCount ; ++i)
+    {
+        double error = 0.0;
+        for (int a = 0 ; a < 3 ; ++a)
+        {
+            double normalized = (mesh.positions[i][a] - out.offset[a]) / out.scale[a];
+            long q = lround(normalized * QUANTIZE_RANGE);
+            q = std::max(-(long)QUANTIZE_RANGE, std::min((long)QUANTIZE_RANGE, q));
+            out.positions[3 * i + a] = (short)q;
+
+            //Measure where the vertex ends up against where it started
+            double restored = out.offset[a] + out.scale[a] * q / QUANTIZE_RANGE;
+            error += (restored - mesh.positions[i][a]) * (restored - mesh.positions[i][a]);
+        }
+        out.maxError = std::max(out.maxError, sqrt(error));
+    }
+
+    //OpenGL turns normals by the inverse of the modelview's scale, so they
+    //are stored scaled by it (over the largest axis, to stay in range)
+    out.normals.clear();
+    if (mesh.normals == NULL)
+        return;
+    double largest = std::max(out.scale[0], std::max(out.scale[1], out.scale[2]));
+    out.normals.resize(3 * mesh.vertexCount);
+    for (unsigned int i = 0 ; i < mesh.vertexCount ; ++i)
+        for (int a = 0 ; a < 3 ; ++a)
+            out.normals[3 * i + a] = (short)lround(mesh.normals[i][a] * out.scale[a] / largest * QUANTIZE_RANGE);
+}
+
+///////////////////////////////////////////////////////////
+//Quantize a mesh in place of its doubles
+///////////////////////////////////////////////////////////
+void replaceWithQuantized(Mesh& mesh, QuantizedMesh& out)
+{
+    quantizeMesh(mesh, out);
+    trackedVector<Point3, MEMORY_TESSELLATION>().swap(mesh.positions);
+    trackedVector<Vector3, MEMORY_TESSELLATION>().swap(mesh.normals);
+}
+
+void dequantizeMesh(const QuantizedMesh& mesh, Mesh& out)
+{
+    const unsigned int count = mesh.vertexCount();
+    out.positions.resize(count);
+    for (unsigned int i = 0 ; i < count ; ++i)
+    {
+        double restored[3];
+        for (int a = 0 ; a < 3 ; ++a)
+            restored[a] = mesh.offset[a] + mesh.scale[a] * mesh.positions[3 * i + a] / QUANTIZE_RANGE;
+        out.positions[i] = Point3(restored[0], restored[1], restored[2]);
+    }
+
+    //Normals come back out of the scale they were stored in
+    out.normals.resize(mesh.normals.empty() ? 0 : count);
+    for (unsigned int i = 0 ; i < out.normals.size() ; ++i)
+    {
+        Vector3 normal(mesh.normals[3 * i] / mesh.scale[0], mesh.normals[3 * i + 1] / mesh.scale[1],
+                       mesh.normals[3 * i + 2] / mesh.scale[2]);
+        out.normals[i] = normal / normal.length();
+    }
+    out.indices.assign(mesh.indices, mesh.indices + mesh.indexCount);
+}
+
+void quantizeActive(Mesh& mesh)
+{
+    replaceWithQuantized(mesh, active);
+    activeValid = true;
+}
+
+///////////////////////////////////////////////////////////
+//Quantized copy of a mesh, made once per set of arrays
+///////////////////////////////////////////////////////////
+const QuantizedMesh& quantizedFor(const MeshView& mesh, bool* changed)
+{
+    const QuantizedMesh* found = NULL;
+
+    //The active mesh's copy is known by its indices, its positions being gone
+    if (activeValid && mesh.indices == active.indices && mesh.indexCount == active.indexCount)
+        found = &active;
+    for (std::list<cachedQuantized>::iterator c = cache.begin() ; found == NULL && c != cache.end() ; ++c)
+        if (c->source.positions == mesh.positions && c->source.indices == mesh.indices &&
+            c->source.vertexCount == mesh.vertexCount && c->source.indexCount == mesh.indexCount)
+        {
+            cache.splice(cache.begin(), cache, c);
+            found = &cache.front().quantized;
+        }
+
+    //Anything not kept is quantized, pushing out the copy drawn longest ago
+    if (found == NULL)
+    {
+        if (cache.size() >= QUANTIZE_CACHE_MESHES)
+            cache.pop_back();
+        cache.push_front(cachedQuantized());
+        cache.front().source = mesh;
+        quantizeMesh(mesh, cache.front().quantized);
+        found = &cache.front().quantized;
+    }
+
+    if (changed != NULL)
+        *changed = found != last;
+    last = found;
+    return *found;
+}
+
+void forgetQuantized()
+{
+    activeValid = false;
+    active.positions.clear();
+    active.normals.clear();
+    cache.clear();
+    last = NULL;
+}
+
+const QuantizedMesh* currentQuantized()
+{
+    return last;
+}
+
+///////////////////////////////////////////////////////////
+//Draw a quantized mesh
+///////////////////////////////////////////////////////////
+void drawQuantizedMesh(const QuantizedMesh& mesh, const TriangleRun* runs, unsigned int runCount, bool lit)
+{
+    if (mesh.indexCount == 0)
+        return;
+
+    //The fixed function pipeline takes GL_SHORT coordinates as plain
+    //integers, so the normalization (divide by QUANTIZE_RANGE) is folded
+    //into the scale and applied with the offset by the modelview matrix
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glTranslated(mesh.offset[0], mesh.offset[1], mesh.offset[2]);
+    glScaled(mesh.scale[0] / QUANTIZE_RANGE, mesh.scale[1] / QUANTIZE_RANGE, mesh.scale[2] / QUANTIZE_RANGE);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_SHORT, 0, &mesh.positions[0]);
+    if (lit && !mesh.normals.empty())
+    {
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_SHORT, 0, &mesh.normals[0]);
+    }
+    if (runs == NULL)
+        glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, mesh.indices);
+    else
+        for (unsigned int run = 0 ; run < runCount ; ++run)
+            glDrawElements(GL_TRIANGLES, 3 * runs[run].count, GL_UNSIGNED_INT, mesh.indices + 3 * runs[run].first);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    glPopMatrix();
+}
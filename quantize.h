@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////
+//
+// File:  quantize.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the compact vertex
+//               format, which stores each coordinate as a 16 bit
+//               normalized integer plus a per mesh scale and offset.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __QUANTIZE_H__
+#define __QUANTIZE_H__
+
+#include <vector>
+#include "mesh.h"
+
+// Largest magnitude of a 16 bit normalized coordinate
+#define QUANTIZE_RANGE 32767
+
+// Quantized copies kept besides the active mesh's: one per proxy level,
+// with room for the clusters' reordering of one of them
+#define QUANTIZE_CACHE_MESHES 4
+
+// A mesh whose vertex i, axis a lies at
+//     offset[a] + scale[a] * positions[3 * i + a] / QUANTIZE_RANGE
+// and whose normals, if it has them, are stored already multiplied by the
+// scale (and normalized to 16 bits), so that the scale the modelview
+// matrix applies to the positions turns them back.  The indices are the
+// quantized mesh's own, not a copy.
+struct QuantizedMesh
+{
+    trackedVector<short, MEMORY_DRAW> positions;
+    trackedVector<short, MEMORY_DRAW> normals;
+    const unsigned int* indices;
+    unsigned int indexCount;
+    double offset[3];
+    double scale[3];
+
+    // Farthest a vertex can move (half a step on every axis), and the
+    // farthest any vertex actually ended up from where the generator put it
+    double errorBound;
+    double maxError;
+
+    unsigned int vertexCount() const { return positions.size() / 3; }
+};
+
+// Quantize a mesh, fitting the scale and offset to its bounding box; out
+// shares the mesh's indices
+void quantizeMesh(const MeshView& mesh, QuantizedMesh& out);
+
+// Quantize a mesh and free its positions and normals, leaving the 16 bit
+// copy as all there is of its vertices
+void replaceWithQuantized(Mesh& mesh, QuantizedMesh& out);
+
+// Copy a quantized mesh back out to doubles
+void dequantizeMesh(const QuantizedMesh& mesh, Mesh& out);
+
+// Replace the active mesh's vertices with their 16 bit copy, which
+// quantizedFor() then gives for any view of its indices
+void quantizeActive(Mesh& mesh);
+
+// Quantized copy of a mesh, made the first time it is asked for and kept
+// while it is one of the last few drawn (changed, if given, says whether
+// it is a different copy than the last one given); forgetQuantized()
+// drops them all, the active mesh's included, when their arrays are
+// rewritten
+const QuantizedMesh& quantizedFor(const MeshView& mesh, bool* changed = NULL);
+void forgetQuantized();
+
+// The quantized mesh drawn last, or NULL if there is none
+const QuantizedMesh* currentQuantized();
+
+// Draw a quantized mesh straight from its 16 bit coordinates, or only the
+// given runs of its triangles if runs is not NULL, lighting it with its
+// normals if lit
+void drawQuantizedMesh(const QuantizedMesh& mesh, const TriangleRun* runs = NULL, unsigned int runCount = 0,
+                       bool lit = false);
+
+#endif
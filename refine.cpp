@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////
+//
+// File:  refine.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for progressive
+//               refinement.  Proxies are the requested tessellation
+//               divided by 8, 4 and 2 (one less subdivision each for the
+//               sphere), generated the first time they are needed and kept
+//               until the requested tessellation changes.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <map>
+#include "resources.h"
+#include "refine.h"
+#include "mesh.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+// Proxy meshes keyed by rendering, primary and secondary tessellation,
+// and the tessellation they are proxies of
+typedef std::pair<short, std::pair<int, int> > proxyKey;
+static std::map<proxyKey, Mesh> proxies;
+static proxyKey proxiesOf(-1, std::make_pair(0, 0));
+
+// Time of the last rotation input, in GLUT_ELAPSED_TIME milliseconds
+static int lastInteraction;
+
+// Proxy level being drawn, REFINE_PROXY_LEVELS meaning full tessellation
+static int refineStep = REFINE_PROXY_LEVELS;
+
+// Whether the refinement timer is already queued
+static bool timerPending = false;
+
+///////////////////////////////////////////////////////////
+//Timer callback stepping the refinement once input is idle
+///////////////////////////////////////////////////////////
+static void refineTimer(int value)
+{
+    timerPending = false;
+
+    //Still rotating, check again later
+    int idle = glutGet(GLUT_ELAPSED_TIME) - lastInteraction;
+    if (mouseDown || idle < REFINE_IDLE_MS)
+    {
+        timerPending = true;
+        glutTimerFunc(mouseDown ? REFINE_IDLE_MS : REFINE_IDLE_MS - idle, refineTimer, 0);
+        return;
+    }
+
+    //Move one level closer to the requested tessellation
+    refineStep++;
+    glutSetWindow(tessWindow);
+    glutPostRedisplay();
+
+    if (refineStep < REFINE_PROXY_LEVELS)
+    {
+        timerPending = true;
+        glutTimerFunc(REFINE_STEP_MS, refineTimer, 0);
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Drop back to the coarsest proxy while the shape is rotated
+///////////////////////////////////////////////////////////
+void noteInteraction()
+{
+    if (!progressiveRefinement)
+        return;
+
+    lastInteraction = glutGet(GLUT_ELAPSED_TIME);
+    refineStep = 0;
+
+    if (!timerPending)
+    {
+        timerPending = true;
+        glutTimerFunc(REFINE_IDLE_MS, refineTimer, 0);
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Tessellation of the proxy at a refinement step
+///////////////////////////////////////////////////////////
+static proxyKey proxyFor(short rendering, int primary, int secondary, int step)
+{
+    //Each level doubles the tessellation of the one before it
+    int levelsBelowFull = REFINE_PROXY_LEVELS - step;
+    int proxyPrimary;
+    int proxySecondary = std::max(TESSELLATION_MIN, secondary >> levelsBelowFull);
+
+    if (rendering == RENDERING_SPH)
+    {
+        //Every sphere subdivision already quadruples the triangles
+        proxyPrimary = std::max(TESSELLATION_MIN, primary - levelsBelowFull);
+    }
+    else
+    {
+        proxyPrimary = std::max(TESSELLATION_MIN, primary >> levelsBelowFull);
+
+        //Rings need at least 3 sectors
+        if ((rendering == RENDERING_CYL || rendering == RENDERING_CONE) && proxyPrimary < 3)
+            proxyPrimary = std::min(3, primary);
+    }
+
+    return proxyKey(rendering, std::make_pair(proxyPrimary, proxySecondary));
+}
+
+///////////////////////////////////////////////////////////
+//Drop the proxies of an earlier tessellation that are not proxies of this
+//one too
+///////////////////////////////////////////////////////////
+static void keepProxiesOf(short rendering, int primary, int secondary)
+{
+    proxyKey full(rendering, std::make_pair(primary, secondary));
+    if (full == proxiesOf)
+        return;
+    proxiesOf = full;
+
+    //The quantized copies and clusters of the old proxies were dropped with
+    //the old tessellation's, so nothing still points into these
+    for (std::map<proxyKey, Mesh>::iterator p = proxies.begin() ; p != proxies.end() ; )
+    {
+        bool wanted = false;
+        for (int step = 0 ; step < REFINE_PROXY_LEVELS ; ++step)
+            wanted = wanted || p->first == proxyFor(rendering, primary, secondary, step);
+        if (wanted)
+            ++p;
+        else
+            proxies.erase(p++);
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Find (or generate) the proxy for the current refinement step
+///////////////////////////////////////////////////////////
+const Mesh* refinementProxy(short rendering, int primary, int secondary)
+{
+    if (refineStep >= REFINE_PROXY_LEVELS)
+        return NULL;
+
+    //Nothing coarser exists, draw the real thing
+    proxyKey key = proxyFor(rendering, primary, secondary, refineStep);
+    if (key.second.first == primary && key.second.second == secondary)
+        return NULL;
+
+    keepProxiesOf(rendering, primary, secondary);
+    std::map<proxyKey, Mesh>::iterator found = proxies.find(key);
+    if (found == proxies.end())
+    {
+        found = proxies.insert(std::make_pair(key, Mesh())).first;
+        generateMesh(rendering, key.second.first, key.second.second, found->second);
+    }
+
+    return &found->second;
+}
@@ -0,0 +1,28 @@
+////////////////////////////////////////////////////////////
+//
+// File:  refine.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for progressive
+//               refinement, which draws a coarse proxy of the active
+//               shape while it is being rotated and steps back up to the
+//               requested tessellation once input goes idle.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __REFINE_H__
+#define __REFINE_H__
+
+#include <vector>
+#include "mesh.h"
+
+// Record that the user is rotating the shape (mouse drag or arrow key)
+void noteInteraction();
+
+// Mesh to draw in place of the full tessellation, or NULL once refinement
+// has reached the requested tessellation
+const Mesh* refinementProxy(short rendering, int primary, int secondary);
+
+#endif
@@ -12,191 +12,208 @@
 ////////////////////////////////////////////////////////////
 
 #include<cmath> // for trig
-#define PI 3.14159
+#include<algorithm>
+#include<climits>
+#include<cstddef>
 #include "resources.h"
+#include "shapes.h"
+#include "tasks.h"
+#include "trace.h"
 
 // addTriangle definition will be resolved by the tessellation.o object at link time
-extern void addTriangle(Point3 p1, Point3 p2, Point3 p3);
+extern void addTriangle(Point3 p1, Point3 p2, Point3 p3, Vector3 n1, Vector3 n2, Vector3 n3);
 
 // Window title
 const char* PROJECT_NAME = "Project 2 - Tessellation (Matthew MacEwan)";
 
-static void cubeFace(int n, Point3 ur, Point3 ul, Point3 bl);
+// the generators fill whatever mesh meshSink points at
+struct sinkBuilder {
+	template <class Surface>
+	void surface(const Surface& s, int rows, int cols, unsigned int options) {
+		TRACE_SPAN("surface");
+		tessellateSurface(s, rows, cols, options, *meshSink);
+	}
+	void triangle(Point3 p1, Point3 p2, Point3 p3, Vector3 n1, Vector3 n2, Vector3 n3) {
+		addTriangle(p1, p2, p3, n1, n2, n3);
+	}
+};
+
 void Cube(int n){
 	// Your Cube code goes here
-	// The order matters to determine which diagonal the squares are divided on
-	// front face
-	cubeFace(n, Point3(0.5,0.5,0.5), Point3(-0.5,0.5,0.5), Point3(-0.5,-0.5,0.5));
-	// rear face
-	cubeFace(n, Point3(-0.5,0.5,-0.5), Point3(0.5,0.5,-0.5), Point3(0.5,-0.5,-0.5));
-	// top face
-	cubeFace(n, Point3(-0.5,0.5,-0.5), Point3(-0.5,0.5,0.5), Point3(0.5,0.5,0.5));
-	// bottom face
-	cubeFace(n, Point3(0.5,-0.5,-0.5), Point3(0.5,-0.5,0.5), Point3(-0.5,-0.5,0.5));
-	// left face
-	cubeFace(n, Point3(-0.5,-0.5,0.5), Point3(-0.5,0.5,0.5), Point3(-0.5,0.5,-0.5));
-	// right face
-	cubeFace(n, Point3(0.5,-0.5,-0.5), Point3(0.5,0.5,-0.5), Point3(0.5,0.5,0.5));
+	sinkBuilder out;
+	buildCube(n, out);
 	return;
 }
 
-// Draw a single face of a cube given boundary points
-// Note that the vertex ul will be a part of just one triangle.
-static void cubeFace(int n, Point3 ur, Point3 ul, Point3 bl) {
-	float step = 1.0 / n;
-	// iterate over rows
-	for (int i = 0; i < n; i++) {
-		// iterate over columns
-		for (int j = 0; j < n; j++) {
-			Point3 a(ul + (j * step) * (ur - ul) + (i * step) * (bl - ul));
-			Point3 b(a + step * (bl - ul));
-			Point3 d(a + step * (ur - ul));
-			Point3 c(d + step * (bl - ul));
-			addTriangle(a, b, d);
-			addTriangle(b, c, d);
-		}
-	}
-}
-
 void Cone(int n, int m){
 	// Your Cone code goes here
-	if (n < 3) {
-		// This is nonsense
-		return;
-	}
-	float circlestep = 2.0 * PI / n;
-	float edgestep = 1.0 / m;
-	for (int a=0; a < n; a++) {
-		float pX = 0.5 * cos(a*circlestep);
-		float pZ = 0.5 * sin(a*circlestep);
-		float qX = 0.5 * cos((a+1)*circlestep);
-		float qZ = 0.5 * sin((a+1)*circlestep);
-		Point3 apex(0,0.5,0);
-		Point3 botP(pX, -0.5, pZ);
-		Point3 botQ(qX, -0.5, qZ);
-
-		// base sector
-		addTriangle(apex,apex + edgestep * (botQ-apex), apex + edgestep * (botP-apex));
-		// cap triangle
-		addTriangle(Point3(0,-0.5,0),botP,botQ);
-		// tesselate remaining trapezoids
-		for (int i=1; i < m; i++) {
-			Point3 a(apex + (i * edgestep) * (botQ - apex));
-			Point3 b(a + edgestep * (botQ - apex));
-			Point3 d(apex + (i * edgestep) * (botP - apex));
-			Point3 c(d + edgestep * (botP - apex));
-			addTriangle(a, c, d);
-			addTriangle(a, b, c);
-		}
-	}
+	sinkBuilder out;
+	buildCone(n, m, out);
 	return;
 }
 
 void Cylinder(int n, int m){
 	// Your Cylinder code goes here
-	if (n < 3) {
-		// This is nonsense
-		return;
+	sinkBuilder out;
+	buildCylinder(n, m, out);
+	return;
+}
+
+// where the sphere's triangles go: triangle t of the sphere has vertices
+// 3t to 3t + 2, counted from base, and indices 3t to 3t + 2
+struct sphereSlots {
+	Point3* positions;
+	Vector3* normals;
+	unsigned int* indices;
+	unsigned int base;
+};
+
+// writes a subtree's triangles into the slots from next on, the way
+// addTriangle would append them
+struct slotBuilder {
+	sphereSlots slots;
+	unsigned int next;
+	void triangle(Point3 p1, Point3 p2, Point3 p3, Vector3 n1, Vector3 n2, Vector3 n3) {
+		unsigned int v = 3 * next++;
+		slots.positions[v] = p1;
+		slots.positions[v + 1] = p2;
+		slots.positions[v + 2] = p3;
+		slots.normals[v] = n1;
+		slots.normals[v + 1] = n2;
+		slots.normals[v + 2] = n3;
+		slots.indices[v] = slots.base + v;
+		slots.indices[v + 1] = slots.base + v + 1;
+		slots.indices[v + 2] = slots.base + v + 2;
 	}
-	float circlestep = 2.0 * PI / n;
-	float edgestep = 1.0 / m;
-	for (int a=0; a < n; a++) {
-		float pX = 0.5 * cos(a*circlestep);
-		float pZ = 0.5 * sin(a*circlestep);
-		float qX = 0.5 * cos((a+1)*circlestep);
-		float qZ = 0.5 * sin((a+1)*circlestep);
-		Point3 topP(pX, 0.5, pZ);
-		Point3 topQ(qX, 0.5, qZ);
-		Point3 botP(pX, -0.5, pZ);
-		Point3 botQ(qX, -0.5, qZ);
-
-		// top and bottom sectors, respectively
-		addTriangle(Point3(0,0.5,0),topQ,topP);
-		addTriangle(Point3(0,-0.5,0),botP,botQ);
-		// tesselate side quad-strips
-		for (int i=0; i < m; i++) {
-			Point3 a(topQ + (i * edgestep) * (botQ - topQ));
-			Point3 b(a + edgestep * (botQ - topQ));
-			Point3 d(a + (topP - topQ));
-			Point3 c(d + edgestep * (botQ - topQ));
-			addTriangle(a, b, c);
-			addTriangle(a, c, d);
+};
+
+// subdivide the subtree whose first triangle is slot first as a task,
+// which splits into four more tasks until spawnDepth runs out
+static void spawnSubdivision(TaskGroup& group, const sphereSlots& slots, const Vector3 corner[3],
+                             int n, unsigned int first, int spawnDepth) {
+	Vector3 a = corner[0], b = corner[1], c = corner[2];
+	group.spawn([&group, slots, a, b, c, n, first, spawnDepth] {
+		if (spawnDepth == 0) {
+			TRACE_SPAN("sphere task");
+			slotBuilder out = { slots, first };
+			subdivideTri(a, b, c, n, out);
+			return;
+		}
+		Vector3 child[4][3];
+		subdivideChildren(a, b, c, child);
+		for (int k = 0; k < 4; k++) {
+			spawnSubdivision(group, slots, child[k], n - 1, first + k * subdividedTriangles(n - 1), spawnDepth - 1);
 		}
+	});
+}
+
+void Sphere(int n){
+	// Your Sphere code goes here
+	// (buildSphere's recursion, split into tasks writing to fixed slots,
+	// so the mesh is the same whichever thread runs which subtree)
+	Vector3 v[12];
+	icosahedron(v);
+
+	// the slots are sized up front, so a depth whose sizes would not fit
+	// the 32 bit indices is refused before anything is counted
+	Mesh& mesh = *meshSink;
+	if (n > SPHERE_MAX_DEPTH) {
+		return;
+	}
+	const std::size_t perRoot = subdividedTriangles(n);
+	const std::size_t vertices = 60 * perRoot;
+	if (mesh.positions.size() > UINT_MAX - vertices || mesh.indices.size() > UINT_MAX - vertices) {
+		return;
 	}
+	const unsigned int firstIndex = mesh.indices.size();
+	sphereSlots slots;
+	slots.base = mesh.positions.size();
+	mesh.positions.resize(slots.base + vertices);
+	mesh.normals.resize(slots.base + vertices);
+	mesh.indices.resize(firstIndex + vertices);
+	slots.positions = &mesh.positions[slots.base];
+	slots.normals = &mesh.normals[slots.base];
+	slots.indices = &mesh.indices[firstIndex];
+
+	// split the roots until there are enough tasks to go round, but no
+	// further than subtrees worth a task each
+	int spawnDepth = 0;
+	while ((20u << (2 * spawnDepth)) < unsigned(taskWorkers() * TASKS_PER_WORKER) &&
+	       (perRoot >> (2 * (spawnDepth + 1))) >= SPHERE_TASK_MIN_TRIANGLES) {
+		spawnDepth++;
+	}
+
+	TaskGroup group;
+	for (int f = 0; f < 20; f++) {
+		const Vector3 corner[3] = { v[icosahedronFaces[f][0]], v[icosahedronFaces[f][1]], v[icosahedronFaces[f][2]] };
+		spawnSubdivision(group, slots, corner, n, f * perRoot, spawnDepth);
+	}
+	group.wait();
 	return;
 }
 
-// recursively subdivide triangles to depth n for sphere rendering
-// of radius 0.5
-// Triangle vertices specified as offsets from origin
-static void subdivideTri(Vector3 a, Vector3 b, Vector3 c, int n) {
-	// base case
+// Chordal tolerance: each shape works out the smallest tessellation whose
+// flat triangles stay within tolerance of the true surface, and returns
+// the deviation that tessellation actually achieves.
+
+// The cube is exactly flat, so one square per face is already exact
+double CubeTolerance(int& n) {
+	n = 1;
+	return 0.0;
+}
+
+// A chord across a ring of radius 0.5 with n sectors bulges in by its
+// sagitta, 0.5 * (1 - cos(pi / n)).  The sides are straight, so m = 1.
+static double ringTolerance(double tolerance, int& n, int& m) {
+	double halfAngle = acos(std::max(-1.0, 1.0 - tolerance / 0.5));
+	n = (int)ceil(M_PI / halfAngle);
+	n = std::max(3, std::min(TESSELLATION_MAX, n));
+	m = 1;
+	return 0.5 * (1 - cos(M_PI / n));
+}
+
+double CylinderTolerance(double tolerance, int& n, int& m) {
+	return ringTolerance(tolerance, n, m);
+}
+
+// The cone's flat side triangles deviate most at the base ring, by the
+// same sagitta as the cylinder
+double ConeTolerance(double tolerance, int& n, int& m) {
+	return ringTolerance(tolerance, n, m);
+}
+
+// mirror subdivideTri, returning how far inside the sphere the flattest
+// leaf triangle's plane passes
+static double subdivideError(Vector3 a, Vector3 b, Vector3 c, int n) {
 	if (n <= 1) {
-		Point3 o(0,0,0);	// origin
 		a.normalize();
-		a *= 0.5;
 		b.normalize();
-		b *= 0.5;
 		c.normalize();
-		c *= 0.5;
-		addTriangle(o+a, o+b, o+c);
-		return;
+		Vector3 normal((b - a) ^ (c - a));
+		normal.normalize();
+		return 0.5 - 0.5 * fabs(normal * a);
 	}
-	// calculate directions to edge midpoints
-	// don't normalize, that'll get taken care of at the bottom of recursion
-	Vector3 mab(a+b);
-	//mab.normalize();
-	mab *= 0.5;
-	Vector3 mbc(b+c);
-	//mbc.normalize();
-	mbc *= 0.5;
-	Vector3 mac(a+c);
-	//mac.normalize();
-	mac *= 0.5;
-	// subdivide!
-	subdivideTri(a, mab, mac, n-1);
-	subdivideTri(mab, b, mbc, n-1);
-	subdivideTri(mac, mbc, c, n-1);
-	subdivideTri(mbc, mac, mab, n-1);
+	Vector3 mab((a+b) * 0.5);
+	Vector3 mbc((b+c) * 0.5);
+	Vector3 mac((a+c) * 0.5);
+	return std::max(std::max(subdivideError(a, mab, mac, n-1), subdivideError(mab, b, mbc, n-1)),
+	                std::max(subdivideError(mac, mbc, c, n-1), subdivideError(mbc, mac, mab, n-1)));
 }
 
-void Sphere(int n){
-	// Your Sphere code goes here
-	// icosahedron vertices as per notes
-	float a = 2.0 / (1 + sqrt(5));
-	Vector3 v0(0, a, -1);
-	Vector3 v1(-a, 1, 0);
-	Vector3 v2(a, 1, 0);
-	Vector3 v3(0, a, 1);
-	Vector3 v4(-1, 0, a);
-	Vector3 v5(0, -a, 1);
-	Vector3 v6(1, 0, a);
-	Vector3 v7(1, 0, -a);
-	Vector3 v8(0, -a, -1);
-	Vector3 v9(-1,0,-a);
-	Vector3 v10(-a, -1, 0);
-	Vector3 v11(a, -1, 0);
-
-	// create triangles
-	subdivideTri(v0, v1, v2, n);
-	subdivideTri(v3, v2, v1, n);
-	subdivideTri(v3, v4, v5, n);
-	subdivideTri(v3, v5, v6, n);
-	subdivideTri(v0, v7, v8, n);
-	subdivideTri(v0, v8, v9, n);
-	subdivideTri(v5, v10, v11, n);
-	subdivideTri(v8, v11, v10, n);
-	subdivideTri(v1, v9, v4, n);
-	subdivideTri(v10, v4, v9, n);
-	subdivideTri(v2, v6, v7, n);
-	subdivideTri(v11, v7, v6, n);
-	subdivideTri(v3, v1, v4, n);
-	subdivideTri(v3, v6, v2, n);
-	subdivideTri(v0, v9, v1, n);
-	subdivideTri(v0, v2, v7, n);
-	subdivideTri(v8, v10, v9, n);
-	subdivideTri(v8, v7, v11, n);
-	subdivideTri(v5, v4, v10, n);
-	subdivideTri(v5, v11, v6, n);
-	return;
+// Sphere deviation by depth, measured once on first use
+double SphereTolerance(double tolerance, int& n) {
+	static double depthError[SPHERE_TOLERANCE_MAX_DEPTH + 1];
+	Vector3 v[12];
+	icosahedron(v);
+	for (n = 1; n <= SPHERE_TOLERANCE_MAX_DEPTH; n++) {
+		if (depthError[n] == 0) {
+			for (int f = 0; f < 20; f++) {
+				depthError[n] = std::max(depthError[n],
+					subdivideError(v[icosahedronFaces[f][0]], v[icosahedronFaces[f][1]], v[icosahedronFaces[f][2]], n));
+			}
+		}
+		if (depthError[n] <= tolerance || n == SPHERE_TOLERANCE_MAX_DEPTH)
+			break;
+	}
+	return depthError[n];
 }
@@ -0,0 +1,565 @@
+////////////////////////////////////////////////////////////
+//
+// File:  replay.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for recording and
+//               replaying a session's input.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "resources.h"
+#include "input.h"
+#include "mesh.h"
+#include "coalesce.h"
+#include "replay.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+// Window reshape callback, defined in the tessellation.o object
+extern void changeSize(int w, int h);
+
+// One logged event; window is 0, 1 or 2 for the main, tessellation and
+// status windows, since GLUT's window ids are its own business
+struct replayEvent
+{
+    double time;
+    int type;
+    int window;
+    int args[4];
+};
+
+static const char* eventNames[REPLAY_EVENT_TYPES] = { "key", "special", "mouse", "motion", "reshape", "hover" };
+
+// Recording
+static FILE* recordFile = NULL;
+static std::chrono::steady_clock::time_point recordStart;
+
+// A timer set while replaying, due at a time on the replay clock; order
+// breaks ties between timers due together in the order they were set
+struct replayTimer
+{
+    double due;
+    unsigned int order;
+    void (*callback)(int);
+    int value;
+};
+
+// A tessellation build asked for while replaying
+struct replayBuild
+{
+    double time;
+    int rendering;
+    int primary;
+    int secondary;
+};
+
+// Replay.  The replay clock is the recorded time of the event or timer
+// last handled, so timers fire between the same events whatever the speed.
+static std::vector<replayEvent> replayEvents;
+static unsigned int nextEvent = 0;
+static bool replayMaxSpeed;
+static bool replayActive = false;
+static std::chrono::steady_clock::time_point replayStart;
+static std::vector<double> frameTimes;
+static std::vector<replayTimer> replayTimers;
+static unsigned int timersSet = 0;
+static double replayClock = 0.0;
+static std::vector<replayBuild> builds;
+
+///////////////////////////////////////////////////////////
+//Milliseconds since a start time
+///////////////////////////////////////////////////////////
+static double since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+///////////////////////////////////////////////////////////
+//Close the log, writing out what is buffered
+///////////////////////////////////////////////////////////
+static void stopRecording()
+{
+    if (recordFile != NULL)
+        fclose(recordFile);
+    recordFile = NULL;
+}
+
+///////////////////////////////////////////////////////////
+//Start logging events
+///////////////////////////////////////////////////////////
+bool startRecording(const char* path)
+{
+    recordFile = fopen(path, "w");
+    if (recordFile == NULL)
+        return false;
+
+    fprintf(recordFile, "# tessellation session: milliseconds, event, window, arguments\n");
+    recordStart = std::chrono::steady_clock::now();
+    atexit(stopRecording);
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//Log an event arriving in the current window
+///////////////////////////////////////////////////////////
+void recordEvent(int type, int a, int b, int c, int d)
+{
+    if (recordFile == NULL)
+        return;
+
+    int current = glutGetWindow();
+    int window = current == tessWindow ? 1 : current == statusWindow ? 2 : 0;
+    fprintf(recordFile, "%.3f %s %d %d %d %d %d\n", since(recordStart), eventNames[type], window, a, b, c, d);
+}
+
+///////////////////////////////////////////////////////////
+//Call the handler an event was logged from
+///////////////////////////////////////////////////////////
+static void dispatch(const replayEvent& event)
+{
+    const int windows[3] = { mainWindow, tessWindow, statusWindow };
+    glutSetWindow(windows[event.window]);
+
+    const int* a = event.args;
+    switch (event.type)
+    {
+    case REPLAY_KEYBOARD:
+        input((unsigned char)a[0], a[1], a[2]);  break;
+    case REPLAY_SPECIAL:
+        specialInput(a[0], a[1], a[2]);  break;
+    case REPLAY_MOUSE:
+        mouseInput(a[0], a[1], a[2], a[3]);  break;
+    case REPLAY_MOTION:
+        mouseMovement(a[0], a[1]);  break;
+    case REPLAY_RESHAPE:
+        //Resize the real window; GLUT calls changeSize as it did when recording
+        glutSetWindow(mainWindow);
+        glutReshapeWindow(a[0], a[1]);
+        break;
+    case REPLAY_HOVER:
+        mouseHover(a[0], a[1]);  break;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Hash of the builds so far, for comparing replays
+///////////////////////////////////////////////////////////
+static unsigned long long buildHash()
+{
+    //FNV-1a over each build's microsecond and level
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned int i = 0 ; i < builds.size() ; ++i)
+    {
+        long long fields[4] = { (long long)(builds[i].time * 1000.0 + 0.5), builds[i].rendering,
+                                builds[i].primary, builds[i].secondary };
+        for (int field = 0 ; field < 4 ; ++field)
+            for (int byte = 0 ; byte < 8 ; ++byte)
+                hash = (hash ^ ((unsigned long long)fields[field] >> (8 * byte) & 0xff)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+///////////////////////////////////////////////////////////
+//Print the frame times of the replay
+///////////////////////////////////////////////////////////
+static void replayReport()
+{
+    if (!replayActive)
+        return;
+    replayActive = false;
+
+    double elapsed = since(replayStart);
+    printf("Replayed %u of %u events in %.1f ms (%s)\n", nextEvent, (unsigned int)replayEvents.size(), elapsed,
+           replayMaxSpeed ? "maximum speed" : "recorded speed");
+    printf("%u tessellation builds, sequence %016llx\n", (unsigned int)builds.size(), buildHash());
+    if (frameTimes.empty())
+    {
+        printf("No tessellation window frames were drawn\n");
+        return;
+    }
+
+    std::vector<double> sorted(frameTimes);
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (unsigned int i = 0 ; i < sorted.size() ; ++i)
+        total += sorted[i];
+    printf("%u frames, %.1f per second; frame ms mean %.3f, p50 %.3f, p99 %.3f, max %.3f\n",
+           (unsigned int)sorted.size(), 1000.0 * sorted.size() / elapsed, total / sorted.size(),
+           sorted[sorted.size() / 2], sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)], sorted.back());
+}
+
+///////////////////////////////////////////////////////////
+//Step through the log: each step fires the earliest timer due by the
+//next event, or else dispatches that event
+///////////////////////////////////////////////////////////
+static int dueTimer()
+{
+    //Timers are few, at most one per request still settling
+    int due = -1;
+    for (unsigned int i = 0 ; i < replayTimers.size() ; ++i)
+        if (due < 0 || replayTimers[i].due < replayTimers[due].due ||
+            (replayTimers[i].due == replayTimers[due].due && replayTimers[i].order < replayTimers[due].order))
+            due = i;
+
+    if (due >= 0 && nextEvent < replayEvents.size() && replayTimers[due].due > replayEvents[nextEvent].time)
+        return -1;
+    return due;
+}
+
+static double nextStepTime()
+{
+    int timer = dueTimer();
+    if (timer >= 0)
+        return replayTimers[timer].due;
+    return nextEvent < replayEvents.size() ? replayEvents[nextEvent].time : replayClock;
+}
+
+// Returns false once every event has been dispatched and every timer fired
+static bool replayStep(void (*handle)(const replayEvent&))
+{
+    int timer = dueTimer();
+    if (timer >= 0)
+    {
+        replayTimer fired = replayTimers[timer];
+        replayTimers.erase(replayTimers.begin() + timer);
+        replayClock = std::max(replayClock, fired.due);
+        fired.callback(fired.value);
+        return true;
+    }
+
+    if (nextEvent == replayEvents.size())
+        return false;
+    replayClock = std::max(replayClock, replayEvents[nextEvent].time);
+    handle(replayEvents[nextEvent++]);
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//Feed the log to the handlers, one step per pass of the main loop so that
+//every step's frame is drawn before the next one at either speed
+///////////////////////////////////////////////////////////
+static void finishReplay()
+{
+    //The frame times are printed by replayReport as the program exits
+    glutIdleFunc(NULL);
+    exit(0);
+}
+
+static void resumeReplay(int value);
+
+static void replayIdle()
+{
+    //Frames posted by the last step were drawn before idle was called; at
+    //the recorded speed, sleep in a timer until the next step is due
+    if (!replayMaxSpeed)
+    {
+        double wait = nextStepTime() - since(replayStart);
+        if (wait > 0.0)
+        {
+            glutIdleFunc(NULL);
+            glutTimerFunc((unsigned int)ceil(wait), resumeReplay, 0);
+            return;
+        }
+    }
+
+    if (!replayStep(dispatch))
+        finishReplay();
+}
+
+static void resumeReplay(int value)
+{
+    glutIdleFunc(replayIdle);
+}
+
+///////////////////////////////////////////////////////////
+//Read a log's events; returns false if it cannot be read
+///////////////////////////////////////////////////////////
+static bool loadReplay(const char* path)
+{
+    FILE* in = fopen(path, "r");
+    if (in == NULL)
+        return false;
+
+    char line[256];
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        if (line[0] == '#')
+            continue;
+
+        replayEvent event;
+        char name[16];
+        if (sscanf(line, "%lf %15s %d %d %d %d %d", &event.time, name, &event.window,
+                   &event.args[0], &event.args[1], &event.args[2], &event.args[3]) != 7)
+            continue;
+        for (event.type = 0 ; event.type < REPLAY_EVENT_TYPES ; ++event.type)
+            if (strcmp(name, eventNames[event.type]) == 0)
+                break;
+        if (event.type == REPLAY_EVENT_TYPES || event.window < 0 || event.window > 2)
+            continue;
+        replayEvents.push_back(event);
+    }
+    fclose(in);
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//Load a log and start replaying it
+///////////////////////////////////////////////////////////
+bool startReplay(const char* path, bool maxSpeed)
+{
+    if (!loadReplay(path))
+        return false;
+
+    replayMaxSpeed = maxSpeed;
+    replayActive = true;
+    replayStart = std::chrono::steady_clock::now();
+    atexit(replayReport);
+
+    //Starts once the main loop is running
+    glutIdleFunc(replayIdle);
+    return true;
+}
+
+bool replaying()
+{
+    return replayActive;
+}
+
+///////////////////////////////////////////////////////////
+//Note a tessellation window frame
+///////////////////////////////////////////////////////////
+void noteReplayFrame(double milliseconds)
+{
+    frameTimes.push_back(milliseconds);
+}
+
+///////////////////////////////////////////////////////////
+//Note a tessellation build
+///////////////////////////////////////////////////////////
+void noteReplayBuild()
+{
+    replayBuild build = { replayClock, activeRendering, renderings[activeRendering].primaryTessellation,
+                          renderings[activeRendering].secondaryTessellation };
+    builds.push_back(build);
+}
+
+///////////////////////////////////////////////////////////
+//The session's clock and timers
+///////////////////////////////////////////////////////////
+int sessionTime()
+{
+    return replayActive ? int(replayClock) : glutGet(GLUT_ELAPSED_TIME);
+}
+
+void sessionTimer(unsigned int milliseconds, void (*callback)(int), int value)
+{
+    if (!replayActive)
+    {
+        glutTimerFunc(milliseconds, callback, value);
+        return;
+    }
+
+    replayTimer timer = { replayClock + milliseconds, timersSet++, callback, value };
+    replayTimers.push_back(timer);
+}
+
+///////////////////////////////////////////////////////////
+//Replay without windows, handling only the keys that change the
+//tessellation and the arrows that rotate, and standing in for each frame
+//after every step
+///////////////////////////////////////////////////////////
+#define REPLAY_REPORT_SLOW_FRAME_MS 20
+
+static void windowlessDispatch(const replayEvent& event)
+{
+    shapeState& shape = renderings[activeRendering];
+    if (event.type == REPLAY_KEYBOARD)
+    {
+        switch (event.args[0])
+        {
+        case '+':
+            if (shape.primaryTessellation < maxPrimaryTessellation(activeRendering))
+            {
+                shape.primaryTessellation++;
+                requestTessellation();
+            }
+            break;
+        case '-':
+            if (shape.primaryTessellation > TESSELLATION_MIN)
+            {
+                shape.primaryTessellation--;
+                requestTessellation();
+            }
+            break;
+        case ']':
+            if (shape.secondaryTessellation < TESSELLATION_MAX)
+            {
+                shape.secondaryTessellation++;
+                requestTessellation();
+            }
+            break;
+        case '[':
+            if (shape.secondaryTessellation > TESSELLATION_MIN)
+            {
+                shape.secondaryTessellation--;
+                requestTessellation();
+            }
+            break;
+        }
+    }
+    else if (event.type == REPLAY_SPECIAL)
+    {
+        switch (event.args[0])
+        {
+        case GLUT_KEY_DOWN: queueRotation(ARROW_MOVE_FACTOR, 0);  break;
+        case GLUT_KEY_UP: queueRotation(-ARROW_MOVE_FACTOR, 0);  break;
+        case GLUT_KEY_LEFT: queueRotation(0, -ARROW_MOVE_FACTOR);  break;
+        case GLUT_KEY_RIGHT: queueRotation(0, ARROW_MOVE_FACTOR);  break;
+        }
+    }
+}
+
+// Replay the loaded events from the start, drawing nothing; a slow replay
+// keeps to the recorded times and takes a slow frame after every step
+static void windowlessReplay(bool slow, double& xRotation, double& yRotation)
+{
+    shapeState saved[4];
+    std::copy(renderings, renderings + 4, saved);
+
+    nextEvent = 0;
+    replayClock = 0.0;
+    replayTimers.clear();
+    builds.clear();
+    replayStart = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        if (slow)
+        {
+            double wait = nextStepTime() - since(replayStart);
+            if (wait > 0.0)
+                std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(wait));
+        }
+        if (!replayStep(windowlessDispatch))
+            break;
+
+        //The frame takes up the rotation queued since the one before
+        applyQueuedRotation();
+        if (slow)
+            std::this_thread::sleep_for(std::chrono::milliseconds(REPLAY_REPORT_SLOW_FRAME_MS));
+    }
+
+    xRotation = renderings[activeRendering].xRotation;
+    yRotation = renderings[activeRendering].yRotation;
+    std::copy(saved, saved + 4, renderings);
+}
+
+///////////////////////////////////////////////////////////
+//Built in session: bursts of tessellation keys quicker and slower than the
+//debounce, longer than the latency bound, and arrow key repeats
+///////////////////////////////////////////////////////////
+static void builtInSession()
+{
+    // Key, whether it is a special key, presses, milliseconds between them
+    // and the pause after the last
+    const int bursts[][5] =
+    {
+        { '+', 0, 12, 30, 300 },
+        { ']', 0, 5, 120, 200 },
+        { GLUT_KEY_RIGHT, 1, 30, 10, 100 },
+        { '+', 0, 4, 50, 40 },
+        { GLUT_KEY_DOWN, 1, 20, 15, 0 },
+        { '-', 0, 9, 70, 150 },
+        { '[', 0, 3, 20, 0 },
+    };
+
+    double time = 0.0;
+    for (unsigned int burst = 0 ; burst < sizeof(bursts) / sizeof(bursts[0]) ; ++burst)
+    {
+        for (int press = 0 ; press < bursts[burst][2] ; ++press)
+        {
+            replayEvent event = { time, bursts[burst][1] ? REPLAY_SPECIAL : REPLAY_KEYBOARD, 1, { bursts[burst][0], 0, 0, 0 } };
+            replayEvents.push_back(event);
+            time += bursts[burst][3];
+        }
+        time += bursts[burst][4];
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Replay a session as fast as possible and again at the recorded times with
+//slow frames, and check both build the same tessellations at the same
+//points on the replay clock
+///////////////////////////////////////////////////////////
+int replayDeterminismReport(const char* path)
+{
+    if (path != NULL)
+    {
+        if (!loadReplay(path))
+        {
+            fprintf(stderr, "Could not read %s\n", path);
+            return 1;
+        }
+    }
+    else
+        builtInSession();
+    if (replayEvents.empty())
+    {
+        printf("No events to replay\n");
+        return 1;
+    }
+
+    replayActive = true;
+    double fastX, fastY, slowX, slowY;
+    windowlessReplay(false, fastX, fastY);
+    std::vector<replayBuild> fastBuilds(builds);
+    unsigned long long fastHash = buildHash();
+    double fastMs = since(replayStart);
+    windowlessReplay(true, slowX, slowY);
+    double slowMs = since(replayStart);
+    replayActive = false;
+
+    printf("%u events over %.0f ms of replay clock (debounce %d ms, latency bound %d ms)\n",
+           (unsigned int)replayEvents.size(), replayEvents.back().time, debounceMs, maxLatencyMs);
+    printf("Maximum speed:                %3u builds, sequence %016llx, %8.1f ms\n",
+           (unsigned int)fastBuilds.size(), fastHash, fastMs);
+    printf("Recorded speed, %2d ms frames: %3u builds, sequence %016llx, %8.1f ms\n",
+           REPLAY_REPORT_SLOW_FRAME_MS, (unsigned int)builds.size(), buildHash(), slowMs);
+    for (unsigned int i = 0 ; i < fastBuilds.size() ; ++i)
+        printf("  build at %8.1f ms: shape %d, %d x %d\n", fastBuilds[i].time, fastBuilds[i].rendering + 1,
+               fastBuilds[i].primary, fastBuilds[i].secondary);
+
+    int failures = 0;
+    if (fastBuilds.size() != builds.size() || fastHash != buildHash())
+    {
+        printf("BUILD SEQUENCES DIFFER\n");
+        failures++;
+    }
+    if (fastX != slowX || fastY != slowY)
+    {
+        printf("ROTATIONS DIFFER: %.2f, %.2f against %.2f, %.2f\n", fastX, fastY, slowX, slowY);
+        failures++;
+    }
+    if (fastBuilds.empty())
+    {
+        printf("NOTHING WAS BUILT\n");
+        failures++;
+    }
+    if (failures == 0)
+        printf("Both replays built the same tessellations at the same replay times\n");
+    return failures;
+}
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////
+//
+// File:  replay.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for recording a session's
+//               input and replaying it, for repeatable performance runs.
+//
+//               Each input callback and changeSize log their arguments,
+//               the window they arrived in and the time since recording
+//               started, one event per line.  A replay feeds the log back
+//               through the same handlers, either at the recorded times
+//               or as fast as frames can be drawn, then prints the
+//               tessellation window's frame times and exits.
+//
+//               While replaying, time is the replay clock: the recorded
+//               time of the event or timer last handled.  Timers set
+//               through sessionTimer fire on it, between the same events
+//               at either speed, and each event or timer gets a pass of
+//               the main loop to itself, so a replay builds the same
+//               tessellations at the same points however fast it runs.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+// Kinds of logged event
+#define REPLAY_KEYBOARD 0
+#define REPLAY_SPECIAL 1
+#define REPLAY_MOUSE 2
+#define REPLAY_MOTION 3
+#define REPLAY_RESHAPE 4
+#define REPLAY_HOVER 5
+#define REPLAY_EVENT_TYPES 6
+
+// Log every event from now on to path; returns false if it cannot be written
+bool startRecording(const char* path);
+
+// Log an event arriving in the current window, if recording
+void recordEvent(int type, int a, int b, int c = 0, int d = 0);
+
+// Load a log and start feeding it to the handlers once the main loop runs,
+// as fast as possible or at the recorded times; returns false if the log
+// cannot be read
+bool startReplay(const char* path, bool maxSpeed);
+
+// Is true while a log is being replayed
+bool replaying();
+
+// Note a tessellation window frame that took the given time to draw
+void noteReplayFrame(double milliseconds);
+
+// Note a tessellation build asked for at the current replay time
+void noteReplayBuild();
+
+// Milliseconds on the session's clock: GLUT_ELAPSED_TIME, or the replay
+// clock while replaying
+int sessionTime();
+
+// Call callback with value once milliseconds have passed on the session's
+// clock, as glutTimerFunc does
+void sessionTimer(unsigned int milliseconds, void (*callback)(int), int value);
+
+// Replay the log at path, or a built in session if path is NULL, twice
+// without windows: as fast as possible and at the recorded times with slow
+// frames.  Returns the number of ways the two differ in what they built
+int replayDeterminismReport(const char* path);
+
+#endif
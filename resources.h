@@ -18,6 +18,7 @@
 #include <string>
 #include <vector>
 #include "vecmath.h"
+#include "mesh.h"
 
 
 //******************************************
@@ -45,8 +46,57 @@
 
 // Misc needed numerics.
 #define TESSELLATION_MAX 150
+
+// Deepest sphere subdivision generated: 20 * 4^10 triangles, whose
+// unshared vertices take about 3 GB, and whose sizes all fit the 32 bit
+// indices; deeper ones are refused rather than clamped by the generator
+#define SPHERE_MAX_DEPTH 11
 #define TESSELLATION_MIN 1
 
+// How the tessellation of the active rendering is chosen
+#define TESS_MODE_MANUAL 0
+#define TESS_MODE_AUTO_LOD 1
+#define TESS_MODE_TOLERANCE 2
+
+// Automatic level of detail: shortest on-screen edge and deepest sphere kept
+#define LOD_PIXELS_PER_EDGE 8
+#define LOD_SPHERE_MAX_DEPTH 7
+
+// Chordal tolerance mode: starting, tightest and loosest allowed deviation
+// from the true surface, and the deepest sphere subdivision considered
+#define TOLERANCE_INIT 0.01
+#define TOLERANCE_MIN 0.0001
+#define TOLERANCE_MAX 0.25
+#define SPHERE_TOLERANCE_MAX_DEPTH 9
+
+// Progressive refinement: proxies below the requested tessellation, the idle
+// time before refining starts and the time between refinement steps
+#define REFINE_PROXY_LEVELS 3
+#define REFINE_IDLE_MS 150
+#define REFINE_STEP_MS 60
+
+// Tessellation changes: quiet time before the last requested level is built,
+// and the longest a held key can keep putting it off
+#define DEBOUNCE_MS 80
+#define DEBOUNCE_MAX_LATENCY_MS 250
+
+// Meshes baked in at compile time: largest primary and secondary
+// tessellation of the cube, cylinder and cone, and deepest sphere
+#define BAKE_MAX_TESSELLATION 8
+#define BAKE_SPHERE_MAX_DEPTH 4
+
+// Most ULPs the generators' sine and cosine may be from the C library's,
+// checked by --verify-baked at every angle of rings of up to
+// BAKE_LIBM_COLUMNS columns
+#define BAKE_LIBM_MAX_ULPS 4
+#define BAKE_LIBM_COLUMNS 1024
+
+// Fewest triangles of a sphere's subdivision worth a task of their own
+#define SPHERE_TASK_MIN_TRIANGLES 1024
+
+// Distance from the eye to the shape's center in the tessellation window
+#define CAMERA_DISTANCE 2.75
+
 // Rendering selection button attributes
 #define RENDERING_BUTT_TOP_RED   .58
 #define RENDERING_BUTT_TOP_GREEN .87
@@ -61,6 +111,21 @@
 // Tweaking variables that you probably won't want to modify
 //******************************************
 
+// What changed since the windows were last drawn, passed to markDirty();
+// the tessellation window shows rotation, tessellation and shape, the
+// status window everything but rotation
+#define DIRTY_ROTATION     1
+#define DIRTY_TESSELLATION 2
+#define DIRTY_SHAPE        4
+#define DIRTY_TEXT         8
+#define DIRTY_HELP         16
+#define DIRTY_MODE         32
+#define DIRTY_LATENCY      64
+#define DIRTY_PICK         128
+#define DIRTY_ALL          255
+#define DIRTY_TESS_WINDOW   (DIRTY_ROTATION | DIRTY_TESSELLATION | DIRTY_SHAPE | DIRTY_PICK)
+#define DIRTY_STATUS_WINDOW (DIRTY_TESSELLATION | DIRTY_SHAPE | DIRTY_TEXT | DIRTY_HELP | DIRTY_MODE | DIRTY_LATENCY | DIRTY_PICK)
+
 // Keys
 #define BACKSPACE 8
 #define ENTER 13
@@ -92,6 +157,10 @@
 #define HELP_BUTTON_TEXT_Y_OFFSET 35
 #define HELP_TEXT_WORD_OFFSET 5
 #define HELP_TEXT_DEF_OFFSET  150
+#define HELP_MODE_COLUMN_OFFSET 250
+#define HELP_MODE_DEF_OFFSET 40
+#define INFO_TEXT_X 380
+#define INFO_TEXT_SPACING 15
 #define TESS_FIELD_X 225
 
 // Field boarders (effects)
@@ -119,12 +188,20 @@
 #define GRAY_D 0.7, 0.7, 0.7
 #define GRAY_BUTT_TOP_D 0.6, 0.6, 0.6
 #define YELLOW_D 1.0, 1.0, 0.0
+#define RED_D 1.0, 0.0, 0.0
+#define BLUE_D 0.0, 0.0, 1.0
+
+// Solid shading: the shape's color, and a light over the viewer's right
+// shoulder that stays put as the shape turns
+#define SOLID_SHAPE_D 0.55, 0.65, 0.85
+#define SOLID_LIGHT_DIRECTION 1.0f, 1.0f, 1.0f, 0.0f
+#define SOLID_AMBIENT 0.2f, 0.2f, 0.2f, 1.0f
 
 // Some structs to define common 'objects' to use, and keep track
 // of the active state
 struct textField
 {
-    std::string buttonText;
+    uiString buttonText;
     bool active;
     int x;
     int y;
@@ -158,8 +235,11 @@ extern textField fields[2];
 // Keeps track of the current rendering state
 extern shapeState renderings[4];
 
-// Keeps track of the active verticies for what is in the tessellation window
-extern std::vector<Point3> vertices;
+// Keeps track of the active mesh for what is in the tessellation window
+extern Mesh activeMesh;
+
+// The full tessellation of the active rendering, in activeMesh or baked
+extern MeshView activeView;
 
 // Flag as to whether or not the active rendering needs to be redrawn
 extern bool tessChange;
@@ -173,4 +253,46 @@ extern short activeRendering;
 // Is true if the help screen is up, false otherwise
 extern bool helpActive;
 
+// How the tessellation is chosen (TESS_MODE_MANUAL, etc.)
+extern short tessMode;
+
+// Largest deviation from the true surface allowed in tolerance mode
+extern double chordTolerance;
+
+// Is true if a coarse proxy is drawn while the shape is being rotated
+extern bool progressiveRefinement;
+
+// Is true if the shape is drawn from 16 bit quantized vertices
+extern bool quantizedVertices;
+
+// Is true if clusters facing away from the eye are not drawn
+extern bool coneCulling;
+
+// Is true if the triangle and vertex under the cursor are picked
+extern bool picking;
+
+// Is true if the shape is drawn filled and lit with the generators'
+// normals instead of as a wireframe
+extern bool solidShading;
+
+// Is true if the tessellation window shows the instanced stress scene
+// instead of the active shape, and the number of instances in it
+extern bool sceneMode;
+extern int sceneInstances;
+
+// Is true if the status window shows the input to display latencies
+extern bool latencyHud;
+
+// Is true if the status window shows the memory held by each category
+extern bool memoryHud;
+
+// Milliseconds a tessellation change waits for the next one, and the most
+// it waits in total (--debounce-ms and --max-latency-ms)
+extern int debounceMs;
+extern int maxLatencyMs;
+
+// Is true if the neighbours of each level built are generated while idle
+// (off with --no-speculate)
+extern bool speculation;
+
 #endif
@@ -0,0 +1,264 @@
+////////////////////////////////////////////////////////////
+//
+// File:  scene.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the instanced
+//               stress scene.  The frustum planes are read straight out of
+//               the product of the projection and modelview matrices, so
+//               culling always agrees with whatever camera and rotation
+//               the frame set up.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include "scene.h"
+#include "baked.h"
+#include "parametric.h"
+#include "trace.h"
+#if defined(__APPLE__) && defined(__MACH__)
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
+// Primary and secondary tessellations of each shape in the scene, coarse
+// to fine; the coarser ones are baked in
+static const int sceneLevels[4][SCENE_LEVELS][2] =
+{
+    { { 1, 1 }, { 2, 1 }, { 4, 1 }, { 8, 1 } },
+    { { 8, 2 }, { 16, 4 }, { 32, 8 }, { 64, 16 } },
+    { { 8, 2 }, { 16, 4 }, { 32, 8 }, { 64, 16 } },
+    { { 1, 1 }, { 2, 1 }, { 3, 1 }, { 5, 1 } }
+};
+
+// The cached scene
+static Scene cached;
+static bool cacheValid = false;
+
+// The last frame's drawing
+static sceneFrameStats lastFrame;
+
+///////////////////////////////////////////////////////////
+//Next number in [0, 1) of a splitmix sequence
+///////////////////////////////////////////////////////////
+static double sceneRandom(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= z >> 31;
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+///////////////////////////////////////////////////////////
+//Column major transform scaling by scale, turning by the given angles
+//about x, y then z, and moving to (x, y, z)
+///////////////////////////////////////////////////////////
+static void instanceTransform(double scale, const double angles[3], double x, double y, double z, float* m)
+{
+    double cx = cos(angles[0]), sx = sin(angles[0]);
+    double cy = cos(angles[1]), sy = sin(angles[1]);
+    double cz = cos(angles[2]), sz = sin(angles[2]);
+
+    //Columns of Rz Ry Rx
+    double r[9] =
+    {
+        cy * cz, cy * sz, -sy,
+        sx * sy * cz - cx * sz, sx * sy * sz + cx * cz, sx * cy,
+        cx * sy * cz + sx * sz, cx * sy * sz - sx * cz, cx * cy
+    };
+    for (int column = 0 ; column < 3 ; ++column)
+    {
+        for (int row = 0 ; row < 3 ; ++row)
+            m[4 * column + row] = float(scale * r[3 * column + row]);
+        m[4 * column + 3] = 0.0f;
+    }
+    m[12] = float(x);
+    m[13] = float(y);
+    m[14] = float(z);
+    m[15] = 1.0f;
+}
+
+///////////////////////////////////////////////////////////
+//Scatter the instances of every shape and tessellation
+///////////////////////////////////////////////////////////
+void buildScene(unsigned int instances, Scene& out)
+{
+    TRACE_SPAN("scene");
+
+    //Each shape and tessellation is generated once, after the list is
+    //complete so the views are not left pointing at moved meshes
+    if (out.lists != 0)
+        glDeleteLists(out.lists, out.meshes.size());
+    out.lists = 0;
+    out.meshes.clear();
+    out.meshes.resize(4 * SCENE_LEVELS);
+    for (unsigned int m = 0 ; m < out.meshes.size() ; ++m)
+    {
+        SceneMesh& mesh = out.meshes[m];
+        mesh.rendering = m / SCENE_LEVELS;
+        mesh.primaryTessellation = sceneLevels[mesh.rendering][m % SCENE_LEVELS][0];
+        mesh.secondaryTessellation = sceneLevels[mesh.rendering][m % SCENE_LEVELS][1];
+        if (!findBakedMesh(mesh.rendering, mesh.primaryTessellation, mesh.secondaryTessellation, mesh.view))
+        {
+            generateMesh(mesh.rendering, mesh.primaryTessellation, mesh.secondaryTessellation, mesh.mesh);
+            mesh.view = mesh.mesh;
+        }
+
+        //The shapes are all about the origin
+        double radius = 0.0;
+        for (unsigned int v = 0 ; v < mesh.view.vertexCount ; ++v)
+            radius = std::max(radius, mesh.view.positions[v].distanceTo(Point3(0, 0, 0)));
+        mesh.radius = float(radius);
+    }
+
+    //Pick every instance's mesh first, so the instances can be laid out
+    //mesh by mesh
+    uint64_t state = SCENE_SEED;
+    std::vector<unsigned int> meshOf(instances);
+    out.first.assign(out.meshes.size() + 1, 0);
+    for (unsigned int i = 0 ; i < instances ; ++i)
+    {
+        meshOf[i] = std::min((unsigned int)(sceneRandom(state) * out.meshes.size()), (unsigned int)out.meshes.size() - 1);
+        ++out.first[meshOf[i] + 1];
+    }
+    for (unsigned int m = 0 ; m < out.meshes.size() ; ++m)
+        out.first[m + 1] += out.first[m];
+
+    out.transforms.resize(16 * instances);
+    out.bounds.resize(4 * instances);
+    out.visible.assign(instances, 0);
+    std::vector<unsigned int> next(out.first.begin(), out.first.end() - 1);
+    for (unsigned int i = 0 ; i < instances ; ++i)
+    {
+        unsigned int slot = next[meshOf[i]]++;
+        double scale = SCENE_MIN_SCALE + (SCENE_MAX_SCALE - SCENE_MIN_SCALE) * sceneRandom(state);
+        double angles[3];
+        for (int a = 0 ; a < 3 ; ++a)
+            angles[a] = 2.0 * M_PI * sceneRandom(state);
+        double position[3];
+        for (int a = 0 ; a < 3 ; ++a)
+            position[a] = SCENE_EXTENT * (2.0 * sceneRandom(state) - 1.0);
+
+        instanceTransform(scale, angles, position[0], position[1], position[2], &out.transforms[16 * slot]);
+        float* bound = &out.bounds[4 * slot];
+        bound[0] = float(position[0]);
+        bound[1] = float(position[1]);
+        bound[2] = float(position[2]);
+        bound[3] = float(scale) * out.meshes[meshOf[i]].radius;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Scene of a size, scattered once
+///////////////////////////////////////////////////////////
+Scene& sceneFor(unsigned int instances)
+{
+    if (!cacheValid || cached.instanceCount() != instances)
+    {
+        buildScene(instances, cached);
+        cacheValid = true;
+    }
+    return cached;
+}
+
+///////////////////////////////////////////////////////////
+//Cull and draw the scene
+///////////////////////////////////////////////////////////
+const sceneFrameStats& drawScene(Scene& scene)
+{
+    TRACE_SPAN("scene");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const unsigned int instances = scene.instanceCount();
+
+    //Clip space is projection x modelview; a point is inside when each
+    //of w + x, w - x, w + y, w - y, w + z and w - z is positive
+    double projection[16], modelview[16], clip[16];
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    for (int column = 0 ; column < 4 ; ++column)
+        for (int row = 0 ; row < 4 ; ++row)
+        {
+            clip[4 * column + row] = 0.0;
+            for (int k = 0 ; k < 4 ; ++k)
+                clip[4 * column + row] += projection[4 * k + row] * modelview[4 * column + k];
+        }
+    float planes[6][4];
+    for (int p = 0 ; p < 6 ; ++p)
+    {
+        int axis = p / 2;
+        double sign = (p % 2 == 0) ? 1.0 : -1.0;
+        double plane[4], length = 0.0;
+        for (int k = 0 ; k < 4 ; ++k)
+            plane[k] = clip[4 * k + 3] + sign * clip[4 * k + axis];
+        for (int k = 0 ; k < 3 ; ++k)
+            length += plane[k] * plane[k];
+        length = sqrt(length);
+        for (int k = 0 ; k < 4 ; ++k)
+            planes[p][k] = float(plane[k] / length);
+    }
+
+    //Every instance is tested on its own, so the array is split across
+    //threads with no sharing but the flags they write
+    const float* bounds = scene.bounds.data();
+    unsigned char* visible = scene.visible.data();
+    parallelRows(instances, SCENE_CULL_WEIGHT, [&](int first, int end)
+    {
+        TRACE_SPAN("frustum cull");
+        for (int i = first ; i < end ; ++i)
+        {
+            const float* bound = bounds + 4 * i;
+            bool inside = true;
+            for (int p = 0 ; p < 6 && inside ; ++p)
+                inside = planes[p][0] * bound[0] + planes[p][1] * bound[1] + planes[p][2] * bound[2] +
+                         planes[p][3] > -bound[3];
+            visible[i] = inside;
+        }
+    });
+    std::chrono::steady_clock::time_point culled = std::chrono::steady_clock::now();
+
+    //Each mesh's vertices are handed over once, into its display list, and
+    //only the matrix changes between its instances
+    sceneFrameStats stats = { instances, 0, 0.0, 0.0, 0.0 };
+    if (scene.lists == 0)
+    {
+        scene.lists = glGenLists(scene.meshes.size());
+        for (unsigned int m = 0 ; m < scene.meshes.size() ; ++m)
+        {
+            glNewList(scene.lists + m, GL_COMPILE);
+            drawMesh(scene.meshes[m].view);
+            glEndList();
+        }
+    }
+    for (unsigned int m = 0 ; m < scene.meshes.size() ; ++m)
+    {
+        const MeshView& mesh = scene.meshes[m].view;
+        for (unsigned int i = scene.first[m] ; i < scene.first[m + 1] ; ++i)
+        {
+            if (!visible[i])
+                continue;
+            glPushMatrix();
+            glMultMatrixf(&scene.transforms[16 * i]);
+            glCallList(scene.lists + m);
+            glPopMatrix();
+            ++stats.drawnInstances;
+            stats.triangles += mesh.triangleCount();
+        }
+    }
+
+    stats.cullMs = std::chrono::duration<double, std::milli>(culled - start).count();
+    stats.submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - culled).count();
+    lastFrame = stats;
+    return lastFrame;
+}
+
+const sceneFrameStats& lastSceneFrame()
+{
+    return lastFrame;
+}
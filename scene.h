@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////
+//
+// File:  scene.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the instanced stress
+//               scene, which fills the tessellation window with thousands
+//               of cubes, cylinders, cones and spheres at mixed
+//               tessellations, sizes and orientations.  Each distinct
+//               shape and tessellation is generated once and shared by
+//               every instance of it.
+//
+//               Instances are kept as flat arrays sorted by mesh: a column
+//               major transform of 16 floats and a bounding sphere of 4 per
+//               instance.  Per frame the spheres are tested against the
+//               view frustum across threads, and the survivors are drawn
+//               mesh by mesh from a display list compiled once per mesh,
+//               so an instance costs only a matrix and a list call.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __SCENE_H__
+#define __SCENE_H__
+
+#include <vector>
+#include "resources.h"
+#include "mesh.h"
+
+// Instances in the scene when no count is asked for (--scene-instances)
+#define SCENE_INSTANCES 4096
+
+// Tessellations each shape appears at
+#define SCENE_LEVELS 4
+
+// Instances are scattered through a cube this far each way from the
+// shape's center, the eye sitting inside it, at sizes between these
+#define SCENE_EXTENT 4.0
+#define SCENE_MIN_SCALE 0.1
+#define SCENE_MAX_SCALE 0.4
+
+// Seed of the scatter, so every run draws the same scene
+#define SCENE_SEED 20261019
+
+// An instance's six plane tests weigh about as much as this many grid
+// vertices when deciding whether culling is worth threads
+#define SCENE_CULL_WEIGHT 16
+
+// One shared mesh: a shape at one tessellation, and the radius of the
+// sphere about its center that holds it
+struct SceneMesh
+{
+    short rendering;
+    int primaryTessellation;
+    int secondaryTessellation;
+    Mesh mesh;                  // Empty if the tessellation is baked in
+    MeshView view;
+    float radius;
+};
+
+// Instances first[m] to first[m + 1] are of meshes[m]
+struct Scene
+{
+    std::vector<SceneMesh> meshes;
+    std::vector<unsigned int> first;
+    trackedVector<float, MEMORY_DRAW> transforms;
+    trackedVector<float, MEMORY_DRAW> bounds;
+    trackedVector<unsigned char, MEMORY_DRAW> visible;
+    unsigned int lists;         // Display list of each mesh, made on first draw
+
+    Scene() : lists(0) {}
+    unsigned int instanceCount() const { return bounds.size() / 4; }
+};
+
+// What one frame of the scene drew, and how long culling and drawing took
+struct sceneFrameStats
+{
+    unsigned int instances;
+    unsigned int drawnInstances;
+    double triangles;           // Drawn
+    double cullMs;
+    double submitMs;
+};
+
+// Scatter instances instances of every shape and tessellation into out
+void buildScene(unsigned int instances, Scene& out);
+
+// Scene of the given number of instances, reusing the last one built if
+// it was as big
+Scene& sceneFor(unsigned int instances);
+
+// Cull the scene to the current projection and modelview matrices and draw
+// what is left with the current state
+const sceneFrameStats& drawScene(Scene& scene);
+
+// What the last frame of the scene drew
+const sceneFrameStats& lastSceneFrame();
+
+#endif
@@ -0,0 +1,776 @@
+////////////////////////////////////////////////////////////
+//
+// File:  service.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the tessellation
+//               service.  Payloads are written once into a memfd through
+//               a shared mapping and then sealed against writing, growing
+//               and shrinking, so the same descriptor can be handed to any
+//               number of clients, which map it read-only.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "resources.h"
+#include "service.h"
+#include "baked.h"
+#include "compress.h"
+#include "trace.h"
+
+// A batch waiting on meshes being built; fds are duplicates of the cached
+// memfds, so the cache can drop them before the batch is answered
+struct pendingBatch
+{
+    int connection;
+    unsigned int outstanding;
+    std::vector<serviceReply> replies;
+    std::vector<int> fds;
+};
+
+// A client: whether it has a batch being built, and an answered batch
+// waiting for room in its socket; neither is read from until both are
+// done, so each holds at most one reply
+struct serviceConnection
+{
+    int fd;
+    bool building;
+    pendingBatch* unsent;
+};
+
+// What became of sending a batch
+#define SEND_DONE 0
+#define SEND_BLOCKED 1       // The client's socket is full; try again when it drains
+#define SEND_FAILED 2        // The client hung up or the socket failed
+
+// A mesh in one format, built or being built for the batches waiting on it
+struct cacheEntry
+{
+    bool ready;
+    int fd;
+    serviceReply reply;
+    unsigned long long lastUsed;
+    std::vector<std::pair<pendingBatch*, unsigned int> > waiting;
+};
+
+// Shared between the socket thread and the workers
+static std::mutex serviceLock;
+static std::condition_variable workQueued;
+static std::map<uint64_t, cacheEntry> cache;
+static std::deque<std::pair<uint64_t, serviceRequest> > jobs;
+static std::vector<pendingBatch*> answered;
+static unsigned long long cachedBytes = 0;
+static unsigned long long useClock = 0;
+static unsigned long long builds = 0;
+static bool stopping = false;
+static int wakeFd = -1;
+
+// Set by SIGINT and SIGTERM
+static volatile sig_atomic_t interrupted = 0;
+
+///////////////////////////////////////////////////////////
+//Stop serving at the next chance
+///////////////////////////////////////////////////////////
+static void interruptService(int)
+{
+    interrupted = 1;
+}
+
+///////////////////////////////////////////////////////////
+//Check a request, folding the secondary tessellation of shapes that do
+//not use it so they share a cache entry
+///////////////////////////////////////////////////////////
+static bool normalizeRequest(serviceRequest& request)
+{
+    if (request.format >= SERVICE_FORMATS || request.primary < TESSELLATION_MIN || request.secondary < TESSELLATION_MIN)
+        return false;
+    switch (request.rendering)
+    {
+    case RENDERING_CUBE:
+        request.secondary = 1;
+        return request.primary <= TESSELLATION_MAX;
+    case RENDERING_CYL:
+    case RENDERING_CONE:
+        return request.primary <= TESSELLATION_MAX && request.secondary <= TESSELLATION_MAX;
+    case RENDERING_SPH:
+        request.secondary = 1;
+        return request.primary <= SERVICE_SPHERE_MAX_DEPTH;
+    }
+    return false;
+}
+
+static uint64_t requestKey(const serviceRequest& request)
+{
+    return (uint64_t(request.rendering) << 56) | (uint64_t(request.format) << 48) |
+           (uint64_t(request.primary) << 24) | request.secondary;
+}
+
+///////////////////////////////////////////////////////////
+//Generate a mesh and seal it into a memfd in the requested format,
+//returning the descriptor or -1
+///////////////////////////////////////////////////////////
+static int buildPayload(const serviceRequest& request, serviceReply& reply)
+{
+    TRACE_SPAN("service payload");
+    Mesh generated;
+    MeshView mesh;
+    if (!findBakedMesh(request.rendering, request.primary, request.secondary, mesh))
+    {
+        generateMesh(request.rendering, request.primary, request.secondary, generated);
+        mesh = generated;
+    }
+
+    reply.status = SERVICE_FAILED;
+    reply.format = request.format;
+    reply.vertexCount = mesh.vertexCount;
+    reply.indexCount = mesh.indexCount;
+    std::vector<unsigned char> compressed;
+    if (request.format == SERVICE_FORMAT_COMPRESSED)
+    {
+        compressMesh(mesh, false, compressed);
+        reply.bytes = compressed.size();
+    }
+    else
+        reply.bytes = uint64_t(mesh.vertexCount) * (request.format == SERVICE_FORMAT_RAW ? sizeof(Point3) : 3 * sizeof(float)) +
+                      uint64_t(mesh.indexCount) * sizeof(unsigned int);
+
+    int fd = memfd_create("tessellation mesh", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+        return -1;
+    unsigned char* data = NULL;
+    if (ftruncate(fd, reply.bytes) != 0 ||
+        (data = (unsigned char*)mmap(NULL, reply.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+
+    //Everything is written straight into the shared pages
+    switch (request.format)
+    {
+    case SERVICE_FORMAT_RAW:
+        memcpy(data, mesh.positions, mesh.vertexCount * sizeof(Point3));
+        memcpy(data + mesh.vertexCount * sizeof(Point3), mesh.indices, mesh.indexCount * sizeof(unsigned int));
+        break;
+    case SERVICE_FORMAT_FLOAT:
+    {
+        float* positions = (float*)data;
+        for (unsigned int v = 0 ; v < mesh.vertexCount ; ++v)
+        {
+            positions[3 * v] = float(mesh.positions[v].x);
+            positions[3 * v + 1] = float(mesh.positions[v].y);
+            positions[3 * v + 2] = float(mesh.positions[v].z);
+        }
+        memcpy(positions + 3 * mesh.vertexCount, mesh.indices, mesh.indexCount * sizeof(unsigned int));
+        break;
+    }
+    case SERVICE_FORMAT_COMPRESSED:
+        memcpy(data, compressed.data(), compressed.size());
+        break;
+    }
+    munmap(data, reply.bytes);
+
+    //No client can change what the others see
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    reply.status = SERVICE_OK;
+    return fd;
+}
+
+///////////////////////////////////////////////////////////
+//Build queued meshes until the service stops
+///////////////////////////////////////////////////////////
+static void serviceWorker()
+{
+    while (true)
+    {
+        std::pair<uint64_t, serviceRequest> job;
+        {
+            std::unique_lock<std::mutex> lock(serviceLock);
+            workQueued.wait(lock, [] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        serviceReply reply;
+        int fd = buildPayload(job.second, reply);
+
+        {
+            std::lock_guard<std::mutex> lock(serviceLock);
+            cacheEntry& entry = cache[job.first];
+            for (unsigned int i = 0 ; i < entry.waiting.size() ; ++i)
+            {
+                pendingBatch* batch = entry.waiting[i].first;
+                batch->replies[entry.waiting[i].second] = reply;
+                batch->fds[entry.waiting[i].second] = fd >= 0 ? dup(fd) : -1;
+                if (--batch->outstanding == 0)
+                    answered.push_back(batch);
+            }
+            entry.waiting.clear();
+            ++builds;
+
+            //Failures are not cached, so asking again tries again
+            if (fd < 0)
+                cache.erase(job.first);
+            else
+            {
+                entry.ready = true;
+                entry.fd = fd;
+                entry.reply = reply;
+                cachedBytes += reply.bytes;
+            }
+        }
+
+        //Wake the socket thread to send the answered batches
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0)
+            perror("service wake");
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Send a batch's replies with the descriptors of the good ones, keeping
+//the batch if the client's socket is full
+///////////////////////////////////////////////////////////
+static int sendBatch(pendingBatch* batch)
+{
+    unsigned char message[sizeof(serviceHeader) + SERVICE_MAX_BATCH * sizeof(serviceReply)];
+    serviceHeader header = { SERVICE_MAGIC, (uint32_t)batch->replies.size() };
+    memcpy(message, &header, sizeof(header));
+    memcpy(message + sizeof(header), batch->replies.data(), batch->replies.size() * sizeof(serviceReply));
+
+    int fds[SERVICE_MAX_BATCH];
+    unsigned int fdCount = 0;
+    for (unsigned int i = 0 ; i < batch->fds.size() ; ++i)
+        if (batch->fds[i] >= 0)
+            fds[fdCount++] = batch->fds[i];
+
+    union
+    {
+        cmsghdr align;
+        char buffer[CMSG_SPACE(SERVICE_MAX_BATCH * sizeof(int))];
+    } control;
+    iovec io = { message, sizeof(header) + batch->replies.size() * sizeof(serviceReply) };
+    msghdr reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.msg_iov = &io;
+    reply.msg_iovlen = 1;
+    if (fdCount > 0)
+    {
+        reply.msg_control = control.buffer;
+        reply.msg_controllen = CMSG_SPACE(fdCount * sizeof(int));
+        cmsghdr* c = CMSG_FIRSTHDR(&reply);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(fdCount * sizeof(int));
+        memcpy(CMSG_DATA(c), fds, fdCount * sizeof(int));
+    }
+
+    //Connections do not block, so a client that does not read its replies
+    //cannot hold up the others; a packet goes whole or not at all
+    ssize_t sent = sendmsg(batch->connection, &reply, MSG_NOSIGNAL);
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return SEND_BLOCKED;
+    for (unsigned int i = 0 ; i < fdCount ; ++i)
+        close(fds[i]);
+    delete batch;
+    return sent == ssize_t(io.iov_len) ? SEND_DONE : SEND_FAILED;
+}
+
+///////////////////////////////////////////////////////////
+//Drop a connection and any reply still waiting to go to it
+///////////////////////////////////////////////////////////
+static void closeConnection(serviceConnection& connection)
+{
+    if (connection.unsent != NULL)
+    {
+        for (unsigned int i = 0 ; i < connection.unsent->fds.size() ; ++i)
+            if (connection.unsent->fds[i] >= 0)
+                close(connection.unsent->fds[i]);
+        delete connection.unsent;
+        connection.unsent = NULL;
+    }
+    close(connection.fd);
+}
+
+///////////////////////////////////////////////////////////
+//Send a connection its answered batch, or keep it until the socket has
+//room; returns false if the connection should be closed
+///////////////////////////////////////////////////////////
+static bool deliverBatch(serviceConnection& connection, pendingBatch* batch)
+{
+    connection.building = false;
+    connection.unsent = NULL;
+    switch (sendBatch(batch))
+    {
+    case SEND_BLOCKED:
+        connection.unsent = batch;
+        return true;
+    case SEND_DONE:
+        return true;
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////
+//Drop the least recently asked for meshes past the cache's size
+///////////////////////////////////////////////////////////
+static void trimCache()
+{
+    std::lock_guard<std::mutex> lock(serviceLock);
+    while (cachedBytes > SERVICE_CACHE_BYTES)
+    {
+        std::map<uint64_t, cacheEntry>::iterator oldest = cache.end();
+        for (std::map<uint64_t, cacheEntry>::iterator e = cache.begin() ; e != cache.end() ; ++e)
+            if (e->second.ready && (oldest == cache.end() || e->second.lastUsed < oldest->second.lastUsed))
+                oldest = e;
+        if (oldest == cache.end())
+            return;
+        close(oldest->second.fd);
+        cachedBytes -= oldest->second.reply.bytes;
+        cache.erase(oldest);
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Read a batch from a connection, setting ready to it if every mesh is
+//cached and it can be answered at once; returns false if the connection
+//should be closed
+///////////////////////////////////////////////////////////
+static bool readBatch(int connection, pendingBatch*& ready, unsigned long long& hits, unsigned long long& misses)
+{
+    unsigned char message[sizeof(serviceHeader) + SERVICE_MAX_BATCH * sizeof(serviceRequest)];
+    ssize_t received = recv(connection, message, sizeof(message), MSG_TRUNC);
+    serviceHeader header;
+    if (received < ssize_t(sizeof(header)))
+        return false;
+    memcpy(&header, message, sizeof(header));
+    if (header.magic != SERVICE_MAGIC || header.count == 0 || header.count > SERVICE_MAX_BATCH ||
+        received != ssize_t(sizeof(header) + header.count * sizeof(serviceRequest)))
+        return false;
+
+    pendingBatch* batch = new pendingBatch;
+    batch->connection = connection;
+    batch->outstanding = 0;
+    batch->replies.resize(header.count);
+    batch->fds.assign(header.count, -1);
+    {
+        std::lock_guard<std::mutex> lock(serviceLock);
+        for (unsigned int i = 0 ; i < header.count ; ++i)
+        {
+            serviceRequest request;
+            memcpy(&request, message + sizeof(header) + i * sizeof(serviceRequest), sizeof(request));
+            if (!normalizeRequest(request))
+            {
+                serviceReply bad = { SERVICE_BAD_REQUEST, request.format, 0, 0, 0 };
+                batch->replies[i] = bad;
+                continue;
+            }
+
+            uint64_t key = requestKey(request);
+            std::map<uint64_t, cacheEntry>::iterator found = cache.find(key);
+            if (found == cache.end())
+            {
+                found = cache.insert(std::make_pair(key, cacheEntry())).first;
+                found->second.ready = false;
+                found->second.fd = -1;
+                jobs.push_back(std::make_pair(key, request));
+                workQueued.notify_one();
+            }
+            cacheEntry& entry = found->second;
+            entry.lastUsed = ++useClock;
+            if (entry.ready)
+            {
+                ++hits;
+                batch->replies[i] = entry.reply;
+                batch->fds[i] = dup(entry.fd);
+            }
+            else
+            {
+                ++misses;
+                entry.waiting.push_back(std::make_pair(batch, i));
+                ++batch->outstanding;
+            }
+        }
+    }
+
+    ready = batch->outstanding > 0 ? NULL : batch;
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//Remove the socket at path, leaving anything that is not a socket alone
+///////////////////////////////////////////////////////////
+static void removeSocket(const char* path)
+{
+    struct stat status;
+    if (lstat(path, &status) == 0 && S_ISSOCK(status.st_mode))
+        unlink(path);
+}
+
+///////////////////////////////////////////////////////////
+//Serve meshes until interrupted
+///////////////////////////////////////////////////////////
+int runService(const char* path, int workers)
+{
+    sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Socket path %s is too long\n", path);
+        return 1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    //A socket left behind by a service that did not stop cleanly is
+    //replaced; any other file there makes the bind fail
+    int listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    removeSocket(path);
+    if (listener < 0 || bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(listener, SERVICE_MAX_CONNECTIONS) != 0)
+    {
+        perror(path);
+        return 1;
+    }
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0)
+    {
+        perror("eventfd");
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = interruptService;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (workers <= 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> pool;
+    for (int w = 0 ; w < workers ; ++w)
+        pool.push_back(std::thread(serviceWorker));
+    printf("Serving meshes on %s with %d workers\n", path, workers);
+    fflush(stdout);
+
+    std::vector<serviceConnection> connections;
+    unsigned long long batches = 0, hits = 0, misses = 0;
+    while (!interrupted)
+    {
+        //Connections with a batch being built are left out until it is
+        //answered, so nothing more is read from them and a hang up waits
+        //till then; one with a reply waiting is watched for room only
+        std::vector<pollfd> polled;
+        pollfd listening = { listener, POLLIN, 0 };
+        pollfd wake = { wakeFd, POLLIN, 0 };
+        polled.push_back(listening);
+        polled.push_back(wake);
+        for (unsigned int c = 0 ; c < connections.size() ; ++c)
+            if (!connections[c].building)
+            {
+                pollfd connection = { connections[c].fd, short(connections[c].unsent != NULL ? POLLOUT : POLLIN), 0 };
+                polled.push_back(connection);
+            }
+        if (poll(polled.data(), polled.size(), -1) < 0)
+            continue;
+
+        if (polled[1].revents & POLLIN)
+        {
+            uint64_t count;
+            if (read(wakeFd, &count, sizeof(count)) < 0)
+                perror("service wake");
+            std::vector<pendingBatch*> ready;
+            {
+                std::lock_guard<std::mutex> lock(serviceLock);
+                ready.swap(answered);
+            }
+            for (unsigned int b = 0 ; b < ready.size() ; ++b)
+                for (unsigned int c = 0 ; c < connections.size() ; ++c)
+                    if (connections[c].fd == ready[b]->connection)
+                    {
+                        if (!deliverBatch(connections[c], ready[b]))
+                        {
+                            closeConnection(connections[c]);
+                            connections.erase(connections.begin() + c);
+                        }
+                        break;
+                    }
+            trimCache();
+        }
+
+        for (unsigned int p = 2 ; p < polled.size() ; ++p)
+        {
+            if (polled[p].revents == 0)
+                continue;
+            for (unsigned int c = 0 ; c < connections.size() ; ++c)
+                if (connections[c].fd == polled[p].fd)
+                {
+                    //A reply that had no room is tried again first
+                    bool keep;
+                    if (connections[c].unsent != NULL)
+                        keep = deliverBatch(connections[c], connections[c].unsent);
+                    else
+                    {
+                        pendingBatch* ready = NULL;
+                        keep = readBatch(polled[p].fd, ready, hits, misses);
+                        if (keep)
+                        {
+                            ++batches;
+                            connections[c].building = ready == NULL;
+                            if (ready != NULL)
+                                keep = deliverBatch(connections[c], ready);
+                        }
+                    }
+                    if (!keep)
+                    {
+                        closeConnection(connections[c]);
+                        connections.erase(connections.begin() + c);
+                    }
+                    break;
+                }
+        }
+        trimCache();
+
+        if (polled[0].revents & POLLIN)
+        {
+            int connection = accept4(listener, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (connection >= 0 && connections.size() < SERVICE_MAX_CONNECTIONS)
+            {
+                serviceConnection accepted = { connection, false, NULL };
+                connections.push_back(accepted);
+            }
+            else if (connection >= 0)
+                close(connection);
+        }
+    }
+
+    //Let the workers finish what they are building and go
+    {
+        std::lock_guard<std::mutex> lock(serviceLock);
+        stopping = true;
+    }
+    workQueued.notify_all();
+    for (unsigned int w = 0 ; w < pool.size() ; ++w)
+        pool[w].join();
+    for (unsigned int c = 0 ; c < connections.size() ; ++c)
+        closeConnection(connections[c]);
+    for (std::map<uint64_t, cacheEntry>::iterator e = cache.begin() ; e != cache.end() ; ++e)
+        if (e->second.ready)
+            close(e->second.fd);
+    close(listener);
+    removeSocket(path);
+
+    printf("%llu batches, %llu meshes: %llu from the cache, %llu waiting on %llu builds\n",
+           batches, hits + misses, hits, misses, builds);
+    return 0;
+}
+
+// Most batches the report's second client sends without reading a reply,
+// how long the service has to stop taking them, and how long the first
+// client waits for its own answer meanwhile
+#define SERVICE_REPORT_FLOOD_BATCHES 65536
+#define SERVICE_REPORT_FLOOD_IDLE_MS 200
+#define SERVICE_REPORT_STALL_MS 5000
+
+// Meshes the report asks for, in every format
+struct reportLevel
+{
+    short rendering;
+    const char* name;
+    int primary;
+    int secondary;
+};
+
+static const reportLevel reportLevels[] =
+{
+    { RENDERING_CUBE, "Cube", 8, 1 },
+    { RENDERING_CUBE, "Cube", 150, 1 },
+    { RENDERING_CYL, "Cylinder", 150, 150 },
+    { RENDERING_CONE, "Cone", 150, 150 },
+    { RENDERING_SPH, "Sphere", 4, 1 },
+    { RENDERING_SPH, "Sphere", 8, 1 }
+};
+
+///////////////////////////////////////////////////////////
+//Check a payload against the generator's mesh
+///////////////////////////////////////////////////////////
+static bool payloadMatches(const serviceMesh& payload, const MeshView& mesh)
+{
+    if (payload.data == NULL || payload.reply.vertexCount != mesh.vertexCount || payload.reply.indexCount != mesh.indexCount)
+        return false;
+    switch (payload.reply.format)
+    {
+    case SERVICE_FORMAT_RAW:
+    {
+        MeshView served = serviceMeshView(payload);
+        return memcmp(served.positions, mesh.positions, mesh.vertexCount * sizeof(Point3)) == 0 &&
+               memcmp(served.indices, mesh.indices, mesh.indexCount * sizeof(unsigned int)) == 0;
+    }
+    case SERVICE_FORMAT_FLOAT:
+    {
+        const float* positions = (const float*)payload.data;
+        for (unsigned int v = 0 ; v < mesh.vertexCount ; ++v)
+            if (positions[3 * v] != float(mesh.positions[v].x) || positions[3 * v + 1] != float(mesh.positions[v].y) ||
+                positions[3 * v + 2] != float(mesh.positions[v].z))
+                return false;
+        return memcmp(positions + 3 * mesh.vertexCount, mesh.indices, mesh.indexCount * sizeof(unsigned int)) == 0;
+    }
+    case SERVICE_FORMAT_COMPRESSED:
+    {
+        //The container reorders the mesh, so only its size is compared
+        Mesh decoded;
+        return decompressMesh(payload.data, payload.reply.bytes, decoded) &&
+               decoded.positions.size() == mesh.vertexCount && decoded.indices.size() == mesh.indexCount;
+    }
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////
+//Ask the service for every report mesh cold and cached
+///////////////////////////////////////////////////////////
+int serviceReport(const char* path)
+{
+    int connection = connectService(path);
+    if (connection < 0)
+    {
+        fprintf(stderr, "No service is listening on %s\n", path);
+        return 1;
+    }
+
+    //Every level in every format, and one request that must be refused
+    const unsigned int levels = sizeof(reportLevels) / sizeof(reportLevels[0]);
+    std::vector<serviceRequest> requests;
+    for (unsigned int i = 0 ; i < levels ; ++i)
+        for (unsigned int format = 0 ; format < SERVICE_FORMATS ; ++format)
+        {
+            serviceRequest request = { (uint32_t)reportLevels[i].rendering, (uint32_t)reportLevels[i].primary,
+                                       (uint32_t)reportLevels[i].secondary, format };
+            requests.push_back(request);
+        }
+    serviceRequest bad = { RENDERING_SPH, SERVICE_SPHERE_MAX_DEPTH + 1, 1, SERVICE_FORMAT_RAW };
+    requests.push_back(bad);
+
+    const char* formats[SERVICE_FORMATS] = { "raw", "float", "compressed" };
+    std::vector<serviceMesh> payloads(requests.size());
+    double times[2];
+    int failures = 0;
+    for (int pass = 0 ; pass < 2 ; ++pass)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (!requestMeshes(connection, requests.data(), requests.size(), payloads.data()))
+        {
+            fprintf(stderr, "The service did not answer\n");
+            close(connection);
+            return 1;
+        }
+        times[pass] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (pass == 1)
+            printf("%-9s %9s %-10s %9s %10s\n", "Shape", "Level", "Format", "Triangles", "Bytes");
+        for (unsigned int i = 0 ; i < levels ; ++i)
+        {
+            const reportLevel& level = reportLevels[i];
+            Mesh generated;
+            MeshView mesh;
+            if (!findBakedMesh(level.rendering, level.primary, level.secondary, mesh))
+            {
+                generateMesh(level.rendering, level.primary, level.secondary, generated);
+                mesh = generated;
+            }
+            for (unsigned int format = 0 ; format < SERVICE_FORMATS ; ++format)
+            {
+                serviceMesh& payload = payloads[i * SERVICE_FORMATS + format];
+                bool ok = payload.reply.status == SERVICE_OK && payloadMatches(payload, mesh);
+                failures += !ok;
+                if (pass == 1)
+                {
+                    char levelText[32];
+                    sprintf(levelText, "%d x %d", level.primary, level.secondary);
+                    printf("%-9s %9s %-10s %9u %10llu%s\n", level.name, levelText, formats[format],
+                           mesh.triangleCount(), (unsigned long long)payload.reply.bytes, ok ? "" : "  WRONG");
+                }
+            }
+        }
+        if (payloads.back().reply.status != SERVICE_BAD_REQUEST)
+        {
+            printf("A sphere of depth %d was not refused\n", SERVICE_SPHERE_MAX_DEPTH + 1);
+            ++failures;
+        }
+        for (unsigned int i = 0 ; i < payloads.size() ; ++i)
+            releaseServiceMesh(payloads[i]);
+    }
+
+    //A client that sends batches without reading the replies fills its own
+    //socket; everyone else must still be answered
+    int flooding = connectService(path);
+    unsigned int flooded = 0;
+    if (flooding >= 0)
+    {
+        unsigned char message[sizeof(serviceHeader) + sizeof(serviceRequest)];
+        serviceHeader header = { SERVICE_MAGIC, 1 };
+        memcpy(message, &header, sizeof(header));
+        memcpy(message + sizeof(header), &requests[0], sizeof(serviceRequest));
+        //Until the service stops taking them, which is once its replies to
+        //this client have nowhere to go
+        int idleMs = 0;
+        while (flooded < SERVICE_REPORT_FLOOD_BATCHES && idleMs < SERVICE_REPORT_FLOOD_IDLE_MS)
+            if (send(flooding, message, sizeof(message), MSG_DONTWAIT | MSG_NOSIGNAL) > 0)
+            {
+                ++flooded;
+                idleMs = 0;
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                idleMs += 10;
+            }
+    }
+    timeval timeout = { SERVICE_REPORT_STALL_MS / 1000, (SERVICE_REPORT_STALL_MS % 1000) * 1000 };
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool answered = requestMeshes(connection, requests.data(), 1, payloads.data());
+    double stalledMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (answered)
+        releaseServiceMesh(payloads[0]);
+    else
+    {
+        printf("A client not reading its replies held up the others\n");
+        ++failures;
+    }
+    if (flooding >= 0)
+        close(flooding);
+    close(connection);
+
+    printf("Batch of %u: %.2f ms the first time, %.2f ms cached\n", (unsigned int)requests.size(), times[0], times[1]);
+    printf("Answered in %.2f ms beside a client with %u batches unread\n", stalledMs, flooded);
+    return failures;
+}
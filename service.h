@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////
+//
+// File:  service.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the tessellation
+//               service, a daemon mode that hands meshes to other local
+//               processes over the protocol in serviceclient.h.
+//
+//               One thread polls the socket and its connections.  A batch
+//               is answered from the cache where it can be; each miss is
+//               queued once, however many batches wait on it, for a pool
+//               of workers that generate, encode and seal it into a memfd.
+//               A connection is not read again until its batch has been
+//               answered, so replies come back in the order asked.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __SERVICE_H__
+#define __SERVICE_H__
+
+#include "serviceclient.h"
+
+// Largest sphere subdivision depth served
+#define SERVICE_SPHERE_MAX_DEPTH SPHERE_TOLERANCE_MAX_DEPTH
+
+// Payload bytes kept cached; past this the least recently asked for
+// meshes are dropped (clients keep the ones they have mapped)
+#define SERVICE_CACHE_BYTES (512ull << 20)
+
+// Most connections served at once
+#define SERVICE_MAX_CONNECTIONS 64
+
+// Serve meshes on the Unix socket at path with workers worker threads (0
+// for one per core) until interrupted; returns nonzero if the socket
+// could not be set up
+int runService(const char* path, int workers);
+
+// Ask the service at path for every shape in every format, twice, checking
+// the meshes against the generators and printing cold and cached times;
+// returns the number of meshes that were wrong or missing
+int serviceReport(const char* path);
+
+#endif
@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////
+//
+// File:  serviceclient.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for talking to the
+//               tessellation service.
+//
+////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "serviceclient.h"
+
+///////////////////////////////////////////////////////////
+//Connect to the service's socket
+///////////////////////////////////////////////////////////
+int connectService(const char* path)
+{
+    sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path))
+        return -1;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    int connection = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (connection < 0)
+        return -1;
+    if (connect(connection, (const sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(connection);
+        return -1;
+    }
+    return connection;
+}
+
+///////////////////////////////////////////////////////////
+//Send a batch of requests and map what comes back
+///////////////////////////////////////////////////////////
+bool requestMeshes(int socket, const serviceRequest* requests, unsigned int count, serviceMesh* out)
+{
+    if (count == 0 || count > SERVICE_MAX_BATCH)
+        return false;
+
+    unsigned char message[sizeof(serviceHeader) + SERVICE_MAX_BATCH * sizeof(serviceReply)];
+    serviceHeader header = { SERVICE_MAGIC, count };
+    memcpy(message, &header, sizeof(header));
+    memcpy(message + sizeof(header), requests, count * sizeof(serviceRequest));
+    if (send(socket, message, sizeof(header) + count * sizeof(serviceRequest), MSG_NOSIGNAL) < 0)
+        return false;
+
+    //The descriptors ride along with the replies
+    union
+    {
+        cmsghdr align;
+        char buffer[CMSG_SPACE(SERVICE_MAX_BATCH * sizeof(int))];
+    } control;
+    iovec io = { message, sizeof(message) };
+    msghdr reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.msg_iov = &io;
+    reply.msg_iovlen = 1;
+    reply.msg_control = control.buffer;
+    reply.msg_controllen = sizeof(control.buffer);
+    ssize_t received = recvmsg(socket, &reply, MSG_CMSG_CLOEXEC);
+    if (received < 0)
+        return false;
+
+    //A server sending more descriptors than replies has the extras closed
+    //here rather than written past the end of fds
+    int fds[SERVICE_MAX_BATCH];
+    unsigned int fdCount = 0;
+    bool extraFds = false;
+    for (cmsghdr* c = CMSG_FIRSTHDR(&reply) ; c != NULL ; c = CMSG_NXTHDR(&reply, c))
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS)
+        {
+            unsigned int n = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const unsigned char* data = CMSG_DATA(c);
+            for (unsigned int i = 0 ; i < n ; ++i)
+            {
+                int fd;
+                memcpy(&fd, data + i * sizeof(int), sizeof(int));
+                if (fdCount < SERVICE_MAX_BATCH)
+                    fds[fdCount++] = fd;
+                else
+                {
+                    close(fd);
+                    extraFds = true;
+                }
+            }
+        }
+
+    memcpy(&header, message, sizeof(header));
+    bool valid = received == ssize_t(sizeof(header) + count * sizeof(serviceReply)) &&
+                 !(reply.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) && !extraFds && header.magic == SERVICE_MAGIC && header.count == count;
+
+    //Each successful reply takes the next descriptor, which is closed once
+    //mapped; the mapping keeps the memfd alive
+    unsigned int nextFd = 0;
+    for (unsigned int i = 0 ; i < count ; ++i)
+    {
+        memcpy(&out[i].reply, message + sizeof(header) + i * sizeof(serviceReply), sizeof(serviceReply));
+        out[i].data = NULL;
+        if (!valid || out[i].reply.status != SERVICE_OK)
+            continue;
+        if (nextFd == fdCount)
+        {
+            valid = false;
+            continue;
+        }
+        void* data = mmap(NULL, out[i].reply.bytes, PROT_READ, MAP_SHARED, fds[nextFd++], 0);
+        if (data == MAP_FAILED)
+            out[i].reply.status = SERVICE_FAILED;
+        else
+            out[i].data = (const unsigned char*)data;
+    }
+    for (unsigned int i = 0 ; i < fdCount ; ++i)
+        close(fds[i]);
+
+    if (!valid)
+        for (unsigned int i = 0 ; i < count ; ++i)
+            releaseServiceMesh(out[i]);
+    return valid;
+}
+
+void releaseServiceMesh(serviceMesh& mesh)
+{
+    if (mesh.data != NULL)
+        munmap((void*)mesh.data, mesh.reply.bytes);
+    mesh.data = NULL;
+}
+
+///////////////////////////////////////////////////////////
+//View a raw payload as a mesh
+///////////////////////////////////////////////////////////
+MeshView serviceMeshView(const serviceMesh& mesh)
+{
+    if (mesh.data == NULL || mesh.reply.format != SERVICE_FORMAT_RAW)
+        return MeshView();
+    return MeshView((const Point3*)mesh.data, mesh.reply.vertexCount,
+                    (const unsigned int*)(mesh.data + mesh.reply.vertexCount * sizeof(Point3)), mesh.reply.indexCount);
+}
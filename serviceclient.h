@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////
+//
+// File:  serviceclient.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the protocol of the tessellation service
+//               and the declarations for talking to it, which is all a
+//               tool needs to get meshes without linking the generators.
+//
+//               The service listens on a Unix domain SOCK_SEQPACKET
+//               socket, so every message arrives whole.  A request is a
+//               serviceHeader followed by count serviceRequests.  The
+//               reply is a serviceHeader followed by count serviceReplies,
+//               one per request in order, and carries an SCM_RIGHTS file
+//               descriptor for each reply whose status is SERVICE_OK.
+//               Each descriptor is a sealed memfd holding the mesh in the
+//               requested format, shared by every client that asks for
+//               it, so the bytes are never copied through the socket.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __SERVICECLIENT_H__
+#define __SERVICECLIENT_H__
+
+#include <cstddef>
+#include <cstdint>
+#include "mesh.h"
+
+// First word of every message ("TSV1")
+#define SERVICE_MAGIC 0x31565354u
+
+// Most requests in one message; one descriptor is passed per request and
+// the kernel takes at most 253 in one message
+#define SERVICE_MAX_BATCH 64
+
+// Payload formats: the mesh's own arrays (Point3 positions then 32 bit
+// indices), the same with float positions, or a compress.h container
+#define SERVICE_FORMAT_RAW 0
+#define SERVICE_FORMAT_FLOAT 1
+#define SERVICE_FORMAT_COMPRESSED 2
+#define SERVICE_FORMATS 3
+
+// Reply status
+#define SERVICE_OK 0
+#define SERVICE_BAD_REQUEST 1     // Unknown shape or format, or tessellation out of range
+#define SERVICE_FAILED 2          // The mesh could not be built or shared
+
+struct serviceHeader
+{
+    uint32_t magic;
+    uint32_t count;
+};
+
+struct serviceRequest
+{
+    uint32_t rendering;     // RENDERING_CUBE, etc.
+    uint32_t primary;
+    uint32_t secondary;
+    uint32_t format;        // SERVICE_FORMAT_RAW, etc.
+};
+
+struct serviceReply
+{
+    uint32_t status;
+    uint32_t format;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint64_t bytes;         // Size of the payload
+};
+
+// A payload mapped read-only
+struct serviceMesh
+{
+    serviceReply reply;
+    const unsigned char* data;  // NULL unless reply.status is SERVICE_OK
+};
+
+// Connect to the service listening at path, returning the socket or -1
+int connectService(const char* path);
+
+// Send count requests as one batch and map every payload that comes back
+// into out; returns false if the exchange itself failed
+bool requestMeshes(int socket, const serviceRequest* requests, unsigned int count, serviceMesh* out);
+
+// Unmap a payload
+void releaseServiceMesh(serviceMesh& mesh);
+
+// The arrays of a payload in SERVICE_FORMAT_RAW
+MeshView serviceMeshView(const serviceMesh& mesh);
+
+#endif
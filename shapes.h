@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////
+//
+// File:  shapes.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the cube/sphere/cylinder/cone recipes,
+//			   written once against a builder so that the generators in
+//			   renderings.cpp and the meshes baked in at compile time
+//			   (baked.cpp) run exactly the same arithmetic.  A builder
+//			   provides
+//
+//			       surface(const Surface& s, int rows, int cols, unsigned options)
+//			       triangle(Point3 p1, Point3 p2, Point3 p3,
+//			                Vector3 n1, Vector3 n2, Vector3 n3)
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __SHAPES_H__
+#define __SHAPES_H__
+
+#include <cstddef>
+#include "resources.h"
+#include "parametric.h"
+
+// Flat quad spanned from corner ul towards ur (u) and bl (v), facing
+// along down x across everywhere
+struct quadSurface {
+	typedef Point3 Column;
+	Point3 ul;
+	Vector3 across, down, facing;
+	constexpr quadSurface(Point3 ur, Point3 ul_, Point3 bl)
+		: ul(ul_), across(ur - ul_), down(bl - ul_), facing(unitNormal(down ^ across)) {}
+	constexpr Point3 column(double u) const { return ul + u * across; }
+	constexpr Point3 point(const Point3& top, double v) const { return top + v * down; }
+	constexpr Vector3 normal(const Point3& top, double v) const { return facing; }
+	static constexpr Vector3 unitNormal(Vector3 n) { n.normalize(); return n; }
+};
+
+// Point on the ring of radius 0.5.  The angle runs clockwise seen from
+// above, so that with v running down the side (or out from a cap's
+// center) the triangles face out.
+struct ringColumn {
+	double x, z;
+};
+constexpr ringColumn ringAt(double u, bool clockwise) {
+	double angle = (clockwise ? -2.0 : 2.0) * M_PI * u;
+	ringColumn ring = { 0.5 * ctCos(angle), 0.5 * ctSin(angle) };
+	return ring;
+}
+
+// Straight side of the cylinder, from the top ring (v = 0) down; the
+// normal points straight out from the axis
+struct cylinderSide {
+	typedef ringColumn Column;
+	constexpr Column column(double u) const { return ringAt(u, true); }
+	constexpr Point3 point(const Column& ring, double v) const { return Point3(ring.x, 0.5 - v, ring.z); }
+	constexpr Vector3 normal(const Column& ring, double v) const { return Vector3(2 * ring.x, 0, 2 * ring.z); }
+};
+
+// Side of the cone, from the apex (v = 0) down to the base ring.  The
+// side falls 1 for every 0.5 out, so the normal is (2 * out, 1) / sqrt(5)
+// all the way down a column, the apex included; the apex is split per
+// cell (GRID_SPLIT_POLE) so each triangle there gets its own slant.
+struct coneSide {
+	typedef ringColumn Column;
+	constexpr Column column(double u) const { return ringAt(u, true); }
+	constexpr Point3 point(const Column& ring, double v) const { return Point3(v * ring.x, 0.5 - v, v * ring.z); }
+	constexpr Vector3 normal(const Column& ring, double v) const {
+		return Vector3(4 * ring.x * slant, slant, 4 * ring.z * slant);
+	}
+	static constexpr double slant = 1 / ctSqrt(5);
+};
+
+// Flat disc at height y, from its center (v = 0) out to the ring; the
+// bottom cap runs the other way around to face down
+struct capSurface {
+	typedef ringColumn Column;
+	double y;
+	constexpr capSurface(double y_) : y(y_) {}
+	constexpr Column column(double u) const { return ringAt(u, y > 0); }
+	constexpr Point3 point(const Column& ring, double v) const { return Point3(v * ring.x, y, v * ring.z); }
+	constexpr Vector3 normal(const Column& ring, double v) const { return Vector3(0, y > 0 ? 1 : -1, 0); }
+};
+
+template <class Builder>
+constexpr void buildCube(int n, Builder& out){
+	// Each face is a quad given by its upper right, upper left and bottom
+	// left corners, seen from outside
+	// front face
+	out.surface(quadSurface(Point3(0.5,0.5,0.5), Point3(-0.5,0.5,0.5), Point3(-0.5,-0.5,0.5)), n, n, 0);
+	// rear face
+	out.surface(quadSurface(Point3(-0.5,0.5,-0.5), Point3(0.5,0.5,-0.5), Point3(0.5,-0.5,-0.5)), n, n, 0);
+	// top face
+	out.surface(quadSurface(Point3(-0.5,0.5,-0.5), Point3(-0.5,0.5,0.5), Point3(0.5,0.5,0.5)), n, n, 0);
+	// bottom face
+	out.surface(quadSurface(Point3(0.5,-0.5,-0.5), Point3(0.5,-0.5,0.5), Point3(-0.5,-0.5,0.5)), n, n, 0);
+	// left face
+	out.surface(quadSurface(Point3(-0.5,-0.5,0.5), Point3(-0.5,0.5,0.5), Point3(-0.5,0.5,-0.5)), n, n, 0);
+	// right face
+	out.surface(quadSurface(Point3(0.5,-0.5,-0.5), Point3(0.5,0.5,-0.5), Point3(0.5,0.5,0.5)), n, n, 0);
+}
+
+template <class Builder>
+constexpr void buildCone(int n, int m, Builder& out){
+	if (n < 3) {
+		// This is nonsense
+		return;
+	}
+	// side, rows running from the apex to the base
+	out.surface(coneSide(), m, n, GRID_WRAP_COLUMNS | GRID_POLE_AT_TOP | GRID_SPLIT_POLE);
+	// base cap
+	out.surface(capSurface(-0.5), 1, n, GRID_WRAP_COLUMNS | GRID_POLE_AT_TOP);
+}
+
+template <class Builder>
+constexpr void buildCylinder(int n, int m, Builder& out){
+	if (n < 3) {
+		// This is nonsense
+		return;
+	}
+	// side quad-strips, rows running from top to bottom
+	out.surface(cylinderSide(), m, n, GRID_WRAP_COLUMNS);
+	// top and bottom caps, respectively
+	out.surface(capSurface(0.5), 1, n, GRID_WRAP_COLUMNS | GRID_POLE_AT_TOP);
+	out.surface(capSurface(-0.5), 1, n, GRID_WRAP_COLUMNS | GRID_POLE_AT_TOP);
+}
+
+// the four triangles a triangle is split into, in the order their
+// triangles are produced: child k's come after the 4^(n-2) of each before it
+constexpr void subdivideChildren(const Vector3& a, const Vector3& b, const Vector3& c, Vector3 child[4][3]) {
+	// calculate directions to edge midpoints
+	// don't normalize, that'll get taken care of at the bottom of recursion
+	Vector3 mab(a+b);
+	mab *= 0.5;
+	Vector3 mbc(b+c);
+	mbc *= 0.5;
+	Vector3 mac(a+c);
+	mac *= 0.5;
+	child[0][0] = a;   child[0][1] = mab; child[0][2] = mac;
+	child[1][0] = mab; child[1][1] = b;   child[1][2] = mbc;
+	child[2][0] = mac; child[2][1] = mbc; child[2][2] = c;
+	child[3][0] = mbc; child[3][1] = mac; child[3][2] = mab;
+}
+
+// triangles subdivideTri produces at depth n
+constexpr std::size_t subdividedTriangles(int n) {
+	return n <= 1 ? 1 : 4 * subdividedTriangles(n - 1);
+}
+
+// recursively subdivide triangles to depth n for sphere rendering
+// of radius 0.5
+// Triangle vertices specified as offsets from origin
+template <class Builder>
+constexpr void subdivideTri(Vector3 a, Vector3 b, Vector3 c, int n, Builder& out) {
+	// base case
+	if (n <= 1) {
+		Point3 o(0,0,0);	// origin
+		// on the unit sphere each direction is its own normal
+		a.normalize();
+		b.normalize();
+		c.normalize();
+		out.triangle(o+0.5*a, o+0.5*b, o+0.5*c, a, b, c);
+		return;
+	}
+	// subdivide!
+	Vector3 child[4][3];
+	subdivideChildren(a, b, c, child);
+	for (int k = 0; k < 4; k++) {
+		subdivideTri(child[k][0], child[k][1], child[k][2], n-1, out);
+	}
+}
+
+// icosahedron faces as indices into the vertices from icosahedron()
+constexpr int icosahedronFaces[20][3] = {
+	{0, 1, 2}, {3, 2, 1}, {3, 4, 5}, {3, 5, 6}, {0, 7, 8},
+	{0, 8, 9}, {5, 10, 11}, {8, 11, 10}, {1, 9, 4}, {10, 4, 9},
+	{2, 6, 7}, {11, 7, 6}, {3, 1, 4}, {3, 6, 2}, {0, 9, 1},
+	{0, 2, 7}, {8, 10, 9}, {8, 7, 11}, {5, 4, 10}, {5, 11, 6}
+};
+
+// icosahedron vertices as per notes
+constexpr void icosahedron(Vector3 v[12]) {
+	float a = 2.0 / (1 + ctSqrt(5));
+	v[0] = Vector3(0, a, -1);
+	v[1] = Vector3(-a, 1, 0);
+	v[2] = Vector3(a, 1, 0);
+	v[3] = Vector3(0, a, 1);
+	v[4] = Vector3(-1, 0, a);
+	v[5] = Vector3(0, -a, 1);
+	v[6] = Vector3(1, 0, a);
+	v[7] = Vector3(1, 0, -a);
+	v[8] = Vector3(0, -a, -1);
+	v[9] = Vector3(-1,0,-a);
+	v[10] = Vector3(-a, -1, 0);
+	v[11] = Vector3(a, -1, 0);
+}
+
+// one face of the icosahedron, subdivided n times
+template <class Builder>
+constexpr void buildSphereRoot(const Vector3 v[12], int f, int n, Builder& out){
+	subdivideTri(v[icosahedronFaces[f][0]], v[icosahedronFaces[f][1]], v[icosahedronFaces[f][2]], n, out);
+}
+
+template <class Builder>
+constexpr void buildSphere(int n, Builder& out){
+	Vector3 v[12];
+	icosahedron(v);
+
+	// create triangles
+	for (int f = 0; f < 20; f++) {
+		buildSphereRoot(v, f, n, out);
+	}
+}
+
+// run the recipe of the given rendering (RENDERING_CUBE, etc.)
+template <class Builder>
+constexpr void buildShape(short rendering, int n, int m, Builder& out){
+	switch (rendering) {
+	case RENDERING_CUBE:
+		buildCube(n, out);
+		break;
+	case RENDERING_CYL:
+		buildCylinder(n, m, out);
+		break;
+	case RENDERING_CONE:
+		buildCone(n, m, out);
+		break;
+	case RENDERING_SPH:
+		buildSphere(n, out);
+		break;
+	}
+}
+
+#endif
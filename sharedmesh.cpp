@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////
+//
+// File:  sharedmesh.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for reading the
+//               published mesh.  The slot sequence is read as a seqlock:
+//               once before the mesh is looked at and once after, with an
+//               acquire fence between, so a rewrite in between shows up as
+//               a changed sequence.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "sharedmesh.h"
+
+///////////////////////////////////////////////////////////
+//Map the segment read-only
+///////////////////////////////////////////////////////////
+bool openSharedMesh(const char* name, sharedMeshReader& reader)
+{
+    reader.fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    reader.base = NULL;
+    reader.mapped = 0;
+    if (reader.fd < 0)
+        return false;
+
+    struct stat status;
+    void* base = MAP_FAILED;
+    if (fstat(reader.fd, &status) == 0 && size_t(status.st_size) >= sizeof(sharedMeshHeader))
+        base = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, reader.fd, 0);
+    if (base == MAP_FAILED || ((const sharedMeshHeader*)base)->magic != SHARED_MESH_MAGIC)
+    {
+        if (base != MAP_FAILED)
+            munmap(base, status.st_size);
+        close(reader.fd);
+        reader.fd = -1;
+        return false;
+    }
+    reader.base = (const unsigned char*)base;
+    reader.mapped = status.st_size;
+    return true;
+}
+
+void closeSharedMesh(sharedMeshReader& reader)
+{
+    if (reader.base != NULL)
+        munmap((void*)reader.base, reader.mapped);
+    if (reader.fd >= 0)
+        close(reader.fd);
+    reader.base = NULL;
+    reader.fd = -1;
+}
+
+static const sharedMeshHeader& headerOf(const sharedMeshReader& reader)
+{
+    return *(const sharedMeshHeader*)reader.base;
+}
+
+uint32_t sharedMeshGeneration(const sharedMeshReader& reader)
+{
+    return headerOf(reader).generation.load(std::memory_order_acquire);
+}
+
+///////////////////////////////////////////////////////////
+//Sleep on the generation's futex
+///////////////////////////////////////////////////////////
+uint32_t waitSharedMesh(const sharedMeshReader& reader, uint32_t seen, int timeoutMs)
+{
+    const std::atomic<uint32_t>& generation = headerOf(reader).generation;
+    timespec timeout = { timeoutMs / 1000, (timeoutMs % 1000) * 1000000L };
+    uint32_t now = generation.load(std::memory_order_acquire);
+
+    //Not the private futex, since the publisher is another process; a
+    //spurious or timed out wake just returns what is there
+    if (now == seen)
+    {
+        syscall(SYS_futex, (const uint32_t*)&generation, FUTEX_WAIT, seen, timeoutMs < 0 ? NULL : &timeout, NULL, 0);
+        now = generation.load(std::memory_order_acquire);
+    }
+    return now;
+}
+
+///////////////////////////////////////////////////////////
+//Look at the latest mesh, mapping more of the segment if it grew
+///////////////////////////////////////////////////////////
+bool readSharedMesh(sharedMeshReader& reader, sharedMeshFrame& frame)
+{
+    while (true)
+    {
+        const sharedMeshHeader& header = headerOf(reader);
+        frame.generation = header.generation.load(std::memory_order_acquire);
+        if (frame.generation == 0)
+            return false;
+        frame.slot = header.active.load(std::memory_order_acquire);
+        const sharedMeshSlot& slot = header.slots[frame.slot];
+        frame.sequence = slot.sequence.load(std::memory_order_acquire);
+        if (frame.sequence & 1)
+            continue;
+
+        uint64_t end = std::max(slot.positionsOffset + uint64_t(slot.vertexCount) * sizeof(Point3),
+                                slot.indicesOffset + uint64_t(slot.indexCount) * sizeof(unsigned int));
+        if (end > reader.mapped)
+        {
+            //The publisher grew the segment for a bigger mesh, unless the
+            //slot was being rewritten as it was read
+            uint64_t size = header.segmentBytes.load(std::memory_order_acquire);
+            if (end > size)
+                continue;
+            void* base = mmap(NULL, size, PROT_READ, MAP_SHARED, reader.fd, 0);
+            if (base == MAP_FAILED)
+                return false;
+            munmap((void*)reader.base, reader.mapped);
+            reader.base = (const unsigned char*)base;
+            reader.mapped = size;
+            continue;
+        }
+
+        frame.mesh = MeshView((const Point3*)(reader.base + slot.positionsOffset), slot.vertexCount,
+                              (const unsigned int*)(reader.base + slot.indicesOffset), slot.indexCount);
+        frame.rendering = slot.rendering;
+        frame.primary = slot.primary;
+        frame.secondary = slot.secondary;
+        frame.publishedNs = slot.publishedNs;
+        if (sharedMeshStillValid(reader, frame))
+            return true;
+    }
+}
+
+bool sharedMeshStillValid(const sharedMeshReader& reader, const sharedMeshFrame& frame)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return headerOf(reader).slots[frame.slot].sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
+
+uint64_t sharedMeshClockNs()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1000000000ull + now.tv_nsec;
+}
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////
+//
+// File:  sharedmesh.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the layout of the POSIX shared memory
+//               segment the active mesh is published through, and the
+//               declarations for reading it, which is all a viewer,
+//               validator or exporter needs to link.
+//
+//               The segment starts with a sharedMeshHeader, followed by
+//               the vertex and index blocks of two slots.  The publisher
+//               builds a new mesh in the slot readers are not pointed at,
+//               then points them at it and bumps the generation, which
+//               is also the futex readers sleep on.  Each slot has its own
+//               sequence number, odd while it is being written, so a
+//               reader can tell whether the mesh it looked at was
+//               overwritten under it.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __SHAREDMESH_H__
+#define __SHAREDMESH_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "mesh.h"
+
+// First word of the segment ("TSHM")
+#define SHARED_MESH_MAGIC 0x4d485354u
+
+// Segment the tessellation window publishes to when none is named
+#define SHARED_MESH_NAME "/tessellation"
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared counters must be lock free");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "the generation must be a futex word");
+
+// One of the two meshes: Point3 positions at positionsOffset and 32 bit
+// indices at indicesOffset, both from the start of the segment and in
+// either order
+struct sharedMeshSlot
+{
+    std::atomic<uint32_t> sequence;
+    uint32_t rendering;
+    uint32_t primary;
+    uint32_t secondary;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint64_t positionsOffset;
+    uint64_t indicesOffset;
+    uint64_t publishedNs;       // CLOCK_MONOTONIC when it was published
+};
+
+struct sharedMeshHeader
+{
+    uint32_t magic;
+    uint32_t headerBytes;
+    std::atomic<uint32_t> generation;   // 0 until the first mesh
+    std::atomic<uint32_t> active;       // Slot of the latest mesh
+    std::atomic<uint64_t> segmentBytes;
+    sharedMeshSlot slots[2];
+};
+
+// A read-only mapping of a segment
+struct sharedMeshReader
+{
+    int fd;
+    const unsigned char* base;
+    size_t mapped;
+};
+
+// The latest mesh as a reader found it; the view points into the segment
+struct sharedMeshFrame
+{
+    MeshView mesh;
+    uint32_t generation;
+    uint32_t slot;
+    uint32_t sequence;
+    short rendering;
+    int primary;
+    int secondary;
+    uint64_t publishedNs;
+};
+
+// Map the segment of the given name read-only, returning false if there
+// is none
+bool openSharedMesh(const char* name, sharedMeshReader& reader);
+void closeSharedMesh(sharedMeshReader& reader);
+
+// Generation of the latest mesh, 0 if none has been published
+uint32_t sharedMeshGeneration(const sharedMeshReader& reader);
+
+// Sleep until the generation is no longer seen or timeoutMs passes (-1 to
+// wait for ever), returning the generation
+uint32_t waitSharedMesh(const sharedMeshReader& reader, uint32_t seen, int timeoutMs);
+
+// Look at the latest mesh without copying it, returning false if none has
+// been published
+bool readSharedMesh(sharedMeshReader& reader, sharedMeshFrame& frame);
+
+// Whether a frame's mesh is still as read, so work done on it is good
+bool sharedMeshStillValid(const sharedMeshReader& reader, const sharedMeshFrame& frame);
+
+// Nanoseconds on the clock publishedNs is measured with
+uint64_t sharedMeshClockNs();
+
+#endif
@@ -0,0 +1,334 @@
+////////////////////////////////////////////////////////////
+//
+// File:  softraster.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the software
+//               wireframe renderer.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include "softraster.h"
+
+// Screen bounds of a triangle in tiles; first > last if it is not drawn
+struct tileRect
+{
+    short firstX, firstY, lastX, lastY;
+};
+
+// Scratch kept between frames so a sweep does not reallocate; the
+// renderer is only ever run from one thread at a time
+static std::vector<float> screen;             // Framebuffer x, y per vertex
+static std::vector<unsigned char> inFront;    // Vertex is in front of the eye
+static std::vector<tileRect> triangleTiles;
+static std::vector<unsigned int> binCounts;   // Per thread, per tile
+static std::vector<unsigned int> binStarts;   // Per thread, per tile
+static std::vector<unsigned int> binned;      // Triangles, grouped by tile
+
+///////////////////////////////////////////////////////////
+//Run body(thread) on each of threads threads, this one included
+///////////////////////////////////////////////////////////
+template <class Body>
+static void runThreads(int threads, const Body& body)
+{
+    std::vector<std::thread> workers;
+    for (int t = 1 ; t < threads ; ++t)
+        workers.push_back(std::thread(body, t));
+    body(0);
+    for (unsigned int t = 0 ; t < workers.size() ; ++t)
+        workers[t].join();
+}
+
+///////////////////////////////////////////////////////////
+//4x4 column major matrices, as OpenGL keeps them
+///////////////////////////////////////////////////////////
+static void multiply(const double a[16], const double b[16], double out[16])
+{
+    double result[16];
+    for (int col = 0 ; col < 4 ; ++col)
+        for (int row = 0 ; row < 4 ; ++row)
+        {
+            double sum = 0.0;
+            for (int k = 0 ; k < 4 ; ++k)
+                sum += a[k * 4 + row] * b[col * 4 + k];
+            result[col * 4 + row] = sum;
+        }
+    memcpy(out, result, sizeof(result));
+}
+
+static void perspective(double fovy, double aspect, double zNear, double zFar, double m[16])
+{
+    double f = 1.0 / tan(fovy * DEGREE_RADIAN_FACTOR / 2);
+    memset(m, 0, 16 * sizeof(double));
+    m[0] = f / aspect;
+    m[5] = f;
+    m[10] = (zFar + zNear) / (zNear - zFar);
+    m[11] = -1.0;
+    m[14] = 2 * zFar * zNear / (zNear - zFar);
+}
+
+static void lookAt(Point3 eye, Point3 center, Vector3 up, double m[16])
+{
+    Vector3 forward(center - eye);
+    forward.normalize();
+    Vector3 side(forward ^ up);
+    side.normalize();
+    Vector3 upward(side ^ forward);
+
+    Vector3 from(eye - Point3(0, 0, 0));
+    double rows[3][3] = { { side[0], side[1], side[2] },
+                          { upward[0], upward[1], upward[2] },
+                          { -forward[0], -forward[1], -forward[2] } };
+    memset(m, 0, 16 * sizeof(double));
+    for (int row = 0 ; row < 3 ; ++row)
+    {
+        for (int col = 0 ; col < 3 ; ++col)
+            m[col * 4 + row] = rows[row][col];
+        m[12 + row] = -(rows[row][0] * from[0] + rows[row][1] * from[1] + rows[row][2] * from[2]);
+    }
+    m[15] = 1.0;
+}
+
+static void rotate(float degrees, double x, double y, double z, double m[16])
+{
+    double c = cos(degrees * DEGREE_RADIAN_FACTOR), s = sin(degrees * DEGREE_RADIAN_FACTOR);
+    double r[16] = { x * x * (1 - c) + c,     y * x * (1 - c) + z * s, x * z * (1 - c) - y * s, 0,
+                     x * y * (1 - c) - z * s, y * y * (1 - c) + c,     y * z * (1 - c) + x * s, 0,
+                     x * z * (1 - c) + y * s, y * z * (1 - c) - x * s, z * z * (1 - c) + c,     0,
+                     0, 0, 0, 1 };
+    multiply(m, r, m);
+}
+
+///////////////////////////////////////////////////////////
+//Draw the part of an edge inside a tile, stepping along its major axis
+//and lighting the pixel each step's center falls in
+///////////////////////////////////////////////////////////
+static void drawEdge(softFramebuffer& frame, float x0, float y0, float x1, float y1,
+                     int left, int top, int right, int bottom)
+{
+    float dx = x1 - x0, dy = y1 - y0;
+    bool steep = fabs(dy) > fabs(dx);
+    if (steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+        std::swap(dx, dy);
+        std::swap(left, top);
+        std::swap(right, bottom);
+    }
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dx = -dx;
+        dy = -dy;
+    }
+    if (dx == 0)
+        return;
+
+    float slope = dy / dx;
+    int first = std::max(left, (int)ceilf(x0 - 0.5f));
+    int last = std::min(right - 1, (int)floorf(x1 - 0.5f));
+    for (int major = first ; major <= last ; ++major)
+    {
+        //A line exactly on a pixel boundary lands left of or above it, as in GL
+        int minor = (int)ceilf(y0 + (major + 0.5f - x0) * slope) - 1;
+        if (minor < top || minor >= bottom)
+            continue;
+        int x = steep ? minor : major, y = steep ? major : minor;
+        memset(&frame.pixels[3 * (y * frame.width + x)], 0, 3);
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Draw a mesh into a framebuffer
+///////////////////////////////////////////////////////////
+void softRenderMesh(const MeshView& mesh, const shapeState& shape,
+                    int windowWidth, int windowHeight,
+                    softFramebuffer& out, softRenderStats* stats)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    //The tessellation window and the viewport tessWindowDisplay sets in it
+    out.width = windowWidth;
+    out.height = int(windowHeight * THREE_QUARTER_WINDOW);
+    out.pixels.resize(3 * out.width * out.height);
+    const double viewX = (int)(0.125 * windowWidth), viewWidth = int(windowWidth * .75);
+    const double viewHeight = int(windowHeight * .75);
+
+    //The same matrices tessWindowDisplay builds
+    double matrix[16], view[16];
+    perspective(QUARTER_CIRCLE, (1.0 * windowWidth) / windowHeight, 1, 1000, matrix);
+    lookAt(Point3(0.0, 0.0, CAMERA_DISTANCE), Point3(0.0, 0.0, -1.0), Vector3(0.0, 1.0, 0.0), view);
+    multiply(matrix, view, matrix);
+    rotate(shape.xRotation, 1.0, 0.0, 0.0, matrix);
+    rotate(shape.yRotation, 0.0, 1.0, 0.0, matrix);
+    rotate(shape.zRotation, 0.0, 0.0, 1.0, matrix);
+
+    const int tilesX = (out.width + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    const int tilesY = (out.height + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    const int tiles = tilesX * tilesY;
+    const unsigned int triangles = mesh.triangleCount();
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    if (mesh.vertexCount < SOFT_PARALLEL_MIN_VERTICES)
+        threads = 1;
+
+    //Transform-----------------------------------------------
+    screen.resize(2 * mesh.vertexCount);
+    inFront.resize(mesh.vertexCount);
+    runThreads(threads, [&](int thread)
+    {
+        unsigned int first = (unsigned long long)mesh.vertexCount * thread / threads;
+        unsigned int end = (unsigned long long)mesh.vertexCount * (thread + 1) / threads;
+        for (unsigned int v = first ; v < end ; ++v)
+        {
+            const Point3& p = mesh.positions[v];
+            double x = matrix[0] * p.x + matrix[4] * p.y + matrix[8] * p.z + matrix[12];
+            double y = matrix[1] * p.x + matrix[5] * p.y + matrix[9] * p.z + matrix[13];
+            double w = matrix[3] * p.x + matrix[7] * p.y + matrix[11] * p.z + matrix[15];
+            inFront[v] = w > 0;
+
+            //Window coordinates run up from the bottom, the framebuffer's down
+            screen[2 * v] = float(viewX + (x / w + 1) * viewWidth / 2);
+            screen[2 * v + 1] = float(out.height - (y / w + 1) * viewHeight / 2);
+        }
+    });
+    std::chrono::steady_clock::time_point transformed = std::chrono::steady_clock::now();
+
+    //Cull and bin--------------------------------------------
+    triangleTiles.resize(triangles);
+    binCounts.assign(threads * tiles, 0);
+    binStarts.resize(threads * tiles);
+    std::atomic<unsigned int> drawn(0);
+    runThreads(threads, [&](int thread)
+    {
+        unsigned int first = (unsigned long long)triangles * thread / threads;
+        unsigned int end = (unsigned long long)triangles * (thread + 1) / threads;
+        unsigned int* counts = &binCounts[thread * tiles];
+        unsigned int front = 0;
+        for (unsigned int t = first ; t < end ; ++t)
+        {
+            const unsigned int* corner = &mesh.indices[3 * t];
+            tileRect& rect = triangleTiles[t];
+            rect.firstX = rect.firstY = 0;
+            rect.lastX = rect.lastY = -1;
+            if (!inFront[corner[0]] || !inFront[corner[1]] || !inFront[corner[2]])
+                continue;
+
+            //Counter-clockwise on screen faces the viewer; with y running
+            //down that is a negative area
+            const float* a = &screen[2 * corner[0]];
+            const float* b = &screen[2 * corner[1]];
+            const float* c = &screen[2 * corner[2]];
+            if ((b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]) >= 0)
+                continue;
+
+            int left = std::max(0, (int)floorf(std::min(a[0], std::min(b[0], c[0]))));
+            int top = std::max(0, (int)floorf(std::min(a[1], std::min(b[1], c[1]))));
+            int right = std::min(out.width - 1, (int)floorf(std::max(a[0], std::max(b[0], c[0]))));
+            int bottom = std::min(out.height - 1, (int)floorf(std::max(a[1], std::max(b[1], c[1]))));
+            if (left > right || top > bottom)
+                continue;
+
+            rect.firstX = left / SOFT_TILE_SIZE;
+            rect.firstY = top / SOFT_TILE_SIZE;
+            rect.lastX = right / SOFT_TILE_SIZE;
+            rect.lastY = bottom / SOFT_TILE_SIZE;
+            for (int ty = rect.firstY ; ty <= rect.lastY ; ++ty)
+                for (int tx = rect.firstX ; tx <= rect.lastX ; ++tx)
+                    counts[ty * tilesX + tx]++;
+            ++front;
+        }
+        drawn += front;
+    });
+
+    //Each tile's triangles, thread by thread, so the order is fixed
+    unsigned int total = 0;
+    for (int tile = 0 ; tile < tiles ; ++tile)
+        for (int thread = 0 ; thread < threads ; ++thread)
+        {
+            binStarts[thread * tiles + tile] = total;
+            total += binCounts[thread * tiles + tile];
+        }
+    binned.resize(total);
+
+    runThreads(threads, [&](int thread)
+    {
+        unsigned int first = (unsigned long long)triangles * thread / threads;
+        unsigned int end = (unsigned long long)triangles * (thread + 1) / threads;
+        unsigned int* next = &binStarts[thread * tiles];
+        for (unsigned int t = first ; t < end ; ++t)
+        {
+            const tileRect& rect = triangleTiles[t];
+            for (int ty = rect.firstY ; ty <= rect.lastY ; ++ty)
+                for (int tx = rect.firstX ; tx <= rect.lastX ; ++tx)
+                    binned[next[ty * tilesX + tx]++] = t;
+        }
+    });
+    std::chrono::steady_clock::time_point binnedTime = std::chrono::steady_clock::now();
+
+    //Rasterize, a tile at a time---------------------------------
+    //binStarts now holds where each thread's run of a tile ends, so tile
+    //i's triangles run from the end of tile i - 1 to the end of its last
+    //thread's run
+    std::atomic<int> nextTile(0);
+    runThreads(std::min(threads, tiles), [&](int thread)
+    {
+        for (int tile = nextTile++ ; tile < tiles ; tile = nextTile++)
+        {
+            int left = (tile % tilesX) * SOFT_TILE_SIZE, top = (tile / tilesX) * SOFT_TILE_SIZE;
+            int right = std::min(out.width, left + SOFT_TILE_SIZE), bottom = std::min(out.height, top + SOFT_TILE_SIZE);
+
+            //Clear the tile to white
+            for (int y = top ; y < bottom ; ++y)
+                memset(&out.pixels[3 * (y * out.width + left)], 0xff, 3 * (right - left));
+
+            unsigned int first = tile == 0 ? 0 : binStarts[(threads - 1) * tiles + tile - 1];
+            unsigned int end = binStarts[(threads - 1) * tiles + tile];
+            for (unsigned int i = first ; i < end ; ++i)
+            {
+                const unsigned int* corner = &mesh.indices[3 * binned[i]];
+                const float* a = &screen[2 * corner[0]];
+                const float* b = &screen[2 * corner[1]];
+                const float* c = &screen[2 * corner[2]];
+                drawEdge(out, a[0], a[1], b[0], b[1], left, top, right, bottom);
+                drawEdge(out, b[0], b[1], c[0], c[1], left, top, right, bottom);
+                drawEdge(out, c[0], c[1], a[0], a[1], left, top, right, bottom);
+            }
+        }
+    });
+    std::chrono::steady_clock::time_point rasterized = std::chrono::steady_clock::now();
+
+    if (stats != NULL)
+    {
+        stats->transform = std::chrono::duration<double, std::milli>(transformed - start).count();
+        stats->binning = std::chrono::duration<double, std::milli>(binnedTime - transformed).count();
+        stats->rasterization = std::chrono::duration<double, std::milli>(rasterized - binnedTime).count();
+        stats->triangles = drawn;
+        stats->binned = total;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Write a framebuffer as a binary PPM
+///////////////////////////////////////////////////////////
+bool writeFramebufferPPM(const char* path, const softFramebuffer& frame)
+{
+    FILE* out = fopen(path, "wb");
+    if (out == NULL)
+        return false;
+
+    fprintf(out, "P6\n%d %d\n255\n", frame.width, frame.height);
+    fwrite(frame.pixels.data(), 1, frame.pixels.size(), out);
+    fclose(out);
+    return true;
+}
@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////
+//
+// File:  softraster.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the software
+//               wireframe renderer, which draws a mesh the way the
+//               tessellation window does (same gluPerspective, gluLookAt
+//               and glRotatef sequence, front faces as black lines on
+//               white) into a framebuffer in memory, for hosts without
+//               a GPU.
+//
+//               Vertices are transformed in parallel, then triangles that
+//               face away are culled and the rest binned into square
+//               screen tiles.  Each tile is then cleared and has the edges
+//               of its triangles drawn, clipped to the tile, by whichever
+//               thread takes it, so no two threads write the same pixel.
+//               The shapes are convex, so culling is all the hidden line
+//               removal the GL path's depth test does for them.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __SOFTRASTER_H__
+#define __SOFTRASTER_H__
+
+#include <vector>
+#include "resources.h"
+#include "mesh.h"
+
+// Width and height of a screen tile, in pixels
+#define SOFT_TILE_SIZE 64
+
+// Meshes with fewer vertices than this are drawn on one thread
+#define SOFT_PARALLEL_MIN_VERTICES 4096
+
+// An RGB framebuffer, rows top down
+struct softFramebuffer
+{
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+// Where the time of a frame went, in milliseconds, and what it drew
+struct softRenderStats
+{
+    double transform;
+    double binning;
+    double rasterization;
+    unsigned int triangles;     // Front facing triangles drawn
+    unsigned int binned;        // Triangle and tile pairs rasterized
+};
+
+// Draw mesh, turned by the rotation in shape, as the tessellation window
+// of a windowWidth by windowHeight main window would, into out (resized to
+// the tessellation window); stats, if given, gets the frame's timings
+void softRenderMesh(const MeshView& mesh, const shapeState& shape,
+                    int windowWidth, int windowHeight,
+                    softFramebuffer& out, softRenderStats* stats = NULL);
+
+// Write a framebuffer as a binary PPM, returning false if it cannot be
+bool writeFramebufferPPM(const char* path, const softFramebuffer& frame);
+
+#endif
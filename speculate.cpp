@@ -0,0 +1,382 @@
+////////////////////////////////////////////////////////////
+//
+// File:  speculate.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for speculative
+//               tessellation.  The thread runs under SCHED_IDLE where the
+//               system allows it (otherwise at the lowest nice value), so
+//               on a busy machine it takes no time from drawing and input.
+//               The tasks the generators split big meshes into are kept on
+//               this thread rather than handed to the task pool, whose
+//               threads run at normal priority.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "resources.h"
+#include "speculate.h"
+#include "baked.h"
+#include "tasks.h"
+#include "trace.h"
+
+// A level of a rendering; shapes without a secondary tessellation have 0
+typedef std::pair<short, std::pair<int, int> > speculationKey;
+
+// A finished guess, and when it was last guessed
+struct storedMesh
+{
+    Mesh mesh;
+    unsigned long lastGuessed;
+};
+
+// Shared with the speculating thread
+static std::mutex speculationLock;
+static std::condition_variable speculationChanged;
+static std::map<speculationKey, storedMesh> store;
+static std::deque<speculationKey> queue;
+static speculationKey building;
+static bool busy = false;
+static bool buildingCancelled = false;
+static bool stopping = false;
+static std::thread speculator;
+static unsigned long guessClock = 0;
+static speculationStats stats;
+
+static speculationKey keyOf(short rendering, int primary, int secondary)
+{
+    bool usesSecondary = rendering == RENDERING_CYL || rendering == RENDERING_CONE;
+    return speculationKey(rendering, std::make_pair(primary, usesSecondary ? secondary : 0));
+}
+
+static unsigned long meshBytes(const Mesh& mesh)
+{
+    return mesh.positions.size() * sizeof(Point3) + mesh.normals.size() * sizeof(Vector3) +
+           mesh.indices.size() * sizeof(unsigned int);
+}
+
+///////////////////////////////////////////////////////////
+//Drop the least recently guessed meshes past the store's bounds; the
+//lock is held
+///////////////////////////////////////////////////////////
+static void trimStore()
+{
+    while (true)
+    {
+        unsigned long bytes = 0;
+        std::map<speculationKey, storedMesh>::iterator oldest = store.end();
+        for (std::map<speculationKey, storedMesh>::iterator s = store.begin() ; s != store.end() ; ++s)
+        {
+            bytes += meshBytes(s->second.mesh);
+            if (oldest == store.end() || s->second.lastGuessed < oldest->second.lastGuessed)
+                oldest = s;
+        }
+        if (store.size() <= SPECULATE_STORE_MESHES && bytes <= SPECULATE_STORE_BYTES)
+            return;
+        store.erase(oldest);
+        ++stats.wasted;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Generate queued guesses while nothing else wants the CPU
+///////////////////////////////////////////////////////////
+static void speculate()
+{
+    sched_param idle;
+    memset(&idle, 0, sizeof(idle));
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &idle) != 0)
+        setpriority(PRIO_PROCESS, syscall(SYS_gettid), 19);
+    keepTasksOnThisThread(true);
+
+    std::unique_lock<std::mutex> lock(speculationLock);
+    while (true)
+    {
+        speculationChanged.wait(lock, [] { return stopping || !queue.empty(); });
+        if (stopping)
+            return;
+        building = queue.front();
+        queue.pop_front();
+        busy = true;
+        buildingCancelled = false;
+
+        lock.unlock();
+        Mesh mesh;
+        {
+            TRACE_SPAN("speculate");
+            generateMesh(building.first, building.second.first, std::max(1, building.second.second), mesh);
+        }
+        lock.lock();
+
+        busy = false;
+        if (buildingCancelled)
+            ++stats.cancelled;
+        else
+        {
+            storedMesh& stored = store[building];
+            stored.mesh.positions.swap(mesh.positions);
+            stored.mesh.normals.swap(mesh.normals);
+            stored.mesh.indices.swap(mesh.indices);
+            stored.lastGuessed = ++guessClock;
+            ++stats.generated;
+            trimStore();
+        }
+        speculationChanged.notify_all();
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Guess the neighbours of a level just built
+///////////////////////////////////////////////////////////
+void speculateAround(short rendering, int primary, int secondary, unsigned long bytes)
+{
+    std::lock_guard<std::mutex> lock(speculationLock);
+    if (!speculator.joinable())
+        speculator = std::thread(speculate);
+
+    //Guesses about anything else are dropped: those not started, the one
+    //being generated, and other shapes' finished ones
+    stats.cancelled += queue.size();
+    queue.clear();
+    if (busy && building.first != rendering)
+        buildingCancelled = true;
+    for (std::map<speculationKey, storedMesh>::iterator s = store.begin() ; s != store.end() ; )
+        if (s->first.first != rendering)
+        {
+            store.erase(s++);
+            ++stats.wasted;
+        }
+        else
+            ++s;
+
+    //One step either way of each tessellation the shape uses
+    const bool usesSecondary = rendering == RENDERING_CYL || rendering == RENDERING_CONE;
+    const int steps[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    for (int step = 0 ; step < (usesSecondary ? 4 : 2) ; ++step)
+    {
+        int p = primary + steps[step][0];
+        int s = secondary + steps[step][1];
+        if (p < TESSELLATION_MIN || p > maxPrimaryTessellation(rendering) || s < TESSELLATION_MIN || s > TESSELLATION_MAX)
+            continue;
+
+        //Baked levels cost nothing, and a level bigger than the whole
+        //store would only push everything else out
+        MeshView baked;
+        if (findBakedMesh(rendering, p, s, baked))
+            continue;
+        double growth = rendering == RENDERING_SPH ? (p > primary ? 4.0 : 0.25) :
+                        rendering == RENDERING_CUBE ? double(p * p) / (primary * primary) :
+                        double(p * s) / (primary * secondary);
+        if (bytes * growth > SPECULATE_STORE_BYTES)
+            continue;
+
+        speculationKey key = keyOf(rendering, p, s);
+        std::map<speculationKey, storedMesh>::iterator stored = store.find(key);
+        if (stored != store.end())
+            stored->second.lastGuessed = ++guessClock;
+        else if (!(busy && !buildingCancelled && building == key))
+            queue.push_back(key);
+    }
+    speculationChanged.notify_all();
+}
+
+///////////////////////////////////////////////////////////
+//Take a guessed level if there is one
+///////////////////////////////////////////////////////////
+bool takeSpeculated(short rendering, int primary, int secondary, Mesh& out)
+{
+    std::unique_lock<std::mutex> lock(speculationLock);
+    ++stats.builds;
+    speculationKey key = keyOf(rendering, primary, secondary);
+
+    //A guess still under way is left to the caller to build: the guessing
+    //thread runs at idle priority, so on a busy machine waiting for it
+    //could take any time at all
+    if (busy && !buildingCancelled && building == key)
+    {
+        buildingCancelled = true;
+        ++stats.overtaken;
+        return false;
+    }
+
+    std::map<speculationKey, storedMesh>::iterator stored = store.find(key);
+    if (stored == store.end())
+        return false;
+    out.positions.swap(stored->second.mesh.positions);
+    out.normals.swap(stored->second.mesh.normals);
+    out.indices.swap(stored->second.mesh.indices);
+    store.erase(stored);
+    ++stats.hits;
+    return true;
+}
+
+speculationStats getSpeculationStats()
+{
+    std::lock_guard<std::mutex> lock(speculationLock);
+    return stats;
+}
+
+void speculationSummary(FILE* out)
+{
+    speculationStats counts = getSpeculationStats();
+    if (counts.builds == 0)
+        return;
+    fprintf(out, "Speculation: %lu of %lu builds guessed (%.0f%%), %lu still being guessed, %lu of %lu guesses unused, %lu cancelled\n",
+            counts.hits, counts.builds, 100.0 * counts.hits / counts.builds, counts.overtaken,
+            counts.generated - counts.hits, counts.generated, counts.cancelled);
+}
+
+void stopSpeculation()
+{
+    {
+        std::lock_guard<std::mutex> lock(speculationLock);
+        stopping = true;
+        queue.clear();
+    }
+    speculationChanged.notify_all();
+    if (speculator.joinable())
+        speculator.join();
+}
+
+///////////////////////////////////////////////////////////
+//Wait for every queued guess to finish, as the user's pause between
+//steps would
+///////////////////////////////////////////////////////////
+static void waitForSpeculation()
+{
+    std::unique_lock<std::mutex> lock(speculationLock);
+    speculationChanged.wait(lock, [] { return queue.empty() && !busy; });
+}
+
+// Where each shape's walk starts and how far it may go
+struct reportWalk
+{
+    short rendering;
+    const char* name;
+    int primary;
+    int secondary;
+    int lowest;
+    int highest;
+};
+
+static const reportWalk reportWalks[] =
+{
+    { RENDERING_CUBE, "Cube", 40, 1, 9, 150 },
+    { RENDERING_CYL, "Cylinder", 60, 30, 9, 150 },
+    { RENDERING_CONE, "Cone", 60, 30, 9, 150 },
+    { RENDERING_SPH, "Sphere", 5, 1, 5, 7 }
+};
+
+// Steps walked per shape, and one in this many jumps several levels, as
+// typing a number into a field would
+#define REPORT_STEPS 40
+#define REPORT_JUMP_EVERY 8
+
+// Sphere asked for while it is being guessed, one deeper than any the
+// walk guesses so it is not in the store already, and how long the report
+// gives the guess to start
+#define REPORT_BUSY_DEPTH 9
+#define REPORT_BUSY_WAIT_MS 1000
+
+///////////////////////////////////////////////////////////
+//Step through each shape's levels and count the guesses that served
+///////////////////////////////////////////////////////////
+int speculateReport()
+{
+    int failures = 0;
+    unsigned int state = 12345;
+    printf("%-9s %6s %6s %6s %12s %12s\n", "Shape", "Steps", "Hits", "Missed", "Hit ms", "Generate ms");
+    for (unsigned int w = 0 ; w < sizeof(reportWalks) / sizeof(reportWalks[0]) ; ++w)
+    {
+        const reportWalk& walk = reportWalks[w];
+        speculationStats before = getSpeculationStats();
+        int primary = walk.primary, secondary = walk.secondary;
+        double hitMs = 0.0, missMs = 0.0;
+        Mesh mesh, check;
+        generateMesh(walk.rendering, primary, secondary, mesh);
+        speculateAround(walk.rendering, primary, secondary, meshBytes(mesh));
+
+        for (int step = 0 ; step < REPORT_STEPS ; ++step)
+        {
+            //Mostly one step on one field, sometimes a jump
+            waitForSpeculation();
+            state = state * 1103515245u + 12345u;
+            bool usesSecondary = walk.rendering == RENDERING_CYL || walk.rendering == RENDERING_CONE;
+            int size = (state >> 16) % REPORT_JUMP_EVERY == 0 ? 3 : 1;
+            int direction = ((state >> 20) & 1) ? 1 : -1;
+            int& field = usesSecondary && ((state >> 21) & 1) ? secondary : primary;
+            field = std::min(walk.highest, std::max(walk.lowest, field + direction * size));
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bool hit = takeSpeculated(walk.rendering, primary, secondary, mesh);
+            if (!hit)
+                generateMesh(walk.rendering, primary, secondary, mesh);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            (hit ? hitMs : missMs) += ms;
+            speculateAround(walk.rendering, primary, secondary, meshBytes(mesh));
+
+            //A served guess must be exactly what the generator makes
+            if (hit)
+            {
+                generateMesh(walk.rendering, primary, secondary, check);
+                failures += !(check.positions.size() == mesh.positions.size() && check.indices.size() == mesh.indices.size() &&
+                              check.normals.size() == mesh.normals.size() &&
+                              memcmp(check.positions.data(), mesh.positions.data(), check.positions.size() * sizeof(Point3)) == 0 &&
+                              memcmp(check.normals.data(), mesh.normals.data(), check.normals.size() * sizeof(Vector3)) == 0 &&
+                              memcmp(check.indices.data(), mesh.indices.data(), check.indices.size() * sizeof(unsigned int)) == 0);
+            }
+        }
+
+        speculationStats after = getSpeculationStats();
+        unsigned long hits = after.hits - before.hits;
+        unsigned long misses = after.builds - before.builds - hits;
+        printf("%-9s %6d %6lu %6lu %12.3f %12.3f\n", walk.name, REPORT_STEPS, hits, misses,
+               hits > 0 ? hitMs / hits : 0.0, misses > 0 ? missMs / misses : 0.0);
+    }
+
+    //A level asked for while it is being guessed is handed back to the
+    //caller at once rather than waited on
+    speculateAround(RENDERING_SPH, REPORT_BUSY_DEPTH - 1, 1, 0);
+    speculationKey busyKey = keyOf(RENDERING_SPH, REPORT_BUSY_DEPTH, 1);
+    bool started = false;
+    for (int ms = 0 ; ms < REPORT_BUSY_WAIT_MS && !started ; ++ms)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(speculationLock);
+        started = busy && building == busyKey;
+    }
+    if (started)
+    {
+        Mesh asked;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool taken = takeSpeculated(RENDERING_SPH, REPORT_BUSY_DEPTH, 1, asked);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printf("Asking for a sphere of depth %d while it was being guessed returned in %.3f ms\n", REPORT_BUSY_DEPTH, ms);
+        if (taken)
+        {
+            printf("The guess under way was waited on\n");
+            ++failures;
+        }
+        waitForSpeculation();
+    }
+    else
+        printf("The guess of a sphere of depth %d never started; not checked\n", REPORT_BUSY_DEPTH);
+    speculationSummary(stdout);
+    stopSpeculation();
+    return failures;
+}
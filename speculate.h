@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////
+//
+// File:  speculate.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for speculative
+//               tessellation.  Stepping the fields with +/- and [/] asks
+//               for a neighbour of the level just built far more often
+//               than anything else, so once a level is built its
+//               neighbours are generated on a thread that only runs when
+//               nothing else wants the CPU, into a small store the next
+//               build takes its mesh from if it guessed right.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __SPECULATE_H__
+#define __SPECULATE_H__
+
+#include <cstdio>
+#include "mesh.h"
+
+// Most meshes, and bytes of them, kept waiting to be asked for; the least
+// recently guessed are dropped first
+#define SPECULATE_STORE_MESHES 8
+#define SPECULATE_STORE_BYTES (64u << 20)
+
+// How the guesses have done
+struct speculationStats
+{
+    unsigned long builds;       // Levels built that were not baked in
+    unsigned long hits;         // Taken from the store
+    unsigned long overtaken;    // Still being guessed when asked for, so built by the asker
+    unsigned long generated;    // Guesses finished
+    unsigned long wasted;       // Finished guesses dropped unused
+    unsigned long cancelled;    // Guesses dropped before they finished
+};
+
+// Guess the neighbours of a level of the given rendering just built,
+// whose mesh took bytes, dropping the guesses about any other level or
+// shape
+void speculateAround(short rendering, int primary, int secondary, unsigned long bytes);
+
+// Move a guessed mesh of the given level into out; returns false, and
+// leaves out alone, if it was not guessed or is still being generated,
+// in which case the guess is cancelled for the caller to build it
+bool takeSpeculated(short rendering, int primary, int secondary, Mesh& out);
+
+// Counts so far
+speculationStats getSpeculationStats();
+
+// Print the counts and hit rate
+void speculationSummary(FILE* out);
+
+// Stop the speculating thread, finishing the mesh it is on
+void stopSpeculation();
+
+// Walk each shape's levels a step at a time, idling between steps as a
+// user would, and print how many steps the guesses served and what they
+// saved; returns nonzero if a served mesh was not the generator's
+int speculateReport();
+
+#endif
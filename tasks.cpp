@@ -0,0 +1,312 @@
+////////////////////////////////////////////////////////////
+//
+// File:  tasks.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for the task pool.
+//               The pool starts on the first spawn that can use it.  A
+//               thread outside the pool (the main thread, a service
+//               worker) spawns into a deque the pool threads share and
+//               helps run tasks while it waits, so it is never left
+//               blocked on a pool that is busy with someone else's work.
+//
+////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "resources.h"
+#include "tasks.h"
+#include "mesh.h"
+#include "trace.h"
+
+static void wakeWaiters();
+
+// A task and the group it counts against
+struct queuedTask
+{
+    std::function<void()> body;
+    TaskGroup* group;
+
+    void run()
+    {
+        body();
+        //The group may be gone as soon as its count reaches 0
+        if (group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            wakeWaiters();
+    }
+};
+
+// One thread's tasks; the owner pushes and pops at the back, thieves take
+// from the front
+struct taskDeque
+{
+    std::mutex lock;
+    std::deque<queuedTask> tasks;
+};
+
+// The pool: a deque per pool thread, then one shared by every thread
+// outside it
+static std::mutex poolLock;
+static std::atomic<bool> poolRunning(false);
+static std::vector<std::thread> workers;
+static std::vector<std::unique_ptr<taskDeque> > deques;
+static int requestedWorkers = 0;
+
+// Pool threads with nothing to take sleep until a spawn, and threads
+// waiting on a group until a spawn or the end of a group
+static std::mutex sleepLock;
+static std::condition_variable taskQueued;
+static std::atomic<int> queued(0);
+static bool stopping = false;
+
+// The calling thread's deque, or -1 for a thread outside the pool
+static thread_local int ownDeque = -1;
+static thread_local bool keepTasks = false;
+
+static void stopTaskWorkers();
+
+///////////////////////////////////////////////////////////
+//Wake the threads waiting on groups, one of which has just finished
+///////////////////////////////////////////////////////////
+static void wakeWaiters()
+{
+    //Taking the lock orders this against a waiter deciding to sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+    }
+    taskQueued.notify_all();
+}
+
+///////////////////////////////////////////////////////////
+//Take a task: the newest of this thread's own, else the oldest of
+//another thread's
+///////////////////////////////////////////////////////////
+static bool takeTask(int own, queuedTask& out)
+{
+    const int count = deques.size();
+    for (int i = 0 ; i < count ; ++i)
+    {
+        //Thieves start at the deque after their own, so they spread out
+        int victim = (own + i) % count;
+        taskDeque& deque = *deques[victim];
+        std::lock_guard<std::mutex> lock(deque.lock);
+        if (deque.tasks.empty())
+            continue;
+        if (i == 0)
+        {
+            out = std::move(deque.tasks.back());
+            deque.tasks.pop_back();
+        }
+        else
+        {
+            out = std::move(deque.tasks.front());
+            deque.tasks.pop_front();
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////
+//Run tasks until the pool is stopped
+///////////////////////////////////////////////////////////
+static void workerLoop(int index)
+{
+    ownDeque = index;
+    queuedTask task;
+    while (true)
+    {
+        if (takeTask(index, task))
+        {
+            task.run();
+            task.body = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepLock);
+        taskQueued.wait(lock, [] { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+        if (stopping)
+            return;
+    }
+}
+
+///////////////////////////////////////////////////////////
+//Start the pool if it is not running
+///////////////////////////////////////////////////////////
+static void startPool()
+{
+    std::lock_guard<std::mutex> lock(poolLock);
+    if (poolRunning.load(std::memory_order_relaxed))
+        return;
+
+    static bool registered = false;
+    if (!registered)
+    {
+        atexit(stopTaskWorkers);
+        registered = true;
+    }
+
+    //The thread waiting on a group runs tasks too, so the pool is one short
+    int threads = taskWorkers() - 1;
+    stopping = false;
+    for (int i = 0 ; i <= threads ; ++i)
+        deques.push_back(std::unique_ptr<taskDeque>(new taskDeque()));
+    for (int i = 0 ; i < threads ; ++i)
+        workers.push_back(std::thread(workerLoop, i));
+    poolRunning.store(true, std::memory_order_release);
+}
+
+static void stopTaskWorkers()
+{
+    std::lock_guard<std::mutex> lock(poolLock);
+    {
+        std::lock_guard<std::mutex> sleeping(sleepLock);
+        stopping = true;
+    }
+    taskQueued.notify_all();
+    for (unsigned int i = 0 ; i < workers.size() ; ++i)
+        workers[i].join();
+    workers.clear();
+    deques.clear();
+    queued.store(0);
+    poolRunning.store(false, std::memory_order_release);
+}
+
+int taskWorkers()
+{
+    if (requestedWorkers > 0)
+        return requestedWorkers;
+    return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+void setTaskWorkers(int workers)
+{
+    stopTaskWorkers();
+    requestedWorkers = std::max(0, workers);
+}
+
+void keepTasksOnThisThread(bool keep)
+{
+    keepTasks = keep;
+}
+
+///////////////////////////////////////////////////////////
+//Queue a task, or run it now where no other thread would take it
+///////////////////////////////////////////////////////////
+void TaskGroup::spawn(const std::function<void()>& task)
+{
+    if (keepTasks || taskWorkers() <= 1)
+    {
+        task();
+        return;
+    }
+    if (!poolRunning.load(std::memory_order_acquire))
+        startPool();
+
+    pending.fetch_add(1, std::memory_order_relaxed);
+    taskDeque& deque = *deques[ownDeque >= 0 ? ownDeque : deques.size() - 1];
+    {
+        std::lock_guard<std::mutex> lock(deque.lock);
+        deque.tasks.push_back(queuedTask{ task, this });
+    }
+    queued.fetch_add(1, std::memory_order_relaxed);
+
+    //Taking the lock orders this against a worker deciding to sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+    }
+    taskQueued.notify_one();
+}
+
+///////////////////////////////////////////////////////////
+//Help run tasks until the group's are done
+///////////////////////////////////////////////////////////
+void TaskGroup::wait()
+{
+    if (pending.load(std::memory_order_acquire) == 0)
+        return;
+
+    //The tasks run may be anyone's; the last of this group's may be running
+    //elsewhere when there is nothing left to take, so sleep until it ends
+    //or something is queued to help with
+    const int own = ownDeque >= 0 ? ownDeque : deques.size() - 1;
+    queuedTask task;
+    while (pending.load(std::memory_order_acquire) > 0)
+    {
+        if (takeTask(own, task))
+        {
+            task.run();
+            task.body = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepLock);
+        taskQueued.wait(lock, [this]
+        {
+            return pending.load(std::memory_order_acquire) == 0 || queued.load(std::memory_order_relaxed) > 0;
+        });
+    }
+}
+
+// Depths the report starts at and, by default, stops at
+#define TASK_REPORT_FIRST_DEPTH 8
+#define TASK_REPORT_LAST_DEPTH 10
+
+///////////////////////////////////////////////////////////
+//Time sphere subdivision at each thread count
+///////////////////////////////////////////////////////////
+int taskReport(int maxDepth, int maxThreads)
+{
+    if (maxDepth <= 0)
+        maxDepth = TASK_REPORT_LAST_DEPTH;
+    int failures = 0;
+    const int cores = std::max(1, (int)std::thread::hardware_concurrency());
+    if (maxThreads <= 0)
+        maxThreads = cores;
+    printf("%d cores\n", cores);
+    printf("%-6s %10s %8s %10s %8s %11s\n", "Depth", "Triangles", "Threads", "ms", "Speedup", "Efficiency");
+
+    for (int depth = TASK_REPORT_FIRST_DEPTH ; depth <= maxDepth ; ++depth)
+    {
+        //One thread is the serial recursion every other count must match
+        Mesh serial, parallel;
+        double serialMs = 0.0;
+        for (int threads = 1 ; ; threads = std::min(2 * threads, maxThreads))
+        {
+            //Timed the second time, once the arrays' pages are mapped
+            setTaskWorkers(threads);
+            Mesh& mesh = threads == 1 ? serial : parallel;
+            generateMesh(RENDERING_SPH, depth, 1, mesh);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            generateMesh(RENDERING_SPH, depth, 1, mesh);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (threads == 1)
+                serialMs = ms;
+
+            bool same = threads == 1 ||
+                        (mesh.positions.size() == serial.positions.size() && mesh.indices.size() == serial.indices.size() &&
+                         memcmp(mesh.positions.data(), serial.positions.data(), serial.positions.size() * sizeof(Point3)) == 0 &&
+                         memcmp(mesh.normals.data(), serial.normals.data(), serial.normals.size() * sizeof(Vector3)) == 0 &&
+                         memcmp(mesh.indices.data(), serial.indices.data(), serial.indices.size() * sizeof(unsigned int)) == 0);
+            failures += !same;
+            printf("%-6d %10u %8d %10.1f %7.2fx %10.0f%%%s\n", depth, mesh.triangleCount(), threads, ms,
+                   serialMs / ms, 100.0 * serialMs / ms / threads, same ? "" : "  differs from one thread");
+            if (threads == maxThreads)
+                break;
+        }
+    }
+    setTaskWorkers(0);
+    return failures;
+}
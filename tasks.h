@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////
+//
+// File:  tasks.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the declarations for the work-stealing
+//               task pool the generators split their work across.  Each
+//               thread has its own deque of tasks: it runs the newest of
+//               its own first, and when that runs dry takes the oldest
+//               from another thread's, so a recursion that spawns as it
+//               goes spreads itself over however many threads there are
+//               without being divided up front.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __TASKS_H__
+#define __TASKS_H__
+
+#include <atomic>
+#include <functional>
+
+// Work is cut into about this many tasks per thread, so a thread that
+// finishes early has something left to take
+#define TASKS_PER_WORKER 8
+
+// Tasks that can be waited on together.  A task may spawn more into the
+// group it runs in.
+class TaskGroup
+{
+public:
+    TaskGroup() : pending(0) {}
+    ~TaskGroup() { wait(); }
+
+    // Queue a task on the calling thread's deque
+    void spawn(const std::function<void()>& task);
+
+    // Run and take tasks until every task spawned into the group is done
+    void wait();
+
+private:
+    friend struct queuedTask;
+    std::atomic<unsigned int> pending;
+};
+
+// Threads tasks run on, counting the one waiting for them
+int taskWorkers();
+
+// Run the pool with the given number of threads (0 for one per core)
+// from the next spawn on; no task may be running
+void setTaskWorkers(int workers);
+
+// Run tasks spawned from this thread on this thread alone, as a thread
+// that should not have its work done at a higher priority than its own
+// wants
+void keepTasksOnThisThread(bool keep);
+
+// Build spheres of depth 8 up to maxDepth (0 for 10) with 1, 2, 4, ...
+// threads up to maxThreads (0 for one per core), printing the times and
+// speedups; returns the number of meshes that differed from the one thread
+// build.  More threads than cores only checks the meshes come out the same.
+int taskReport(int maxDepth, int maxThreads);
+
+#endif
@@ -12,8 +12,34 @@
 //
 ////////////////////////////////////////////////////////////
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include "resources.h"
 #include "input.h"
+#include "mesh.h"
+#include "lod.h"
+#include "refine.h"
+#include "baked.h"
+#include "quantize.h"
+#include "compress.h"
+#include "glyphs.h"
+#include "coalesce.h"
+#include "latency.h"
+#include "trace.h"
+#include "memtrack.h"
+#include "replay.h"
+#include "bench.h"
+#include "topology.h"
+#include "meshlet.h"
+#include "bvh.h"
+#include "scene.h"
+#include "service.h"
+#include "publish.h"
+#include "sharedmesh.h"
+#include "speculate.h"
+#include "tasks.h"
 #if defined(__APPLE__) && defined(__MACH__)
 #include <GLUT/glut.h>
 #else
@@ -22,14 +48,10 @@
 
 // Function prototypes
 void statusWindowDisplay();
-void refreshAll();
-
-// Following rendering functions will be defined
-// in the renderings.o object at link time
-extern void Cone(int n, int m);
-extern void Cube(int n);
-extern void Cylinder(int n, int m);
-extern void Sphere(int n);
+void markDirty(unsigned int changes);
+void exportMesh();
+
+// Window title, defined in the renderings.o object at link time
 extern const char* PROJECT_NAME;
 
 // Actual declarations for extern'ed shared variables
@@ -44,67 +66,140 @@ int lastx;
 int lasty;
 textField fields[2];
 shapeState renderings[4];
-std::vector<Point3> vertices;
+Mesh activeMesh;
+MeshView activeView;
 bool tessChange;
 bool mouseDown;
 short activeRendering;
 bool helpActive;
+short tessMode;
+bool progressiveRefinement;
+bool quantizedVertices;
+bool coneCulling;
+bool picking;
+bool solidShading;
+bool sceneMode;
+int sceneInstances = SCENE_INSTANCES;
+bool latencyHud;
+bool memoryHud;
+double chordTolerance;
+int debounceMs = DEBOUNCE_MS;
+int maxLatencyMs = DEBOUNCE_MAX_LATENCY_MS;
+bool speculation = true;
+
+// Changes the status window has not drawn yet, and the mode information
+// worked out the last time it did
+unsigned int statusDirty;
+uiString modeInfo[2];
+
+// Display list of the status window's panel, and the window size, active
+// rendering and field states it was compiled for
+GLuint panelList;
+int panelLayout[5];
 
 ///////////////////////////////////////////////////////////
 //Convert numbers to strings
 ///////////////////////////////////////////////////////////
-std::string numToString(int num)
+uiString numToString(int num)
 {
-    //Temp variables used for the conversion
-    std::string returnString = "";
-    std::string currentCharacter;
-    int current;
+    //Write the digits backwards from the end of a buffer
+    char digits[16];
+    char* first = digits + sizeof(digits);
 
     //Loop while the number is greater than 0
     while(num > 0)
     {
-        //Strip off the 10's spot number
-        current = num % 10;
+        //Strip off the 10's spot number and put it in front of the others
+        *--first = char('0' + num % 10);
         num /= 10;
-
-        //Appened it to the front of the return string
-        currentCharacter = (current + '0');
-        returnString.insert(0, currentCharacter);
     }
 
-    return returnString;
+    return uiString(first, digits + sizeof(digits));
 }
 
 ///////////////////////////////////////////////////////////
 //Function used to draw text labels
 ///////////////////////////////////////////////////////////
-void drawLabel(double r, double g, double b, int x, int y, std::string text)
+void drawLabel(double r, double g, double b, int x, int y, const char* text)
 {
     //Set the color and position of the text
     glColor3f(r, g, b);
     glRasterPos2i(x, y);
 
-    //Draw the text 1 character at a time
-    for(unsigned int count = 0 ; count < text.size() ; ++count)
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, text[count]);
+    //Draw the text from the glyph lists
+    drawGlyphs(GLYPHS_LABEL, text);
 }
 
 ///////////////////////////////////////////////////////////
-//Redraw all windows and sub-windows
+//Function used to draw a line of mode information beside the text fields
 ///////////////////////////////////////////////////////////
-void refreshAll()
+void drawInfo(int line, const char* text)
 {
-    //Refresh the main window
-    glutSetWindow(mainWindow);
-    glutPostRedisplay();
+    //Lines stack downwards from the primary tessellation field
+    glColor3f(BLACK_D);
+    glRasterPos2i(INFO_TEXT_X, fields[PRIMARY_TESS_FIELD_INDEX].y - line * INFO_TEXT_SPACING);
+
+    //Draw the text from the glyph lists
+    drawGlyphs(GLYPHS_SMALL, text);
+}
+
+///////////////////////////////////////////////////////////
+//Redraw the sub-windows that show what changed
+///////////////////////////////////////////////////////////
+void markDirty(unsigned int changes)
+{
+    //Nothing to refresh in the modes that run without windows
+    if (mainWindow == 0)
+        return;
+
+    int current = glutGetWindow();
 
     //Refresh the tessellation window
-    glutSetWindow(tessWindow);
-    glutPostRedisplay();
+    if (changes & DIRTY_TESS_WINDOW)
+    {
+        glutSetWindow(tessWindow);
+        glutPostRedisplay();
+        awaitDisplay(LATENCY_TESS_WINDOW);
+    }
 
-    //Refresh the status window
-    glutSetWindow(statusWindow);
-    glutPostRedisplay();
+    //Refresh the status window, remembering what to recompute
+    if (changes & DIRTY_STATUS_WINDOW)
+    {
+        statusDirty |= changes;
+        glutSetWindow(statusWindow);
+        glutPostRedisplay();
+        awaitDisplay(LATENCY_STATUS_WINDOW);
+    }
+
+    if (current != 0)
+        glutSetWindow(current);
+}
+
+///////////////////////////////////////////////////////////
+//Write the shape's full resolution mesh to a compressed file
+///////////////////////////////////////////////////////////
+void exportMesh()
+{
+    const char* names[4] = { "cube", "cylinder", "cone", "sphere" };
+
+    //The same mesh the tessellation window draws once it is left alone
+    MeshView mesh = activeView;
+    if (tessMode == TESS_MODE_AUTO_LOD)
+        mesh = selectLod(activeRendering, int(windowSizey * THREE_QUARTER_WINDOW)).mesh;
+
+    //A mesh kept only as 16 bit vertices is written from those
+    Mesh restored;
+    if (mesh.positions == NULL)
+    {
+        dequantizeMesh(quantizedFor(mesh), restored);
+        mesh = restored;
+    }
+
+    std::string path = std::string(names[activeRendering]) + "-" + numToString(mesh.triangleCount()).c_str() + ".tsm";
+    if (writeCompressedMesh(path, mesh, false))
+        printf("Wrote %s\n", path.c_str());
+    else
+        printf("Could not write %s\n", path.c_str());
 }
 
 ///////////////////////////////////////////////////////////
@@ -122,6 +217,17 @@ void initialize()
     //Set the active rendering to 0 (i.e cube)
     activeRendering = RENDERING_CUBE;
 
+    //Tessellation comes from the text fields until a mode is toggled
+    tessMode = TESS_MODE_MANUAL;
+    progressiveRefinement = false;
+    quantizedVertices = false;
+    coneCulling = false;
+    picking = false;
+    solidShading = false;
+    latencyHud = false;
+    memoryHud = false;
+    chordTolerance = TOLERANCE_INIT;
+
     //Set up the primary tessellation field
     fields[PRIMARY_TESS_FIELD_INDEX].buttonText = "";
     fields[PRIMARY_TESS_FIELD_INDEX].x = TESS_FIELD_X;
@@ -152,40 +258,16 @@ void initialize()
 
     //Tessellation needs to be calculated initially
     tessChange = true;
+    statusDirty = DIRTY_ALL;
 }
 
 ///////////////////////////////////////////////////////////
-//Displays the status subwindow
+//Draws everything in the status subwindow but the tessellation numbers
+//and the mode information, which only changes with the window size, the
+//active rendering and which text field is active
 ///////////////////////////////////////////////////////////
-void statusWindowDisplay()
+void drawPanel()
 {
-    //Set status sub window to the active glut window
-    glutSetWindow(statusWindow);
-
-    //Clear the sub window
-    glClear(GL_COLOR_BUFFER_BIT);
-    glClearColor(WHITE_D, 1.0);
-
-    //Set up the drawing and viewing area of the window
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(0, windowSizex, 0, int(windowSizey * QUARTER_WINDOW));
-    glViewport(0, 0, windowSizex, int(windowSizey * QUARTER_WINDOW));
-
-    //Create subwindow divider at the top of the window
-    glColor3f(0.0, 0.0, 0.0);
-    glBegin(GL_LINES);
-        glVertex2i(0, int(windowSizey * QUARTER_WINDOW) - 1);
-        glVertex2i(windowSizex, int(windowSizey * QUARTER_WINDOW) - 1);
-    glEnd();
-
-    if (helpActive)
-    {
-        ShowHelp();
-        glutSwapBuffers();
-        return;
-    }
-
     //Draw Buttons-----------------------------------------
     //***************Cube***************
     glBegin(GL_POLYGON);
@@ -262,14 +344,7 @@ void statusWindowDisplay()
     drawLabel(BLACK_D, RENDERING_BUTTON_ADJUST_X, int(windowSizey * EIGHTH_WINDOW), "Primary Tessellation:");
     drawLabel(BLACK_D, RENDERING_BUTTON_ADJUST_X, int(windowSizey * ONE_SIXTEENTH_WINDOW), "Secondary Tessellation:");
 
-    //Check to see that fields are currently not active and convert the current renderings
-    //tessellation factors to strings
-    if(!fields[PRIMARY_TESS_FIELD_INDEX].active)
-        fields[PRIMARY_TESS_FIELD_INDEX].buttonText = numToString(renderings[activeRendering].primaryTessellation);
-    if(!fields[SECONDARY_TESS_FIELD_INDEX].active)
-        fields[SECONDARY_TESS_FIELD_INDEX].buttonText = numToString(renderings[activeRendering].secondaryTessellation);
-
-    //Output the text fields and their values
+    //Output the text fields
     for (int i = 0 ; i < 2 ; ++i)
     {
         //If the current text field is active
@@ -298,15 +373,6 @@ void statusWindowDisplay()
             glVertex2i(fields[i].x - TESS_FIELD_EDGE_LEFT_OFFSET, fields[i].y + TESS_FIELD_EDGE_BOT_OFFSET);
         glEnd();
 
-        //Set the color and the position of the text in the text field
-        glColor3f(BLACK_D);
-        glRasterPos2i(fields[i].x, fields[i].y);
-
-        //Output the tessellation factor character by character
-        int len = fields[i].buttonText.length();
-        for (int j = 0 ; j < len ; ++j)
-            glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, fields[i].buttonText[j]);
-
         //Draw +/- buttons for tessellation
         glBegin(GL_POLYGON);
             glColor3f(GRAY_BUTT_TOP_D);
@@ -320,7 +386,7 @@ void statusWindowDisplay()
 
         glColor3f(WHITE_D);
         glRasterPos2i(fields[i].x + TESS_INC_TEXT_X_OFFSET, fields[i].y + TESS_INC_TEXT_Y_OFFSET);
-        glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, '+');
+        drawGlyphs(GLYPHS_LARGE, "+");
 
         glBegin(GL_POLYGON);
             glColor3f(GRAY_BUTT_TOP_D);
@@ -334,9 +400,11 @@ void statusWindowDisplay()
 
         glColor3f(WHITE_D);
         glRasterPos2i(fields[i].x + TESS_DEC_TEXT_X_OFFSET, fields[i].y + TESS_DEC_TEXT_Y_OFFSET);
-        glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, '-');
+        drawGlyphs(GLYPHS_LARGE, "-");
     }
     //Text Boxes-------------------------------------------
+
+    //Help button
     glColor3f(YELLOW_D);
     glBegin(GL_POLYGON);
         glVertex2i(windowSizex - HELP_BUTTON_RIGHT_OFFSET, HELP_BUTTON_BOT_OFFSET);
@@ -346,30 +414,338 @@ void statusWindowDisplay()
     glEnd();
     glColor3f(BLACK_D);
     glRasterPos2i(windowSizex - HELP_BUTTON_TEXT_X_OFFSET, HELP_BUTTON_TEXT_Y_OFFSET);
-    glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, '?');
+    drawGlyphs(GLYPHS_LARGE, "?");
+}
+
+///////////////////////////////////////////////////////////
+//Displays the status subwindow
+///////////////////////////////////////////////////////////
+void statusWindowDisplay()
+{
+    TRACE_SPAN("statusWindowDisplay");
+
+    //Set status sub window to the active glut window
+    glutSetWindow(statusWindow);
+
+    //All text is drawn from glyph lists, which have to exist before any
+    //list drawing text is compiled
+    loadGlyphs();
+
+    //Clear the sub window
+    glClearColor(WHITE_D, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    //Set up the drawing and viewing area of the window
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0, windowSizex, 0, int(windowSizey * QUARTER_WINDOW));
+    glViewport(0, 0, windowSizex, int(windowSizey * QUARTER_WINDOW));
+
+    //Create subwindow divider at the top of the window
+    glColor3f(0.0, 0.0, 0.0);
+    glBegin(GL_LINES);
+        glVertex2i(0, int(windowSizey * QUARTER_WINDOW) - 1);
+        glVertex2i(windowSizex, int(windowSizey * QUARTER_WINDOW) - 1);
+    glEnd();
+
+    if (helpActive)
+    {
+        ShowHelp();
+        glutSwapBuffers();
+        noteSwap(LATENCY_STATUS_WINDOW);
+        return;
+    }
+
+    //Only what the changes since the last draw affect is worked out again
+    unsigned int changes = statusDirty;
+    statusDirty = 0;
+
+    //The panel is compiled once and replayed until its layout changes
+    int layout[5] = { windowSizex, windowSizey, activeRendering,
+                      fields[PRIMARY_TESS_FIELD_INDEX].active, fields[SECONDARY_TESS_FIELD_INDEX].active };
+    if (panelList == 0 || memcmp(layout, panelLayout, sizeof(layout)) != 0)
+    {
+        if (panelList == 0)
+            panelList = glGenLists(1);
+        glNewList(panelList, GL_COMPILE);
+        drawPanel();
+        glEndList();
+        memcpy(panelLayout, layout, sizeof(layout));
+    }
+    glCallList(panelList);
+
+    //Check to see that fields are currently not active and convert the current renderings
+    //tessellation factors to strings
+    if (changes & (DIRTY_TESSELLATION | DIRTY_SHAPE | DIRTY_TEXT))
+    {
+        if(!fields[PRIMARY_TESS_FIELD_INDEX].active)
+            fields[PRIMARY_TESS_FIELD_INDEX].buttonText = numToString(renderings[activeRendering].primaryTessellation);
+        if(!fields[SECONDARY_TESS_FIELD_INDEX].active)
+            fields[SECONDARY_TESS_FIELD_INDEX].buttonText = numToString(renderings[activeRendering].secondaryTessellation);
+    }
+
+    //Output the values of the text fields
+    glColor3f(BLACK_D);
+    for (int i = 0 ; i < 2 ; ++i)
+    {
+        glRasterPos2i(fields[i].x, fields[i].y);
+        drawGlyphs(GLYPHS_LARGE, fields[i].buttonText.c_str());
+    }
+
+    //Mode information-------------------------------------
+    if (changes & (DIRTY_MODE | DIRTY_TESSELLATION | DIRTY_SHAPE))
+    {
+        modeInfo[0] = modeInfo[1] = "";
+        if (tessMode == TESS_MODE_AUTO_LOD)
+        {
+            const lodLevel& level = selectLod(activeRendering, int(windowSizey * THREE_QUARTER_WINDOW));
+            modeInfo[0] = "Auto LOD: " + numToString(level.primaryTessellation) + " x " + numToString(level.secondaryTessellation);
+        }
+        else if (tessMode == TESS_MODE_TOLERANCE)
+        {
+            int primary, secondary;
+            char tolerance[64];
+            double achieved = toleranceTessellation(activeRendering, chordTolerance, primary, secondary);
+            sprintf(tolerance, "Tolerance %g: %d x %d, error %.5f", chordTolerance, primary, secondary, achieved);
+            modeInfo[0] = tolerance;
+        }
+        if (progressiveRefinement)
+            modeInfo[1] = "Progressive refinement";
+    }
+    //Only the lines in use are drawn, each below the last, so they stay in
+    //the window however many modes are on
+    int line = 0;
+    for (int mode = 0 ; mode < 2 ; ++mode)
+        if (!modeInfo[mode].empty())
+            drawInfo(line++, modeInfo[mode].c_str());
+    if (quantizedVertices && currentQuantized() != NULL)
+    {
+        char quantized[128];
+        sprintf(quantized, "16 bit vertices (%s): bound %.2g, error %.2g",
+                activeView.positions == NULL ? "doubles freed" : "doubles kept",
+                currentQuantized()->errorBound, currentQuantized()->maxError);
+        drawInfo(line++, quantized);
+    }
+    if (latencyHud)
+    {
+        //Latencies as of this draw, two event types to a line
+        const char* names[LATENCY_EVENT_TYPES] = { "key", "arrow", "click", "drag" };
+        char latency[2][128];
+        for (int pair = 0 ; pair < 2 ; ++pair)
+        {
+            latencyStats first = getLatencyStats(2 * pair);
+            latencyStats second = getLatencyStats(2 * pair + 1);
+            sprintf(latency[pair], "%s %s %.1f/%.1f/%.1f  %s %.1f/%.1f/%.1f",
+                    pair == 0 ? "Latency ms p50/p99/max:" : "",
+                    names[2 * pair], first.p50, first.p99, first.max,
+                    names[2 * pair + 1], second.p50, second.p99, second.max);
+            drawInfo(line++, latency[pair]);
+        }
+
+        //How often a build was already done by the time it was asked for
+        speculationStats guesses = getSpeculationStats();
+        if (speculation && guesses.builds > 0)
+        {
+            char speculated[96];
+            sprintf(speculated, "Speculation: %lu of %lu builds guessed, %lu guesses unused",
+                    guesses.hits, guesses.builds, guesses.generated - guesses.hits);
+            drawInfo(line++, speculated);
+        }
+    }
+    if (memoryHud)
+    {
+        //Memory held now and at most, per category
+        memoryStats tess = getMemoryStats(MEMORY_TESSELLATION);
+        memoryStats draw = getMemoryStats(MEMORY_DRAW);
+        memoryStats ui = getMemoryStats(MEMORY_UI);
+        char memory[128];
+        sprintf(memory, "Memory KB now/peak: tess %.0f/%.0f  draw %.0f/%.0f  ui %.1f/%.1f",
+                tess.current / 1024.0, tess.peak / 1024.0, draw.current / 1024.0, draw.peak / 1024.0,
+                ui.current / 1024.0, ui.peak / 1024.0);
+        drawInfo(line++, memory);
+    }
+    if (coneCulling)
+    {
+        //What the tessellation window's last frame kept out of the pipeline
+        const meshletCullStats& cull = lastMeshletCull();
+        char culling[128];
+        sprintf(culling, "Cone culling: %u of %u triangles, %u of %u clusters",
+                cull.culledTriangles, cull.triangles, cull.culledMeshlets, cull.meshlets);
+        drawInfo(line++, culling);
+    }
+    if (sceneMode)
+    {
+        //What the tessellation window's last frame drew, and how fast
+        const sceneFrameStats& scene = lastSceneFrame();
+        double seconds = (scene.cullMs + scene.submitMs) / 1000.0;
+        char drawn[128], throughput[128];
+        sprintf(drawn, "Scene: %u of %u instances, %.3g triangles, cull %.2f ms",
+                scene.drawnInstances, scene.instances, scene.triangles, scene.cullMs);
+        sprintf(throughput, "Throughput: %.3g instances/s, %.3g triangles/s",
+                seconds > 0.0 ? scene.drawnInstances / seconds : 0.0, seconds > 0.0 ? scene.triangles / seconds : 0.0);
+        drawInfo(line++, drawn);
+        drawInfo(line++, throughput);
+    }
+    if (picking)
+    {
+        //What is under the cursor in the tessellation window
+        const PickHit& hit = lastPick();
+        char pick[128] = "Picking: nothing under the cursor";
+        if (hit.triangle != PICK_NONE)
+            sprintf(pick, "Picked triangle %u, vertex %u at (%.3f, %.3f, %.3f)",
+                    hit.triangle, hit.vertex, hit.point.x, hit.point.y, hit.point.z);
+        drawInfo(line++, pick);
+    }
+    //Mode information-------------------------------------
 
     //Swap the buffers
     glutSwapBuffers();
+    noteSwap(LATENCY_STATUS_WINDOW);
 }
 
 ///////////////////////////////////////////////////////////
-//Add a triangle to the vertices vector
+//Add a triangle to the mesh being generated
 ///////////////////////////////////////////////////////////
-void addTriangle(Point3 p1, Point3 p2, Point3 p3)
+void addTriangle(Point3 p1, Point3 p2, Point3 p3, Vector3 n1, Vector3 n2, Vector3 n3)
 {
-    //Push back all the points
-    vertices.push_back(p1);
-    vertices.push_back(p2);
-    vertices.push_back(p3);
+    //Triangles added one at a time do not share their corners
+    unsigned int first = meshSink->positions.size();
+
+    //Push back all the points, and the surface normals at them
+    meshSink->positions.push_back(p1);
+    meshSink->positions.push_back(p2);
+    meshSink->positions.push_back(p3);
+    meshSink->normals.push_back(n1);
+    meshSink->normals.push_back(n2);
+    meshSink->normals.push_back(n3);
+
+    meshSink->indices.push_back(first);
+    meshSink->indices.push_back(first + 1);
+    meshSink->indices.push_back(first + 2);
 }
 
 ///////////////////////////////////////////////////////////
-//Displays the shape rending window
+//Whether anything reads the active mesh's double positions, which 16 bit
+//vertices otherwise replace
 ///////////////////////////////////////////////////////////
-void tessWindowDisplay(void)
+static bool doublesWanted()
 {
-    //Set the active window to the tessellation window
-    glutSetWindow(tessWindow);
+    return coneCulling || picking || publishing();
+}
+
+///////////////////////////////////////////////////////////
+//Chooses, building it if the tessellation changed, the mesh the
+//tessellation window shows this frame
+///////////////////////////////////////////////////////////
+MeshView chooseTessMesh()
+{
+    //Keep the active rendering in range
+    if (activeRendering < RENDERING_CUBE || activeRendering > RENDERING_SPH)
+        activeRendering = RENDERING_CUBE;
+
+    //Take up the rotation of every event since the last frame
+    applyQueuedRotation();
+
+    //Tessellation the active mesh was last built with; a debounced change
+    //may have moved the fields on since
+    static int builtPrimary = 0;
+    static int builtSecondary = 0;
+
+    //The mesh that will be drawn this frame
+    MeshView mesh;
+
+    //Tessellation requested by the fields, or derived from the tolerance
+    int primary = renderings[activeRendering].primaryTessellation;
+    int secondary = renderings[activeRendering].secondaryTessellation;
+    if (tessMode == TESS_MODE_TOLERANCE)
+        toleranceTessellation(activeRendering, chordTolerance, primary, secondary);
+
+    //Doubles dropped for 16 bit vertices are built again once they are read
+    if (activeView.positions == NULL && activeView.indices != NULL && (!quantizedVertices || doublesWanted()))
+        tessChange = true;
+
+    //Automatic level of detail draws from the precomputed chain, leaving
+    //tessChange set so the fields' tessellation is built on switching back
+    if (tessMode == TESS_MODE_AUTO_LOD)
+    {
+        mesh = selectLod(activeRendering, int(windowSizey * THREE_QUARTER_WINDOW)).mesh;
+    }
+    //If the tessChange flag is set then recalculate the tessellation of the figure
+    else if(tessChange){
+        //The old quantized copies, clusters and hierarchy were of the arrays
+        //about to be replaced
+        forgetQuantized();
+        forgetMeshlets();
+        forgetBvh();
+
+        //Small tessellations are baked in, anything else replaces the old mesh
+        if (findBakedMesh(activeRendering, primary, secondary, activeView))
+        {
+            TRACE_SPAN("mesh clear");
+            activeMesh.clear();
+        }
+        else
+        {
+            //A neighbour guessed while the user paused is taken as it is
+            //Other processes' copy is built in place, where they will read it
+            if (!speculation || !takeSpeculated(activeRendering, primary, secondary, activeMesh))
+                generatePublishable(activeRendering, primary, secondary, activeMesh);
+            activeView = activeMesh;
+        }
+
+        //Stepping the fields mostly asks for a neighbour of this level next
+        if (speculation && tessMode == TESS_MODE_MANUAL)
+            speculateAround(activeRendering, primary, secondary,
+                            activeView.vertexCount * (sizeof(Point3) + sizeof(Vector3)) + activeView.indexCount * sizeof(unsigned int));
+
+        //Other processes see the new mesh as soon as it is built
+        if (publishing())
+            publishMesh(activeView, activeRendering, primary, secondary);
+
+        //Tessellation now does not have to be recalculated
+        builtPrimary = primary;
+        builtSecondary = secondary;
+        tessChange = false;
+    }
+
+    //With 16 bit vertices on, a generated mesh keeps only those unless
+    //something reads its doubles; baked tables cost nothing to keep
+    if (quantizedVertices && !doublesWanted() && activeView.positions != NULL &&
+        activeView.positions == activeMesh.positions.data())
+    {
+        quantizeActive(activeMesh);
+        activeView = MeshView(NULL, activeView.vertexCount, activeView.indices, activeView.indexCount);
+    }
+
+    //While picking, the hierarchy of a new tessellation is built alongside
+    //the frames rather than on the first one the cursor is over it
+    if (picking && tessMode != TESS_MODE_AUTO_LOD)
+        prepareBvh(activeView);
+
+    if (tessMode != TESS_MODE_AUTO_LOD)
+        mesh = activeView;
+
+    //While the shape is rotated draw a coarse proxy instead
+    if (progressiveRefinement && tessMode != TESS_MODE_AUTO_LOD)
+    {
+        const Mesh* proxy = refinementProxy(activeRendering, builtPrimary, builtSecondary);
+        if (proxy != NULL)
+            mesh = *proxy;
+    }
+
+    return mesh;
+}
+
+///////////////////////////////////////////////////////////
+//Draws the active shape with the tessellation window's camera and state
+//into the current context, short of swapping buffers, and returns the
+//changes it made for the status window.  times, if given, gets how long
+//choosing or building the mesh and submitting it took.
+///////////////////////////////////////////////////////////
+unsigned int drawTessFrame(tessFrameTimes* times)
+{
+    std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+    unsigned int changes = 0;
 
     //Set up the display window for the 3d drawing
     float ratio = (1.0 * windowSizex) / windowSizey;
@@ -381,7 +757,7 @@ void tessWindowDisplay(void)
     gluPerspective(QUARTER_CIRCLE, ratio, 1, 1000);
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
-    gluLookAt(0.0, 0.0, 2.75,
+    gluLookAt(0.0, 0.0, CAMERA_DISTANCE,
               0.0, 0.0, -1.0,
               0.0f, 1.0f, 0.0f);
 
@@ -391,58 +767,182 @@ void tessWindowDisplay(void)
     glCullFace(GL_BACK);
     glEnable(GL_CULL_FACE);
     glMatrixMode(GL_MODELVIEW);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glDisable(GL_LIGHTING);
     glPolygonMode(GL_FRONT, GL_LINE);
 
-    //Clear the sub window
-    glClear(GL_COLOR_BUFFER_BIT);
+    //Clear the sub window, setting the colour first so the first frame
+    //is not cleared to black
     glClearColor(WHITE_D, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    //If the tessChange flag is set then recalculate the tessellation of the figure
-    if(tessChange){
-        //Delete all old entries in the vector
-        vertices.clear();
-
-        //Depending on which is the current active rendering call the appropriote recalculate function
-        switch (activeRendering)
-        {
-        default:
-            activeRendering = 0;
-        case 0:
-            Cube(renderings[activeRendering].primaryTessellation);  break;
-        case 1:
-            Cylinder(renderings[activeRendering].primaryTessellation, renderings[activeRendering].secondaryTessellation);  break;
-        case 2:
-            Cone(renderings[activeRendering].primaryTessellation, renderings[activeRendering].secondaryTessellation);  break;
-        case 3:
-            Sphere(renderings[activeRendering].primaryTessellation);  break;
-        }
+    std::chrono::steady_clock::time_point choosing = std::chrono::steady_clock::now();
 
-        //Tessellation now does not have to be recalculated
-        tessChange = false;
+    //Choose the mesh, building it if the tessellation changed, or scatter
+    //the scene the first time it is shown
+    MeshView mesh;
+    Scene* scene = NULL;
+    if (sceneMode)
+    {
+        applyQueuedRotation();
+        scene = &sceneFor(sceneInstances);
+    }
+    else
+        mesh = chooseTessMesh();
+    std::chrono::steady_clock::time_point built = std::chrono::steady_clock::now();
+
+    //16 bit vertices may be all the mesh has left; culling keeps the doubles
+    //and quantizes its own reordering of them further down
+    bool quantizedChanged = false;
+    const QuantizedMesh* quantized = NULL;
+    if (quantizedVertices && scene == NULL && !coneCulling)
+        quantized = &quantizedFor(mesh, &quantizedChanged);
+
+    //Solid shading fills the triangles and lights them with the normals the
+    //generators wrote, the light placed before the rotation so it stays put
+    const bool lit = solidShading && scene == NULL && (quantized != NULL ? !quantized->normals.empty() : mesh.normals != NULL);
+    if (lit)
+    {
+        const GLfloat direction[4] = { SOLID_LIGHT_DIRECTION };
+        const GLfloat ambient[4] = { SOLID_AMBIENT };
+        glLightfv(GL_LIGHT0, GL_POSITION, direction);
+        glLightModelfv(GL_LIGHT_MODEL_AMBIENT, ambient);
+        glEnable(GL_LIGHT0);
+        glEnable(GL_LIGHTING);
+        glEnable(GL_COLOR_MATERIAL);
+        glPolygonMode(GL_FRONT, GL_FILL);
+
+        //The quantized mesh's scale would stretch the normals
+        if (quantizedVertices)
+            glEnable(GL_NORMALIZE);
+        else
+            glDisable(GL_NORMALIZE);
     }
 
-    //Draw all the coordinates within the vertices vector
-    //Se the color to black
-    glColor3f(BLACK_D);
+    //Draw all the triangles of the mesh
+    //Se the color to black, or the solid shape's color
+    if (lit)
+        glColor3f(SOLID_SHAPE_D);
+    else
+        glColor3f(BLACK_D);
 
     //Set the rotation at which the shape will be draw based on the active rendering
     glRotatef(renderings[activeRendering].xRotation, 1.0, 0.0, 0.0);
     glRotatef(renderings[activeRendering].yRotation, 0.0, 1.0, 0.0);
     glRotatef(renderings[activeRendering].zRotation, 0.0, 0.0, 1.0);
 
-    //Loop through the vector and draw all the trianlges
-    for( unsigned int i = 2; i < vertices.size(); i += 3 ){
-        glBegin(GL_TRIANGLES);
-            glVertex3d(vertices[i - 2].x, vertices[i - 2].y, vertices[i - 2].z);
-            glVertex3d(vertices[i - 1].x, vertices[i - 1].y, vertices[i - 1].z);
-            glVertex3d(vertices[i].x, vertices[i].y, vertices[i].z);
-        glEnd();
+    //The scene turns with the active shape's rotation, and its throughput
+    //line changes every frame
+    if (scene != NULL)
+    {
+        const sceneFrameStats& stats = drawScene(*scene);
+        if (times != NULL)
+        {
+            times->tessellation = std::chrono::duration<double, std::milli>(built - choosing).count();
+            times->submission = std::chrono::duration<double, std::milli>((choosing - frameStart) + (std::chrono::steady_clock::now() - built)).count();
+            times->triangles = stats.triangles;
+            times->culled = 0;
+            times->instances = stats.drawnInstances;
+            times->culledInstances = stats.instances - stats.drawnInstances;
+        }
+        return changes | DIRTY_MODE;
     }
 
-    //Swap the buffers
-    glutSwapBuffers();
+    //Picking works on the mesh as chosen, before culling reorders it
+    const MeshView chosen = mesh;
+
+    //Drop the clusters facing away, drawing the rest from the clusters'
+    //reordering of the mesh
+    static std::vector<TriangleRun> runs;
+    const TriangleRun* drawRuns = NULL;
+    unsigned int culled = 0;
+    if (coneCulling)
+    {
+        unsigned int lastCulled = lastMeshletCull().culledTriangles;
+        bool changed = false;
+        const MeshletMesh& meshlets = meshletsFor(mesh, &changed);
+        mesh = meshlets.view;
+        culled = cullMeshlets(meshlets, tessEyePosition(renderings[activeRendering]), runs).culledTriangles;
+        drawRuns = runs.data();
+
+        //The status window reports what was culled
+        if (changed || culled != lastCulled)
+            changes |= DIRTY_MODE;
+    }
+
+    {
+        TRACE_SPAN("draw");
+
+        //Culling keeps the normals with their vertices, and the quantized
+        //mesh carries its own
+        if (quantizedVertices)
+        {
+            //The status window reports on the quantized mesh
+            if (quantized == NULL)
+                quantized = &quantizedFor(mesh, &quantizedChanged);
+            drawQuantizedMesh(*quantized, drawRuns, runs.size(), lit);
+            if (quantizedChanged)
+                changes |= DIRTY_MODE;
+        }
+        else
+        {
+            if (lit)
+            {
+                glEnableClientState(GL_NORMAL_ARRAY);
+                glNormalPointer(GL_DOUBLE, sizeof(Vector3), mesh.normals);
+            }
+            drawMesh(mesh, drawRuns, runs.size());
+            if (lit)
+                glDisableClientState(GL_NORMAL_ARRAY);
+        }
+    }
+
+    //Pick on the full mesh only, not on a proxy drawn while rotating, so
+    //the hierarchy is built once per tessellation
+    if (picking && (tessMode == TESS_MODE_AUTO_LOD || chosen.indices == activeView.indices))
+    {
+        unsigned int lastTriangle = lastPick().triangle, lastVertex = lastPick().vertex;
+        const PickHit& hit = pickFrame(chosen, renderings[activeRendering]);
+        if (hit.triangle != lastTriangle || hit.vertex != lastVertex)
+            changes |= DIRTY_PICK;
+    }
+
+    if (times != NULL)
+    {
+        //State setup and clearing count as submission
+        times->tessellation = std::chrono::duration<double, std::milli>(built - choosing).count();
+        times->submission = std::chrono::duration<double, std::milli>((choosing - frameStart) + (std::chrono::steady_clock::now() - built)).count();
+        times->triangles = mesh.triangleCount();
+        times->culled = culled;
+        times->instances = 1;
+        times->culledInstances = 0;
+    }
+    return changes;
+}
+
+///////////////////////////////////////////////////////////
+//Displays the shape rending window
+///////////////////////////////////////////////////////////
+void tessWindowDisplay(void)
+{
+    TRACE_SPAN("tessWindowDisplay");
+    std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+    //Set the active window to the tessellation window
+    glutSetWindow(tessWindow);
+
+    unsigned int changes = drawTessFrame(NULL);
+    if (changes != 0)
+        markDirty(changes);
+
+    //Swap the buffers; the status window shows the latencies this completed
+    {
+        TRACE_SPAN("swap");
+        glutSwapBuffers();
+    }
+    if (replaying())
+        noteReplayFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    if (noteSwap(LATENCY_TESS_WINDOW) > 0 && latencyHud)
+        markDirty(DIRTY_LATENCY);
 }
 
 ///////////////////////////////////////////////////////////
@@ -454,8 +954,8 @@ void mainWindowDisplay(void)
     glutSetWindow(mainWindow);
 
     //Clear the window
-    glClear(GL_COLOR_BUFFER_BIT);
     glClearColor(WHITE_D, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
 }
 
 ///////////////////////////////////////////////////////////
@@ -463,6 +963,8 @@ void mainWindowDisplay(void)
 ///////////////////////////////////////////////////////////
 void changeSize(int w, int h)
 {
+    recordEvent(REPLAY_RESHAPE, w, h);
+
     //Prevent the size of the window from getting too small
     if(h <= MIN_WINDOW_RENDERING_Y)
         h = MIN_WINDOW_RENDERING_Y;
@@ -480,6 +982,7 @@ void changeSize(int w, int h)
     glutPostRedisplay();
 
     //Set the size of the status sub window and redraw
+    statusDirty = DIRTY_ALL;
     glutSetWindow(statusWindow);
     glutPositionWindow(0, int(windowSizey * THREE_QUARTER_WINDOW));
     glutReshapeWindow(windowSizex, int(windowSizey * QUARTER_WINDOW));
@@ -490,11 +993,165 @@ void changeSize(int w, int h)
     fields[SECONDARY_TESS_FIELD_INDEX].y = int(windowSizey * ONE_SIXTEENTH_WINDOW);
 }
 
+///////////////////////////////////////////////////////////
+//Print the input latencies measured this run
+///////////////////////////////////////////////////////////
+void printLatency()
+{
+    latencyReport(stdout);
+    speculationSummary(stdout);
+}
+
 ///////////////////////////////////////////////////////////
 //Main function
 ///////////////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
+    //Modes that run without any windows
+    for (int arg = 1 ; arg < argc ; ++arg)
+    {
+        if (strcmp(argv[arg], "--verify-baked") == 0)
+            return verifyBakedMeshes() == 0 ? 0 : 1;
+        if (strcmp(argv[arg], "--compress-report") == 0)
+            return compressReport() == 0 ? 0 : 1;
+        if (strcmp(argv[arg], "--topology-report") == 0)
+            return topologyReport() == 0 ? 0 : 1;
+        if (strcmp(argv[arg], "--bvh-report") == 0)
+        {
+            //Rays are cast through the window the GLUT windows would open at
+            initialize();
+            return bvhReport() == 0 ? 0 : 1;
+        }
+        if (strcmp(argv[arg], "--serve") == 0 && arg + 1 < argc)
+        {
+            //Hand meshes to other processes over a local socket
+            int workers = 0;
+            for (int other = 1 ; other + 1 < argc ; ++other)
+                if (strcmp(argv[other], "--serve-workers") == 0)
+                    workers = atoi(argv[other + 1]);
+            return runService(argv[arg + 1], workers);
+        }
+        if (strcmp(argv[arg], "--service-report") == 0 && arg + 1 < argc)
+            return serviceReport(argv[arg + 1]) == 0 ? 0 : 1;
+        if (strcmp(argv[arg], "--publish-report") == 0)
+            return publishReport() == 0 ? 0 : 1;
+        if (strcmp(argv[arg], "--watch-published") == 0)
+            return watchPublished(arg + 1 < argc ? argv[arg + 1] : SHARED_MESH_NAME);
+        if (strcmp(argv[arg], "--speculate-report") == 0)
+            return speculateReport() == 0 ? 0 : 1;
+        if (strcmp(argv[arg], "--trace-report") == 0)
+            return traceReport() == 0 ? 0 : 1;
+        if (strcmp(argv[arg], "--replay-report") == 0)
+        {
+            //An optional log, in place of the built in session
+            initialize();
+            return replayDeterminismReport(arg + 1 < argc ? argv[arg + 1] : NULL) == 0 ? 0 : 1;
+        }
+        if (strcmp(argv[arg], "--task-report") == 0)
+        {
+            //An optional deepest level and most threads
+            int maxDepth = arg + 1 < argc ? atoi(argv[arg + 1]) : 0;
+            int maxThreads = arg + 2 < argc ? atoi(argv[arg + 2]) : 0;
+            return taskReport(maxDepth, maxThreads) == 0 ? 0 : 1;
+        }
+        if (strcmp(argv[arg], "--mem-report") == 0)
+        {
+            //An optional budget, in KB, that every level's peak must fit in
+            unsigned long long budget = 0;
+            for (int other = 1 ; other + 1 < argc ; ++other)
+                if (strcmp(argv[other], "--mem-budget") == 0)
+                    budget = strtoull(argv[other + 1], NULL, 10) * 1024;
+            return memoryLevelReport(budget) == 0 ? 0 : 1;
+        }
+        if (strcmp(argv[arg], "--bench") == 0)
+        {
+            //Draw offscreen from the same starting state the windows get
+            initialize();
+            speculation = false;
+            int frames = BENCH_FRAMES;
+            int primary = 0, secondary = 0;
+            const char* ppm = NULL;
+            bool software = false;
+            for (int other = 1 ; other < argc ; ++other)
+            {
+                if (strcmp(argv[other], "--bench-frames") == 0 && other + 1 < argc)
+                    frames = atoi(argv[++other]);
+                else if (strcmp(argv[other], "--bench-shape") == 0 && other + 1 < argc)
+                    activeRendering = atoi(argv[++other]) - 1;
+                else if (strcmp(argv[other], "--bench-level") == 0 && other + 2 < argc)
+                {
+                    primary = atoi(argv[++other]);
+                    secondary = atoi(argv[++other]);
+                }
+                else if (strcmp(argv[other], "--bench-ppm") == 0 && other + 1 < argc)
+                    ppm = argv[++other];
+                else if (strcmp(argv[other], "--bench-quantized") == 0)
+                    quantizedVertices = true;
+                else if (strcmp(argv[other], "--bench-software") == 0)
+                    software = true;
+                else if (strcmp(argv[other], "--bench-cull") == 0)
+                    coneCulling = true;
+                else if (strcmp(argv[other], "--bench-solid") == 0)
+                    solidShading = true;
+                else if (strcmp(argv[other], "--bench-scene") == 0)
+                    sceneMode = true;
+                else if (strcmp(argv[other], "--scene-instances") == 0 && other + 1 < argc)
+                    sceneInstances = atoi(argv[++other]);
+            }
+            if (activeRendering < RENDERING_CUBE || activeRendering > RENDERING_SPH)
+                activeRendering = RENDERING_CUBE;
+            if (primary > 0)
+                renderings[activeRendering].primaryTessellation = std::min(primary, maxPrimaryTessellation(activeRendering));
+            if (secondary > 0)
+                renderings[activeRendering].secondaryTessellation = secondary;
+            return offscreenBenchmark(frames > 0 ? frames : BENCH_FRAMES, ppm, software);
+        }
+    }
+
+    //Input latencies are printed however the program ends
+    atexit(printLatency);
+    for (int arg = 1 ; arg < argc ; ++arg)
+        if (strcmp(argv[arg], "--no-speculate") == 0)
+            speculation = false;
+
+    //Input coalescing, tracing, recording and replay settings
+    const char* replayPath = NULL;
+    bool replayMaxSpeed = false;
+    for (int arg = 1 ; arg + 1 < argc ; ++arg)
+    {
+        if (strcmp(argv[arg], "--record") == 0)
+        {
+            if (!startRecording(argv[++arg]))
+                fprintf(stderr, "Could not write %s\n", argv[arg]);
+        }
+        else if (strcmp(argv[arg], "--replay") == 0)
+            replayPath = argv[++arg];
+        else if (strcmp(argv[arg], "--replay-speed") == 0)
+            replayMaxSpeed = strcmp(argv[++arg], "max") == 0;
+        else if (strcmp(argv[arg], "--trace") == 0)
+        {
+            if (!traceStart(argv[++arg]))
+                fprintf(stderr, "Tracing was compiled out (TRACE_ENABLED=0)\n");
+        }
+        else if (strcmp(argv[arg], "--debounce-ms") == 0)
+            debounceMs = atoi(argv[++arg]);
+        else if (strcmp(argv[arg], "--max-latency-ms") == 0)
+            maxLatencyMs = atoi(argv[++arg]);
+        else if (strcmp(argv[arg], "--scene-instances") == 0)
+            sceneInstances = atoi(argv[++arg]);
+        else if (strcmp(argv[arg], "--publish") == 0)
+        {
+            if (startPublishing(argv[++arg]))
+                atexit(stopPublishing);
+            else
+                fprintf(stderr, "Could not publish to %s\n", argv[arg]);
+        }
+    }
+
+    //Exit handlers run last registered first, so the speculating thread
+    //is stopped before the trace it records into is written out
+    atexit(stopSpeculation);
+
     //Glut initialization
     glutInit(&argc, argv);
 
@@ -531,6 +1188,7 @@ int main(int argc, char **argv)
     glutSpecialFunc(specialInput);
     glutMouseFunc(mouseInput);
     glutMotionFunc(mouseMovement);
+    glutPassiveMotionFunc(mouseHover);
     //CREATE DISPLAY SUBWINDOW--------------------------------
 
     //CREATE STATUS SUBWINDOW--------------------------------
@@ -544,6 +1202,13 @@ int main(int argc, char **argv)
     glutMouseFunc(mouseInput);
     //CREATE STATUS SUBWINDOW--------------------------------
 
+    //Feed a recorded session to the handlers once the loop is running
+    if (replayPath != NULL && !startReplay(replayPath, replayMaxSpeed))
+    {
+        fprintf(stderr, "Could not read %s\n", replayPath);
+        return 1;
+    }
+
     //Enter the glut main loop
     glutMainLoop();
 
@@ -0,0 +1,446 @@
+////////////////////////////////////////////////////////////
+//
+// File:  topology.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for building a
+//               corner table from a generated mesh.
+//
+////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include "resources.h"
+#include "topology.h"
+#include "parametric.h"
+#include "trace.h"
+
+// Each part's weld hash is kept at most half full
+#define WELD_TABLE_LOAD 2
+
+// Weld cells are this many weld distances wide, so that a point is rarely
+// near enough a cell's side to need the cell next to it searched as well
+#define WELD_CELL_SIZE 1024
+
+// Cells are hashed in up to this many parts, one task's worth each; with
+// one thread they are all one part
+#define WELD_PART_BITS 8
+#define WELD_PARTS (1 << WELD_PART_BITS)
+
+///////////////////////////////////////////////////////////
+//Run body(first, end) over [0, count) in one contiguous chunk per
+//thread, when there are enough corners or vertices to pay for them
+///////////////////////////////////////////////////////////
+template <class Body>
+static void parallelChunks(unsigned int count, const Body& body)
+{
+    int chunks = std::max(1, (int)std::thread::hardware_concurrency());
+    parallelRows(chunks, count / chunks + 1, [&](int firstChunk, int endChunk)
+    {
+        TRACE_SPAN("topology chunk");
+        body((unsigned int)((unsigned long long)count * firstChunk / chunks),
+             (unsigned int)((unsigned long long)count * endChunk / chunks));
+    });
+}
+
+///////////////////////////////////////////////////////////
+//Welding.  Positions are snapped to cells, and a point is compared with
+//those in its own cell and in any neighbouring cell it is within the weld
+//distance of.  A vertex welds with the first vertex near enough to it,
+//and so with whatever that one welded with.
+//
+//The top bits of a cell's hash pick one of up to WELD_PARTS parts.  Vertices are
+//partitioned by part, keeping their order, and each part's cells go in an
+//open addressed hash of their own, so parts are hashed in parallel and
+//the lookups after only read.  Slots keep only part of the cell's hash,
+//since the distance test settles any collision.
+///////////////////////////////////////////////////////////
+struct weldEntry
+{
+    unsigned int cell;          // High bits of the cell's hash
+    unsigned int first;         // TOPOLOGY_NONE for an empty slot
+    unsigned int last;
+};
+
+// The cell a point is in, and the step to the neighbouring cell on any
+// axis the point is near the side of (0 if it is not)
+struct weldCell
+{
+    long long x, y, z;
+    int dx, dy, dz;
+};
+
+static unsigned long long cellHash(long long x, long long y, long long z)
+{
+    //Grid aligned cells differ only in their high bits, so everything is
+    //mixed down into the low bits the table is indexed by
+    unsigned long long h = (unsigned long long)x * 0x9e3779b97f4a7c15ull;
+    h = (h ^ (h >> 32) ^ (unsigned long long)y) * 0xc2b2ae3d27d4eb4full;
+    h = (h ^ (h >> 32) ^ (unsigned long long)z) * 0x165667b19e3779f9ull;
+    return h ^ (h >> 29);
+}
+
+static unsigned int partOf(unsigned long long hash, int partBits)
+{
+    return partBits == 0 ? 0 : (unsigned int)(hash >> (64 - partBits));
+}
+
+// Steps to the neighbouring cells, packed two bits an axis
+static unsigned char packSteps(const weldCell& at)
+{
+    return (unsigned char)((at.dx & 3) | (at.dy & 3) << 2 | (at.dz & 3) << 4);
+}
+
+static weldCell cellOf(const Point3& p)
+{
+    const double cell = WELD_CELL_SIZE * TOPOLOGY_WELD_EPSILON;
+    const double near = 1.0 / WELD_CELL_SIZE;
+
+    weldCell at;
+    double sx = p.x / cell, sy = p.y / cell, sz = p.z / cell;
+    at.x = (long long)floor(sx);
+    at.y = (long long)floor(sy);
+    at.z = (long long)floor(sz);
+    double fx = sx - at.x, fy = sy - at.y, fz = sz - at.z;
+    at.dx = fx < near ? -1 : fx > 1.0 - near ? 1 : 0;
+    at.dy = fy < near ? -1 : fy > 1.0 - near ? 1 : 0;
+    at.dz = fz < near ? -1 : fz > 1.0 - near ? 1 : 0;
+    return at;
+}
+
+static unsigned int weldVertices(const MeshView& mesh, std::vector<unsigned int>& weldOf,
+                                 CornerTable& out)
+{
+    const unsigned int count = mesh.vertexCount;
+    const bool parallel = taskWorkers() > 1;
+    const int chunks = parallel ? taskWorkers() : 1;
+    const int partBits = parallel ? WELD_PART_BITS : 0;
+    const int parts = 1 << partBits;
+    auto chunkStart = [&](int chunk) { return (unsigned int)((unsigned long long)count * chunk / chunks); };
+
+    //Hash each vertex's cell, counting each chunk's vertices in each part
+    std::vector<unsigned long long> hashes(count);
+    std::vector<unsigned char> steps(count);
+    std::vector<unsigned int> partOffset(chunks * parts, 0);
+    parallelRows(chunks, count / chunks + 1, [&](int firstChunk, int endChunk)
+    {
+        TRACE_SPAN("weld hash");
+        for (int chunk = firstChunk ; chunk < endChunk ; ++chunk)
+            for (unsigned int v = chunkStart(chunk) ; v < chunkStart(chunk + 1) ; ++v)
+            {
+                weldCell at = cellOf(mesh.positions[v]);
+                hashes[v] = cellHash(at.x, at.y, at.z);
+                steps[v] = packSteps(at);
+                ++partOffset[chunk * parts + partOf(hashes[v], partBits)];
+            }
+    });
+
+    //Parts are laid out in order, each chunk's share of a part after the
+    //earlier chunks', and each part's table is at least twice its size
+    std::vector<unsigned int> partStart(parts + 1), tableStart(parts + 1);
+    unsigned int placed = 0, slots = 0;
+    for (int part = 0 ; part < parts ; ++part)
+    {
+        partStart[part] = placed;
+        for (int chunk = 0 ; chunk < chunks ; ++chunk)
+        {
+            unsigned int vertices = partOffset[chunk * parts + part];
+            partOffset[chunk * parts + part] = placed;
+            placed += vertices;
+        }
+
+        unsigned int size = 16;
+        while (size < WELD_TABLE_LOAD * (placed - partStart[part]))
+            size *= 2;
+        tableStart[part] = slots;
+        slots += size;
+    }
+    partStart[parts] = placed;
+    tableStart[parts] = slots;
+
+    //One part is the vertices in order already
+    std::vector<unsigned int> order;
+    if (parts > 1)
+    {
+        order.resize(count);
+        parallelRows(chunks, count / chunks + 1, [&](int firstChunk, int endChunk)
+        {
+            TRACE_SPAN("weld partition");
+            for (int chunk = firstChunk ; chunk < endChunk ; ++chunk)
+                for (unsigned int v = chunkStart(chunk) ; v < chunkStart(chunk + 1) ; ++v)
+                    order[partOffset[chunk * parts + partOf(hashes[v], partBits)]++] = v;
+        });
+    }
+
+    //Each cell's vertices are listed in order through nextInCell
+    std::vector<weldEntry> table(slots);
+    std::vector<unsigned int> nextInCell(count);
+    parallelRows(parts, count / parts + 1, [&](int firstPart, int endPart)
+    {
+        TRACE_SPAN("weld cells");
+        for (int part = firstPart ; part < endPart ; ++part)
+        {
+            weldEntry* cells = &table[tableStart[part]];
+            const unsigned int mask = tableStart[part + 1] - tableStart[part] - 1;
+            for (unsigned int i = 0 ; i <= mask ; ++i)
+                cells[i].first = TOPOLOGY_NONE;
+
+            for (unsigned int i = partStart[part] ; i < partStart[part + 1] ; ++i)
+            {
+                unsigned int v = parts > 1 ? order[i] : i;
+                unsigned long long hash = hashes[v];
+                unsigned long long slot = hash & mask;
+                while (cells[slot].first != TOPOLOGY_NONE && cells[slot].cell != (unsigned int)(hash >> 32))
+                    slot = (slot + 1) & mask;
+
+                nextInCell[v] = TOPOLOGY_NONE;
+                if (cells[slot].first == TOPOLOGY_NONE)
+                {
+                    cells[slot].cell = (unsigned int)(hash >> 32);
+                    cells[slot].first = v;
+                }
+                else
+                    nextInCell[cells[slot].last] = v;
+                cells[slot].last = v;
+            }
+        }
+    });
+
+    //Each vertex finds the first vertex near it, itself if there is none
+    weldOf.resize(count);
+    parallelChunks(count, [&](unsigned int first, unsigned int end)
+    {
+        for (unsigned int v = first ; v < end ; ++v)
+        {
+            const Point3& p = mesh.positions[v];
+            unsigned int found = v;
+            weldCell at;
+            if (steps[v] != 0)
+                at = cellOf(p);
+            for (int n = 0 ; n < 8 ; ++n)
+            {
+                if (n != 0 && (steps[v] == 0 || ((n & 1) && !at.dx) || ((n & 2) && !at.dy) || ((n & 4) && !at.dz)))
+                    continue;
+                unsigned long long hash = n == 0 ? hashes[v] :
+                                          cellHash(n & 1 ? at.x + at.dx : at.x, n & 2 ? at.y + at.dy : at.y, n & 4 ? at.z + at.dz : at.z);
+                const unsigned int part = partOf(hash, partBits);
+                const weldEntry* cells = &table[tableStart[part]];
+                const unsigned int mask = tableStart[part + 1] - tableStart[part] - 1;
+                unsigned long long slot = hash & mask;
+                while (cells[slot].first != TOPOLOGY_NONE && cells[slot].cell != (unsigned int)(hash >> 32))
+                    slot = (slot + 1) & mask;
+
+                for (unsigned int u = cells[slot].first ; u < found ; u = nextInCell[u])
+                {
+                    const Point3& q = mesh.positions[u];
+                    if (fabs(q.x - p.x) <= TOPOLOGY_WELD_EPSILON && fabs(q.y - p.y) <= TOPOLOGY_WELD_EPSILON &&
+                        fabs(q.z - p.z) <= TOPOLOGY_WELD_EPSILON)
+                    {
+                        found = u;
+                        break;
+                    }
+                }
+            }
+            weldOf[v] = found;
+        }
+    });
+
+    //Welded vertices are numbered in the order they first appear; a vertex
+    //found an earlier one, which is numbered already
+    out.weldedFrom.clear();
+    for (unsigned int v = 0 ; v < count ; ++v)
+        if (weldOf[v] == v)
+        {
+            weldOf[v] = out.weldedFrom.size();
+            out.weldedFrom.push_back(v);
+        }
+        else
+            weldOf[v] = weldOf[weldOf[v]];
+
+    return out.weldedFrom.size();
+}
+
+///////////////////////////////////////////////////////////
+//Build the corner table
+///////////////////////////////////////////////////////////
+void buildCornerTable(const MeshView& mesh, CornerTable& out)
+{
+    TRACE_SPAN("corner table");
+    const unsigned int corners = mesh.triangleCount() * 3;
+
+    std::vector<unsigned int> weldOf;
+    const unsigned int vertices = weldVertices(mesh, weldOf, out);
+
+    out.vertex.resize(corners);
+    parallelChunks(corners, [&](unsigned int first, unsigned int end)
+    {
+        for (unsigned int c = first ; c < end ; ++c)
+            out.vertex[c] = weldOf[mesh.indices[c]];
+    });
+
+    //Bucket the corners by the vertex their opposite edge starts at
+    std::vector<std::atomic<unsigned int> > bucketStart(vertices + 1);
+    parallelChunks(corners, [&](unsigned int first, unsigned int end)
+    {
+        for (unsigned int c = first ; c < end ; ++c)
+            bucketStart[out.vertex[CornerTable::next(c)] + 1].fetch_add(1, std::memory_order_relaxed);
+    });
+    for (unsigned int v = 1 ; v <= vertices ; ++v)
+        bucketStart[v].store(bucketStart[v].load(std::memory_order_relaxed) +
+                             bucketStart[v - 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    //Filling moves each bucket's start up to its end, and shifting them
+    //back a bucket restores them, so bucket v is [bucketStart[v],
+    //bucketStart[v + 1])
+    trackedVector<unsigned int, MEMORY_TESSELLATION> bucketed(corners);
+    parallelChunks(corners, [&](unsigned int first, unsigned int end)
+    {
+        for (unsigned int c = first ; c < end ; ++c)
+            bucketed[bucketStart[out.vertex[CornerTable::next(c)]].fetch_add(1, std::memory_order_relaxed)] = c;
+    });
+    for (unsigned int v = vertices ; v > 0 ; --v)
+        bucketStart[v].store(bucketStart[v - 1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bucketStart[0].store(0, std::memory_order_relaxed);
+
+    //Corner c faces edge a -> b, and its opposite faces b -> a, so it is in
+    //bucket b with a at its previous corner.  The answer does not depend on
+    //the order each bucket was filled in.
+    out.opposite.resize(corners);
+    std::atomic<unsigned int> boundary(0), nonManifold(0);
+    parallelChunks(corners, [&](unsigned int first, unsigned int end)
+    {
+        unsigned int chunkBoundary = 0, chunkNonManifold = 0;
+        for (unsigned int c = first ; c < end ; ++c)
+        {
+            unsigned int a = out.vertex[CornerTable::next(c)];
+            unsigned int b = out.vertex[CornerTable::prev(c)];
+            unsigned int match = TOPOLOGY_NONE, matches = 0;
+            for (unsigned int i = bucketStart[b].load(std::memory_order_relaxed) ;
+                 i < bucketStart[b + 1].load(std::memory_order_relaxed) ; ++i)
+            {
+                unsigned int d = bucketed[i];
+                if (out.vertex[CornerTable::prev(d)] == a)
+                {
+                    match = d;
+                    ++matches;
+                }
+            }
+
+            if (matches == 1)
+                out.opposite[c] = match;
+            else
+            {
+                out.opposite[c] = TOPOLOGY_NONE;
+                if (matches == 0)
+                    ++chunkBoundary;
+                else
+                    ++chunkNonManifold;
+            }
+        }
+        boundary += chunkBoundary;
+        nonManifold += chunkNonManifold;
+    });
+    out.boundaryEdges = boundary;
+    out.nonManifoldCorners = nonManifold;
+
+    //Each vertex starts at its lowest corner, or at the first corner of
+    //its fan if it is on a boundary, so a ring walk sees the whole fan
+    out.vertexCorner.assign(vertices, TOPOLOGY_NONE);
+    for (unsigned int c = corners ; c-- > 0 ; )
+        out.vertexCorner[out.vertex[c]] = c;
+    if (out.boundaryEdges > 0)
+        for (unsigned int c = corners ; c-- > 0 ; )
+            if (out.opposite[CornerTable::prev(c)] == TOPOLOGY_NONE)
+                out.vertexCorner[out.vertex[c]] = c;
+}
+
+///////////////////////////////////////////////////////////
+//Check that a table is a closed manifold of genus 0 whose vertex rings
+//all close up
+///////////////////////////////////////////////////////////
+static bool closedSphere(const CornerTable& table)
+{
+    if (table.boundaryEdges != 0 || table.nonManifoldCorners != 0 || table.eulerCharacteristic() != 2)
+        return false;
+
+    //Every corner of a vertex must be reached by swinging around it once
+    unsigned int reached = 0;
+    for (unsigned int v = 0 ; v < table.vertexCount() ; ++v)
+    {
+        unsigned int first = table.vertexCorner[v], c = first;
+        do
+        {
+            if (table.vertex[c] != v || table.opposite[table.opposite[c]] != c)
+                return false;
+            ++reached;
+            c = table.swing(c);
+        } while (c != first && reached <= table.cornerCount());
+    }
+    return reached == table.cornerCount();
+}
+
+///////////////////////////////////////////////////////////
+//Topology of each shape at several levels
+///////////////////////////////////////////////////////////
+struct reportLevel
+{
+    short rendering;
+    const char* name;
+    int primary;
+    int secondary;
+};
+
+static const reportLevel reportLevels[] =
+{
+    { RENDERING_CUBE, "Cube", 1, 1 },
+    { RENDERING_CUBE, "Cube", 8, 1 },
+    { RENDERING_CUBE, "Cube", 150, 1 },
+    { RENDERING_CYL, "Cylinder", 3, 1 },
+    { RENDERING_CYL, "Cylinder", 32, 8 },
+    { RENDERING_CYL, "Cylinder", 150, 150 },
+    { RENDERING_CONE, "Cone", 3, 1 },
+    { RENDERING_CONE, "Cone", 32, 8 },
+    { RENDERING_CONE, "Cone", 150, 150 },
+    { RENDERING_SPH, "Sphere", 1, 1 },
+    { RENDERING_SPH, "Sphere", 4, 1 },
+    { RENDERING_SPH, "Sphere", 6, 1 },
+};
+
+int topologyReport()
+{
+    typedef std::chrono::steady_clock clock;
+    int failures = 0;
+
+    printf("%-9s %9s %9s %9s %9s %9s %6s %9s\n",
+           "Shape", "Level", "Triangles", "Vertices", "Welded", "Edges", "Euler", "Build ms");
+    for (unsigned int i = 0 ; i < sizeof(reportLevels) / sizeof(reportLevels[0]) ; ++i)
+    {
+        const reportLevel& level = reportLevels[i];
+        Mesh mesh;
+        generateMesh(level.rendering, level.primary, level.secondary, mesh);
+
+        CornerTable table;
+        clock::time_point begin = clock::now();
+        buildCornerTable(mesh, table);
+        double ms = std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+
+        bool ok = closedSphere(table);
+        failures += !ok;
+
+        char levelText[32];
+        sprintf(levelText, "%d x %d", level.primary, level.secondary);
+        printf("%-9s %9s %9u %9u %9u %9u %6d %9.2f%s\n", level.name, levelText, mesh.triangleCount(),
+               (unsigned int)mesh.positions.size(), table.vertexCount(), table.edgeCount(),
+               table.eulerCharacteristic(), ms, ok ? "" : "  NOT A CLOSED MANIFOLD");
+        if (!ok)
+            printf("          %u boundary edges, %u non-manifold corners\n",
+                   table.boundaryEdges, table.nonManifoldCorners);
+    }
+
+    return failures;
+}
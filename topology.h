@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////
+//
+// File:  topology.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the corner table, which gives a generated
+//               mesh the adjacency its flat index list lacks.
+//
+//               Corner c is corner c % 3 of triangle c / 3.  vertex[c] is
+//               the welded vertex at c, and opposite[c] the corner facing
+//               c across the edge opposite it, in the neighbouring
+//               triangle (TOPOLOGY_NONE on a boundary).  next, prev and
+//               swing then answer every neighbour, edge and vertex ring
+//               query in constant time per step, with nothing but indices
+//               into contiguous arrays.
+//
+//               The generators repeat vertices along seams (and the
+//               sphere repeats every vertex), so vertices within
+//               TOPOLOGY_WELD_EPSILON of each other are welded first.
+//               Building is linear: the corners are bucketed by the vertex
+//               their opposite edge starts at, and each is matched against
+//               the few in the bucket of the vertex it ends at.  Large
+//               meshes are bucketed and matched across threads.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __TOPOLOGY_H__
+#define __TOPOLOGY_H__
+
+#include "mesh.h"
+
+// No corner (the far side of a boundary edge)
+#define TOPOLOGY_NONE 0xffffffffu
+
+// Vertices closer than this on every axis are the same vertex
+#define TOPOLOGY_WELD_EPSILON 1e-9
+
+struct CornerTable
+{
+    trackedVector<unsigned int, MEMORY_TESSELLATION> vertex;        // Welded vertex of each corner
+    trackedVector<unsigned int, MEMORY_TESSELLATION> opposite;      // Corner across the opposite edge
+    trackedVector<unsigned int, MEMORY_TESSELLATION> vertexCorner;  // A corner of each welded vertex,
+                                                                    // the first of its fan if on a boundary
+    trackedVector<unsigned int, MEMORY_TESSELLATION> weldedFrom;    // A mesh vertex of each welded vertex
+    unsigned int boundaryEdges;
+    unsigned int nonManifoldCorners;                                // Corners whose edge more than two
+                                                                    // triangles share (left unmatched)
+
+    unsigned int vertexCount() const { return vertexCorner.size(); }
+    unsigned int cornerCount() const { return vertex.size(); }
+    unsigned int triangleCount() const { return vertex.size() / 3; }
+
+    //Corners of the same triangle, counter-clockwise
+    static unsigned int next(unsigned int c) { return c % 3 == 2 ? c - 2 : c + 1; }
+    static unsigned int prev(unsigned int c) { return c % 3 == 0 ? c + 2 : c - 1; }
+
+    //Corner at the same vertex in the next triangle counter-clockwise
+    //around it, or TOPOLOGY_NONE at a boundary
+    unsigned int swing(unsigned int c) const
+    {
+        unsigned int o = opposite[next(c)];
+        return o == TOPOLOGY_NONE ? TOPOLOGY_NONE : next(o);
+    }
+
+    //Triangle across the edge opposite corner c, or TOPOLOGY_NONE
+    unsigned int neighbour(unsigned int c) const
+    {
+        return opposite[c] == TOPOLOGY_NONE ? TOPOLOGY_NONE : opposite[c] / 3;
+    }
+
+    //Number of edges (each counted once) and the Euler characteristic,
+    //for a manifold table
+    unsigned int edgeCount() const { return (cornerCount() + boundaryEdges) / 2; }
+    int eulerCharacteristic() const { return int(vertexCount()) - int(edgeCount()) + int(triangleCount()); }
+};
+
+// Weld mesh's vertices and build its corner table into out
+void buildCornerTable(const MeshView& mesh, CornerTable& out);
+
+///////////////////////////////////////////////////////////
+//Call visit(c) once per edge, with c the corner opposite it on the side
+//that has the smaller corner (or the only side, on a boundary)
+///////////////////////////////////////////////////////////
+template <class Visit>
+void forEachEdge(const CornerTable& table, const Visit& visit)
+{
+    for (unsigned int c = 0 ; c < table.cornerCount() ; ++c)
+        if (table.opposite[c] == TOPOLOGY_NONE || c < table.opposite[c])
+            visit(c);
+}
+
+///////////////////////////////////////////////////////////
+//Call visit(w) for each welded vertex w joined to v by an edge, counter-
+//clockwise around v
+///////////////////////////////////////////////////////////
+template <class Visit>
+void forEachVertexNeighbour(const CornerTable& table, unsigned int v, const Visit& visit)
+{
+    unsigned int first = table.vertexCorner[v];
+    unsigned int c = first;
+    do
+    {
+        visit(table.vertex[CornerTable::next(c)]);
+        unsigned int following = table.swing(c);
+
+        //An open fan ends with the far edge of its last triangle
+        if (following == TOPOLOGY_NONE)
+        {
+            visit(table.vertex[CornerTable::prev(c)]);
+            return;
+        }
+        c = following;
+    } while (c != first);
+}
+
+// Build the corner table of every shape at several levels, checking that
+// each is closed, manifold and of Euler characteristic 2, and printing the
+// counts and build time; returns the number of meshes that were not
+int topologyReport();
+
+#endif
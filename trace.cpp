@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////
+//
+// File:  trace.cpp
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds the implementations for recording trace
+//               spans and writing them out as Chrome trace events.
+//
+////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+std::atomic<bool> traceActive(false);
+
+// Every ring ever made; rings are handed back when their thread exits
+// and reused by the next thread, so short lived workers do not pile up
+static std::atomic<traceRing*> traceRings(NULL);
+static std::atomic<unsigned int> traceThreads(0);
+
+// File to write, and the clock at traceStart() in ticks and microseconds
+static std::string tracePath;
+static unsigned long long startTicks;
+static std::chrono::steady_clock::time_point startTime;
+
+// Hands a thread's ring back when the thread exits
+struct traceRingOwner
+{
+    ~traceRingOwner()
+    {
+        if (traceLocalRing != NULL)
+            traceLocalRing->inUse.store(false, std::memory_order_release);
+    }
+};
+
+///////////////////////////////////////////////////////////
+//Give the calling thread a ring of its own
+///////////////////////////////////////////////////////////
+traceRing* traceAcquireRing()
+{
+    static thread_local traceRingOwner owner;
+    (void)owner;
+
+    //Take over the ring of a thread that has exited...
+    traceRing* ring = traceRings.load(std::memory_order_acquire);
+    for ( ; ring != NULL ; ring = ring->next)
+    {
+        bool free = false;
+        if (ring->inUse.compare_exchange_strong(free, true, std::memory_order_acquire))
+            break;
+    }
+
+    //...or push a new one
+    if (ring == NULL)
+    {
+        ring = new traceRing;
+        ring->head.store(0, std::memory_order_relaxed);
+        ring->inUse.store(true, std::memory_order_relaxed);
+        ring->next = traceRings.load(std::memory_order_relaxed);
+        while (!traceRings.compare_exchange_weak(ring->next, ring, std::memory_order_release))
+            ;
+    }
+
+    //Events keep the number of the thread that recorded them
+    ring->thread = traceThreads.fetch_add(1, std::memory_order_relaxed) + 1;
+    traceLocalRing = ring;
+    return ring;
+}
+
+///////////////////////////////////////////////////////////
+//Start recording
+///////////////////////////////////////////////////////////
+bool traceStart(const char* path)
+{
+    tracePath = path;
+    startTime = std::chrono::steady_clock::now();
+    startTicks = traceClock();
+    traceActive.store(true);
+    atexit(traceFlush);
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//Write every ring out as Chrome trace events
+///////////////////////////////////////////////////////////
+void traceFlush()
+{
+    if (!traceActive.exchange(false))
+        return;
+
+    //Ticks per microsecond, from the clock's progress since traceStart()
+    double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+    double ticksPerMicro = elapsed > 0 ? (traceClock() - startTicks) / elapsed : 1.0;
+
+    FILE* out = fopen(tracePath.c_str(), "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "Could not write trace %s\n", tracePath.c_str());
+        return;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    unsigned long events = 0, lost = 0;
+    for (traceRing* ring = traceRings.load(std::memory_order_acquire) ; ring != NULL ; ring = ring->next)
+    {
+        unsigned long long head = ring->head.load(std::memory_order_acquire);
+        unsigned long long oldest = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+        lost += oldest;
+        for (unsigned long long i = oldest ; i < head ; ++i)
+        {
+            const traceEvent& event = ring->events[i & (TRACE_RING_SIZE - 1)];
+            fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",\n", event.name, event.thread,
+                    (event.start - startTicks) / ticksPerMicro, (event.end - event.start) / ticksPerMicro);
+            first = false;
+            ++events;
+        }
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+
+    printf("Wrote %lu trace events to %s", events, tracePath.c_str());
+    if (lost > 0)
+        printf(" (%lu older events overwritten)", lost);
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////
+//Nanoseconds a pass of body takes beyond a pass of the same loop without
+//it, by the fastest of several runs so that other work on the machine
+//does not count against it
+///////////////////////////////////////////////////////////
+#define TRACE_REPORT_PASSES 1000000
+#define TRACE_REPORT_RUNS 5
+
+static volatile unsigned long long traceReportSink;
+
+template <typename body>
+static double traceReportCost(body pass)
+{
+    typedef std::chrono::steady_clock clock;
+    double fastest = 0.0;
+    for (int run = 0 ; run < TRACE_REPORT_RUNS ; ++run)
+    {
+        clock::time_point start = clock::now();
+        for (unsigned int i = 0 ; i < TRACE_REPORT_PASSES ; ++i)
+            pass(i);
+        clock::time_point middle = clock::now();
+        for (unsigned int i = 0 ; i < TRACE_REPORT_PASSES ; ++i)
+            traceReportSink = i;
+        clock::time_point end = clock::now();
+
+        double nanoseconds = std::chrono::duration<double, std::nano>((middle - start) - (end - middle)).count();
+        if (run == 0 || nanoseconds < fastest)
+            fastest = nanoseconds;
+    }
+    return fastest / TRACE_REPORT_PASSES;
+}
+
+///////////////////////////////////////////////////////////
+//Time spans against the budget.  The report runs before --trace is read,
+//so the spans it records are never written out.
+///////////////////////////////////////////////////////////
+#define TRACE_SPAN_BUDGET_NS 20.0
+
+int traceReport()
+{
+    double clockRead = traceReportCost([](unsigned int i) { traceReportSink = traceClock() + i; });
+
+    traceActive.store(false);
+    double idle = traceReportCost([](unsigned int i) { TRACE_SPAN("trace report"); traceReportSink = i; });
+
+    traceActive.store(true);
+    double recorded = traceReportCost([](unsigned int i) { TRACE_SPAN("trace report"); traceReportSink = i; });
+    traceActive.store(false);
+
+    printf("Clock read:              %6.1f ns\n", clockRead);
+    printf("Span, not recording:     %6.1f ns\n", idle);
+    printf("Span, recording:         %6.1f ns (budget %.0f ns)%s\n", recorded, TRACE_SPAN_BUDGET_NS,
+           recorded < TRACE_SPAN_BUDGET_NS ? "" : "  OVER BUDGET");
+    printf("Recording beyond its two clock reads: %.1f ns\n", recorded - 2 * clockRead);
+
+    return recorded < TRACE_SPAN_BUDGET_NS ? 0 : 1;
+}
+
+#else
+
+///////////////////////////////////////////////////////////
+//Tracing was compiled out
+///////////////////////////////////////////////////////////
+bool traceStart(const char* path)
+{
+    return false;
+}
+
+void traceFlush()
+{
+}
+
+int traceReport()
+{
+    printf("Trace spans are compiled out (TRACE_ENABLED=0)\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////
+//
+// File:  trace.h
+// Authors:  Matthew MacEwan
+// Contributors:
+// Last modified: 10/19/26
+//
+// Description:  This file holds scoped trace spans around the phases of
+//               generating and drawing a shape, written out in the Chrome
+//               trace event format (chrome://tracing, Perfetto).
+//
+//               A span reads the time stamp counter on entry and exit and
+//               appends one event to its thread's ring buffer.  Only the
+//               owning thread writes a ring, so recording takes no lock;
+//               the oldest events are overwritten once a ring is full.
+//               Nothing is recorded until traceStart(), so the spans can
+//               stay compiled in, and building with TRACE_ENABLED=0
+//               (make TRACE=0) removes them entirely.
+//
+//               A recorded span is meant to cost under 20 ns.  Nearly all
+//               of that is the two clock reads, so whether it does depends
+//               on how fast the machine reads its time stamp counter;
+//               --trace-report measures it.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+// Events kept per thread (a power of two)
+#define TRACE_RING_SIZE 65536
+
+#if TRACE_ENABLED
+
+#include <atomic>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// One completed span
+struct traceEvent
+{
+    const char* name;
+    unsigned long long start;
+    unsigned long long end;
+    unsigned int thread;
+};
+
+// A thread's events; head counts every event ever written
+struct traceRing
+{
+    traceEvent events[TRACE_RING_SIZE];
+    std::atomic<unsigned long long> head;
+    unsigned int thread;
+    std::atomic<bool> inUse;
+    traceRing* next;
+};
+
+// Is true between traceStart() and the flush; spans on other threads only
+// need to see it eventually, so it is read relaxed
+extern std::atomic<bool> traceActive;
+
+// The calling thread's ring, or NULL until it records its first span.
+// Defined here with a constant initializer, so reaching it is a plain
+// thread-local load rather than a call to its initialization wrapper.
+inline thread_local traceRing* traceLocalRing = NULL;
+
+// Give the calling thread a ring of its own
+traceRing* traceAcquireRing();
+
+///////////////////////////////////////////////////////////
+//Time in clock ticks, converted to microseconds when written out
+///////////////////////////////////////////////////////////
+inline unsigned long long traceClock()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+///////////////////////////////////////////////////////////
+//Append a span to the calling thread's ring
+///////////////////////////////////////////////////////////
+inline void traceRecord(const char* name, unsigned long long start, unsigned long long end)
+{
+    traceRing* ring = traceLocalRing;
+    if (ring == NULL)
+        ring = traceAcquireRing();
+
+    unsigned long long head = ring->head.load(std::memory_order_relaxed);
+    traceEvent& event = ring->events[head & (TRACE_RING_SIZE - 1)];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    event.thread = ring->thread;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+// Times the scope it is declared in; name must be a string literal
+struct traceSpan
+{
+    const char* name;
+    unsigned long long start;
+
+    traceSpan(const char* name_) : name(name_), start(traceActive.load(std::memory_order_relaxed) ? traceClock() : 0) {}
+    ~traceSpan() { if (start != 0) traceRecord(name, start, traceClock()); }
+};
+
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+#define TRACE_SPAN(name) traceSpan TRACE_JOIN(traceSpan_, __LINE__)(name)
+
+#else
+
+#define TRACE_SPAN(name) ((void)0)
+
+#endif
+
+// Start recording, to be written to path when the program exits; returns
+// false if tracing was compiled out
+bool traceStart(const char* path);
+
+// Write everything recorded so far to the trace file
+void traceFlush();
+
+// Time the clock and a span with and without recording against the span
+// budget; returns 1 if a recorded span is over it, 0 otherwise
+int traceReport();
+
+#endif
@@ -16,6 +16,7 @@
 
 #include <iostream>
 #include <cmath>
+#include "ctmath.h"
 
 using namespace std;
 
@@ -23,37 +24,37 @@ class Point3;
 
 class Vector3 {
 public:
-  Vector3() : x(0), y(0), z(0) {}
-  Vector3(const Vector3& v) : x(v.x), y(v.y), z(v.z) {}
-  Vector3(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
+  constexpr Vector3() : x(0), y(0), z(0) {}
+  constexpr Vector3(const Vector3& v) : x(v.x), y(v.y), z(v.z) {}
+  constexpr Vector3(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
   
-  Vector3& operator=(const Vector3& a) {
+  constexpr Vector3& operator=(const Vector3& a) {
     x = a.x; y = a.y; z = a.z;
     return *this;
   }
 
   double operator[](int n) const { return ((double *) this)[n]; }
 
-  Vector3& operator+=(const Vector3& a) {
+  constexpr Vector3& operator+=(const Vector3& a) {
     x += a.x; y += a.y; z += a.z;
     return *this;
   }
 
-  Vector3& operator-=(const Vector3& a) {
+  constexpr Vector3& operator-=(const Vector3& a) {
     x -= a.x; y -= a.y; z -= a.z;
     return *this;
   }
 
-  Vector3& operator*=(double s) {
+  constexpr Vector3& operator*=(double s) {
     x *= s; y *= s; z *= s;
     return *this;
   }
 
-  Vector3 operator-() const {
+  constexpr Vector3 operator-() const {
     return Vector3(-x, -y, -z);
   }
 
-  Vector3 operator+() const {
+  constexpr Vector3 operator+() const {
     return *this;
   }
   
@@ -61,12 +62,12 @@ public:
     return (double) sqrt(x * x + y * y + z * z);
   }
 
-  double lengthSquared() const {
+  constexpr double lengthSquared() const {
     return x * x + y * y + z * z;
   }
 
-  void normalize() {
-    double s = 1.0 / (double) sqrt(x * x + y * y + z * z);
+  constexpr void normalize() {
+    double s = 1.0 / (double) ctSqrt(x * x + y * y + z * z);
     x *= s; y *= s; z *= s;
   }
   
@@ -75,28 +76,28 @@ public:
 
 class Point3 {
 public:
-  Point3() : x(0), y(0), z(0) {}
-  Point3(const Point3& p) : x(p.x), y(p.y), z(p.z) {}
-  Point3(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
+  constexpr Point3() : x(0), y(0), z(0) {}
+  constexpr Point3(const Point3& p) : x(p.x), y(p.y), z(p.z) {}
+  constexpr Point3(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
   
-  Point3& operator=(const Point3& a) {
+  constexpr Point3& operator=(const Point3& a) {
     x = a.x; y = a.y; z = a.z;
     return *this;
   }
   
   double operator[](int n) const { return ((double *) this)[n]; }
 
-  Point3& operator+=(const Vector3& v) {
+  constexpr Point3& operator+=(const Vector3& v) {
     x += v.x; y += v.y; z += v.z;
     return *this;
   }
 
-  Point3& operator-=(const Vector3& v) {
+  constexpr Point3& operator-=(const Vector3& v) {
     x -= v.x; y -= v.y; z -= v.z;
     return *this;
   }
 
-  Point3& operator*=(double s) {
+  constexpr Point3& operator*=(double s) {
     x *= s; y *= s; z *= s;
     return *this;
   }
@@ -128,43 +129,43 @@ public:
 
 // **** Vector3 operators ****
 
-inline Vector3 operator+(const Vector3& a, const Vector3& b) {
+constexpr inline Vector3 operator+(const Vector3& a, const Vector3& b) {
   return Vector3(a.x + b.x, a.y + b.y, a.z + b.z);
 }
 
-inline Vector3 operator-(const Vector3& a, const Vector3& b) {
+constexpr inline Vector3 operator-(const Vector3& a, const Vector3& b) {
   return Vector3(a.x - b.x, a.y - b.y, a.z - b.z);
 }
 
-inline Vector3 operator*(double s, const Vector3& v) {
+constexpr inline Vector3 operator*(double s, const Vector3& v) {
   return Vector3(s * v.x, s * v.y, s * v.z);
 }
 
-inline Vector3 operator*(const Vector3& v, double s) {
+constexpr inline Vector3 operator*(const Vector3& v, double s) {
   return Vector3(s * v.x, s * v.y, s * v.z);
 }
 
 // dot product
-inline double operator*(const Vector3& a, const Vector3& b) {
+constexpr inline double operator*(const Vector3& a, const Vector3& b) {
   return a.x * b.x + a.y * b.y + a.z * b.z;
 }
 
 // cross product
-inline Vector3 operator^(const Vector3& a, const Vector3& b) {
+constexpr inline Vector3 operator^(const Vector3& a, const Vector3& b) {
   return Vector3(a.y * b.z - a.z * b.y,
                  a.z * b.x - a.x * b.z,
                  a.x * b.y - a.y * b.x);
 }
 
-inline bool operator==(const Vector3& a, const Vector3& b) {
+constexpr inline bool operator==(const Vector3& a, const Vector3& b) {
   return a.x == b.x && a.y == b.y && a.z == b.z;
 }
 
-inline bool operator!=(const Vector3& a, const Vector3& b) {
+constexpr inline bool operator!=(const Vector3& a, const Vector3& b) {
   return a.x != b.x || a.y != b.y || a.z != b.z;
 }
 
-inline Vector3 operator/(const Vector3& v, double s) {
+constexpr inline Vector3 operator/(const Vector3& v, double s) {
   double is = 1 / s;
   return Vector3(is * v.x, is * v.y, is * v.z);
 }
@@ -177,31 +178,31 @@ inline ostream& operator<<(ostream& os, const Vector3& v) {
 
 // **** Point3 operators ****
 
-inline Vector3 operator-(const Point3& a, const Point3& b) {
+constexpr inline Vector3 operator-(const Point3& a, const Point3& b) {
   return Vector3(a.x - b.x, a.y - b.y, a.z - b.z);
 }
 
-inline bool operator==(const Point3& a, const Point3& b) {
+constexpr inline bool operator==(const Point3& a, const Point3& b) {
   return a.x == b.x && a.y == b.y && a.z == b.z;
 }
 
-inline bool operator!=(const Point3& a, const Point3& b) {
+constexpr inline bool operator!=(const Point3& a, const Point3& b) {
   return a.x != b.x || a.y != b.y || a.z != b.z;
 }
 
-inline Point3 operator+(const Point3& p, const Vector3& v) {
+constexpr inline Point3 operator+(const Point3& p, const Vector3& v) {
   return Point3(p.x + v.x, p.y + v.y, p.z + v.z);
 }
 
-inline Point3 operator-(const Point3& p, const Vector3& v) {
+constexpr inline Point3 operator-(const Point3& p, const Vector3& v) {
   return Point3(p.x - v.x, p.y - v.y, p.z - v.z);
 }
 
-inline Point3 operator*(const Point3& p, double s) {
+constexpr inline Point3 operator*(const Point3& p, double s) {
   return Point3(p.x * s, p.y * s, p.z * s);
 }
 
-inline Point3 operator*(double s, const Point3& p) {
+constexpr inline Point3 operator*(double s, const Point3& p) {
   return Point3(p.x * s, p.y * s, p.z * s);
 }
 